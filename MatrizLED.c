@@ -1,4 +1,6 @@
-#include "MatrizLED.h"
+#include "matrizLED.h"
+#include "hardware/dma.h"
+#include "pico/sync.h"
 
 /**
  * Para uma matriz 5x5 de LEDs, os índices são mapeados da seguinte forma:
@@ -8,11 +10,51 @@
  * 1 05 06 07 08 09
  * 0 04 03 02 01 00
  *    0  1  2  3  4
+ *
+ * As coordenadas x usadas por getIndex()/setLEDxy() são contadas a partir da direita
+ * do diagrama: x = 0 é a coluna dos índices 00, 09, 10, 19 e 20.
  */
 
+// Índice linear de cada LED por [y][x]: linhas pares seguem x, linhas ímpares voltam (serpentina).
+static const uint8_t NP_INDEX[5][5] = {
+    { 0,  1,  2,  3,  4},
+    { 9,  8,  7,  6,  5},
+    {10, 11, 12, 13, 14},
+    {19, 18, 17, 16, 15},
+    {20, 21, 22, 23, 24},
+};
+
+// Números de 0 a 9 para a matriz 5x5, um byte por linha (y = 0 a 4).
+// O bit x de cada byte indica se o LED (x, y) fica aceso.
+static const uint8_t NP_DIGITS[10][5] = {
+    {0x1F, 0x11, 0x11, 0x11, 0x1F}, // 0: ##### #...# #...# #...# #####
+    {0x0E, 0x04, 0x04, 0x0C, 0x04}, // 1: .###. ..#.. ..#.. ..##. ..#..
+    {0x1F, 0x10, 0x1F, 0x01, 0x1F}, // 2: ##### ....# ##### #.... #####
+    {0x1F, 0x01, 0x0F, 0x01, 0x1F}, // 3: ##### #.... ####. #.... #####
+    {0x02, 0x02, 0x1F, 0x12, 0x12}, // 4: .#... .#... ##### .#..# .#..#
+    {0x1F, 0x01, 0x1F, 0x10, 0x1F}, // 5: ##### #.... ##### ....# #####
+    {0x1F, 0x11, 0x1F, 0x10, 0x1F}, // 6: ##### #...# ##### ....# #####
+    {0x08, 0x04, 0x02, 0x01, 0x1F}, // 7: ...#. ..#.. .#... #.... #####
+    {0x1F, 0x11, 0x1F, 0x11, 0x1F}, // 8: ##### #...# ##### #...# #####
+    {0x1F, 0x01, 0x1F, 0x11, 0x1F}, // 9: ##### #.... ##### #...# #####
+};
+
 // Declaração do buffer de LEDs que formam a matriz.
 npLED_t leds[LED_COUNT];
 
+// Duração do envio de um quadro (24 bits a 1,25us por LED) e do reset que trava as cores.
+#define NP_FRAME_US ((LED_COUNT * 24 * 5) / 4)
+#define NP_RESET_US 100
+
+// Quadros já empacotados no formato lido pela máquina PIO: um LED por palavra,
+// G nos bits 0-7, R nos bits 8-15 e B nos bits 16-23 (a PIO desloca para a direita).
+static uint32_t np_frames[2][LED_COUNT];
+static uint np_dma_channel;
+static uint8_t np_active;          // Quadro que está (ou esteve por último) na linha.
+static volatile bool np_busy;      // Envio ou reset em andamento.
+static volatile bool np_pending;   // Há um quadro novo esperando o fim do reset.
+static critical_section_t np_lock; // npWrite() roda no núcleo 1 e o alarme no núcleo 0.
+
 /**
  * Atribui as informações relevantes da máquina PIO em uso.
  * 
@@ -23,6 +65,26 @@ void npMatrizInit(const PIO pio_info, const uint sm_info)
 {
   np_pio = pio_info;  // Armazena a referência do PIO em uso.
   sm = sm_info;       // Armazena o número da máquina de estado.
+
+  critical_section_init(&np_lock);
+
+  // O DMA copia um quadro inteiro para a FIFO da PIO, no ritmo pedido por ela.
+  np_dma_channel = dma_claim_unused_channel(true);
+  dma_channel_config cfg = dma_channel_get_default_config(np_dma_channel);
+  channel_config_set_transfer_data_size(&cfg, DMA_SIZE_32);
+  channel_config_set_read_increment(&cfg, true);
+  channel_config_set_write_increment(&cfg, false);
+  channel_config_set_dreq(&cfg, pio_get_dreq(np_pio, sm, true));
+  dma_channel_configure(np_dma_channel, &cfg, &np_pio->txf[sm], np_frames[0], LED_COUNT, false);
+}
+
+/**
+ * Recalcula o divisor da máquina PIO para o clk_sys atual, mantendo NP_BIT_FREQ.
+ * Deve ser chamada depois de cada mudança de frequência do clk_sys.
+ */
+void npUpdateClock(void)
+{
+  pio_sm_set_clkdiv(np_pio, sm, clock_get_hz(clk_sys) / (10.f * NP_BIT_FREQ));
 }
 
 /**
@@ -49,19 +111,77 @@ void npClear()
         npSetLED(i, 0, 0, 0);  // Define cada LED como apagado (RGB = 0, 0, 0).
 }
 
+/**
+ * Dispara o DMA com um dos quadros empacotados. Deve ser chamada com np_lock tomado.
+ */
+static void npStartFrame(uint8_t index)
+{
+    np_active = index;
+    np_busy = true;
+    dma_channel_set_read_addr(np_dma_channel, np_frames[index], true);
+}
+
+/**
+ * Alarme disparado quando o quadro terminou de sair e o reset já passou.
+ * Se chegou um quadro novo nesse meio tempo, envia e agenda o próximo alarme.
+ */
+static int64_t npLatchDone(alarm_id_t id, void *user_data)
+{
+    int64_t reschedule_us = 0;
+
+    critical_section_enter_blocking(&np_lock);
+    if (np_pending) {
+        np_pending = false;
+        npStartFrame(np_active ^ 1);
+        reschedule_us = NP_FRAME_US + NP_RESET_US;
+    } else {
+        np_busy = false;
+    }
+    critical_section_exit(&np_lock);
+
+    return reschedule_us;
+}
+
 /**
  * Escreve os dados do buffer de LEDs nos LEDs físicos, enviando os valores das cores.
- * Realiza a operação de forma sequencial para cada LED da matriz.
+ * O envio é feito por DMA e a função retorna imediatamente. Se o quadro anterior ainda
+ * estiver saindo, o novo fica na fila e substitui qualquer outro que estivesse esperando.
  */
 void npWrite()
 {
-    // Para cada LED no buffer, envia as componentes de cor para a máquina PIO.
-    for (uint i = 0; i < LED_COUNT; ++i) {
-        pio_sm_put_blocking(np_pio, sm, leds[i].G);  // Envia o valor do verde.
-        pio_sm_put_blocking(np_pio, sm, leds[i].R);  // Envia o valor do vermelho.
-        pio_sm_put_blocking(np_pio, sm, leds[i].B);  // Envia o valor do azul.
+    critical_section_enter_blocking(&np_lock);
+
+    // Empacota no quadro que não está na linha.
+    uint8_t next = np_active ^ 1;
+    for (uint i = 0; i < LED_COUNT; ++i)
+        np_frames[next][i] = leds[i].G | (leds[i].R << 8) | ((uint32_t)leds[i].B << 16);
+
+    bool start_now = !np_busy;
+    if (start_now)
+        npStartFrame(next);
+    else
+        np_pending = true;
+
+    critical_section_exit(&np_lock);
+
+    // Fim do quadro mais o reset (conforme datasheet), contado por alarme em vez de sleep_us().
+    // Sem alarme livre, o fim é esperado aqui mesmo; senão np_busy ficaria preso e a matriz
+    // não receberia mais nenhum quadro.
+    if (start_now && add_alarm_in_us(NP_FRAME_US + NP_RESET_US, npLatchDone, NULL, true) < 0) {
+        busy_wait_us(NP_FRAME_US + NP_RESET_US);
+
+        critical_section_enter_blocking(&np_lock);
+        np_busy = false;
+        critical_section_exit(&np_lock);
     }
-    sleep_us(100); // Aguarda 100us para permitir o reset do sinal de controle (conforme datasheet).
+}
+
+/**
+ * Diz se a matriz está parada: nenhum quadro saindo, nenhum reset nem quadro na fila.
+ */
+bool npIdle(void)
+{
+    return !np_busy;
 }
 
 /**
@@ -73,13 +193,7 @@ void npWrite()
  */
 int getIndex(int x, int y)
 {
-    // Se a linha for par (0, 2, 4), percorremos da esquerda para a direita.
-    // Se a linha for ímpar (1, 3), percorremos da direita para a esquerda.
-    if (y % 2 == 0) {
-        return y * 5 + x;  // Linha par: percorre da esquerda para a direita.
-    } else {
-        return y * 5 + (4 - x);  // Linha ímpar: percorre da direita para a esquerda.
-    }
+    return NP_INDEX[y][x];  // Tabela pré-calculada da serpentina.
 }
 
 /**
@@ -93,8 +207,7 @@ int getIndex(int x, int y)
  */
 void setLEDxy(const uint y, const uint x, const uint8_t r, const uint8_t g, const uint8_t b)
 {
-    int index = getIndex(y, x);  // Converte as coordenadas para o índice linear.
-    npSetLED(index, r, g, b);    // Define a cor para o LED no índice calculado.
+    npSetLED(NP_INDEX[x][y], r, g, b);  // Define a cor para o LED na posição (coluna y, linha x).
 }
 
 /**
@@ -108,90 +221,45 @@ void setLEDxy(const uint y, const uint x, const uint8_t r, const uint8_t g, cons
  */
 void setLEDnumber(const int number, const uint8_t r, const uint8_t g, const uint8_t b)
 {
-    npClear();  // Limpa a matriz antes de exibir o novo número.
-
-    // Template para os números de 0 a 9 na matriz 5x5.
-    int templates[10][5][5] = {
-        // 0
-        {{1, 1, 1, 1, 1},
-         {1, 0, 0, 0, 1},
-         {1, 0, 0, 0, 1},
-         {1, 0, 0, 0, 1},
-         {1, 1, 1, 1, 1}},
-
-        // 1
-        {{0, 1, 1, 1, 0},
-         {0, 0, 1, 0, 0},
-         {0, 0, 1, 0, 0},
-         {0, 0, 1, 1, 0},
-         {0, 0, 1, 0, 0}},
-
-        // 2
-        {{1, 1, 1, 1, 1},
-         {0, 0, 0, 0, 1},
-         {1, 1, 1, 1, 1},
-         {1, 0, 0, 0, 0},
-         {1, 1, 1, 1, 1}},
-
-        // 3
-        {{1, 1, 1, 1, 1},
-         {1, 0, 0, 0, 0},
-         {1, 1, 1, 1, 0},
-         {1, 0, 0, 0, 0},
-         {1, 1, 1, 1, 1}},
-
-        // 4
-        {{0, 1, 0, 0, 0},
-         {0, 1, 0, 0, 0},
-         {1, 1, 1, 1, 1},
-         {0, 1, 0, 0, 1},
-         {0, 1, 0, 0, 1}},
-
-        // 5
-        {{1, 1, 1, 1, 1},
-         {1, 0, 0, 0, 0},
-         {1, 1, 1, 1, 1},
-         {0, 0, 0, 0, 1},
-         {1, 1, 1, 1, 1}},
-
-        // 6
-        {{1, 1, 1, 1, 1},
-         {1, 0, 0, 0, 1},
-         {1, 1, 1, 1, 1},
-         {0, 0, 0, 0, 1},
-         {1, 1, 1, 1, 1}},
-
-        // 7
-        {{0, 0, 0, 1, 0},
-         {0, 0, 1, 0, 0},
-         {0, 1, 0, 0, 0},
-         {1, 0, 0, 0, 0},
-         {1, 1, 1, 1, 1}},
-
-        // 8
-        {{1, 1, 1, 1, 1},
-         {1, 0, 0, 0, 1},
-         {1, 1, 1, 1, 1},
-         {1, 0, 0, 0, 1},
-         {1, 1, 1, 1, 1}},
-
-        // 9
-        {{1, 1, 1, 1, 1},
-         {1, 0, 0, 0, 0},
-         {1, 1, 1, 1, 1},
-         {1, 0, 0, 0, 1},
-         {1, 1, 1, 1, 1}}
-    };
-
-    // Preenche a matriz com os LEDs acesos de acordo com o template do número.
-    for (int i = 0; i < 5; i++) {
-        for (int j = 0; j < 5; j++) {
-            if (templates[number][i][j] == 1)
-                setLEDxy(j, i, r, g, b);  // Define a cor para os LEDs correspondentes ao número.
+    if (number < 0 || number > 9)
+        return;
+
+    npBlitMask(NP_DIGITS[number], r, g, b);  // Escreve o quadro inteiro, apagando os LEDs fora do número.
+    npWrite();  // Atualiza a matriz de LEDs com os novos valores.
+}
+
+/**
+ * Escreve um quadro monocromático inteiro de uma vez.
+ * 
+ * @param rows Um byte por linha (y = 0 a 4); o bit x indica se o LED (x, y) acende.
+ * @param r O valor da componente vermelha da cor (0-255).
+ * @param g O valor da componente verde da cor (0-255).
+ * @param b O valor da componente azul da cor (0-255).
+ */
+void npBlitMask(const uint8_t rows[5], const uint8_t r, const uint8_t g, const uint8_t b)
+{
+    for (uint y = 0; y < 5; y++) {
+        for (uint x = 0; x < 5; x++) {
+            npLED_t *led = &leds[NP_INDEX[y][x]];
+            bool on = rows[y] & (1u << x);
+            led->R = on ? r : 0;
+            led->G = on ? g : 0;
+            led->B = on ? b : 0;
         }
     }
+}
 
-    npWrite();  // Atualiza a matriz de LEDs com os novos valores.
+/**
+ * Escreve uma imagem colorida 5x5 inteira de uma vez.
+ * 
+ * @param image Cores dos LEDs, indexadas por [y][x].
+ */
+void npBlitImage(const npLED_t image[5][5])
+{
+    for (uint y = 0; y < 5; y++) {
+        for (uint x = 0; x < 5; x++)
+            leds[NP_INDEX[y][x]] = image[y][x];
+    }
 }
 
 /**
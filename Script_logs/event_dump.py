@@ -0,0 +1,84 @@
+import argparse
+import struct
+import sys
+import time
+import wave
+
+import serial
+
+from telemetry_decoder import baudrate, decodifica_audio, leitura_serial, porta_serial, quadros
+
+
+# Campos da linha EVENT escrita por recorder_print_index() e recorder_dump().
+CAMPOS_EVENTO = ['seq', 'timestamp_ms', 'peak_db', 'sample_rate', 'samples', 'pre_samples']
+
+
+def linhas_evento(quadro):
+    # Texto misturado ao fluxo: só as linhas EVENT interessam.
+    for linha in quadro.decode('ascii', 'replace').splitlines():
+        if linha.startswith('EVENT,'):
+            yield linha.split(',')[1:]
+
+
+def lista(ser, espera):
+    ser.write(b'L\n')
+    fim = time.monotonic() + espera
+    eventos = []
+    for quadro in quadros(leitura_serial(ser)):
+        for campos in linhas_evento(quadro):
+            eventos.append(campos)
+        if time.monotonic() > fim:
+            break
+    return eventos
+
+
+def baixa(ser, seq, destino):
+    ser.write(b'D %d\n' % seq)
+    evento = None
+    amostras = {}
+    for quadro in quadros(leitura_serial(ser)):
+        for campos in linhas_evento(quadro):
+            if int(campos[0]) == seq:
+                evento = dict(zip(CAMPOS_EVENTO, campos[:len(CAMPOS_EVENTO)]))
+                if campos[-1] != 'ok':
+                    print('Aviso: CRC dos dados do evento %d não confere' % seq, file=sys.stderr)
+        audio = decodifica_audio(quadro)
+        if audio is not None and audio[0] == seq:
+            amostras[audio[1]] = audio[2]
+        if evento is not None and sum(map(len, amostras.values())) >= int(evento['samples']):
+            break
+
+    # Contagens do ADC com 3 bits fracionários (±16384): dobradas para ocupar os 16 bits do WAV.
+    dados = []
+    for posicao in sorted(amostras):
+        dados.extend(amostras[posicao])
+    with wave.open(destino, 'wb') as w:
+        w.setnchannels(1)
+        w.setsampwidth(2)
+        w.setframerate(int(evento['sample_rate']))
+        w.writeframes(struct.pack('<%dh' % len(dados), *(max(-32768, min(32767, 2 * v)) for v in dados)))
+    print('%s: %d amostras, pico %s dB, %s amostras antes do disparo'
+          % (destino, len(dados), evento['peak_db'], evento['pre_samples']))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Lista e baixa os eventos gravados na flash.')
+    parser.add_argument('porta', nargs='?', default=porta_serial)
+    parser.add_argument('--seq', type=int, action='append', help='evento a baixar (pode repetir)')
+    parser.add_argument('--todos', action='store_true', help='baixa todos os eventos')
+    parser.add_argument('--espera', type=float, default=2.0, help='tempo esperando a lista (s)')
+    args = parser.parse_args()
+
+    with serial.Serial(args.porta, baudrate, timeout=1) as ser:
+        eventos = lista(ser, args.espera)
+        print(','.join(CAMPOS_EVENTO))
+        for campos in eventos:
+            print(','.join(campos))
+
+        escolhidos = [int(campos[0]) for campos in eventos] if args.todos else (args.seq or [])
+        for seq in escolhidos:
+            baixa(ser, seq, 'evento_%d.wav' % seq)
+
+
+if __name__ == '__main__':
+    main()
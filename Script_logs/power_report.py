@@ -0,0 +1,128 @@
+import argparse
+import csv
+import math
+import struct
+import sys
+import wave
+
+
+# Mesmas constantes de power.h, mic.h e main.c; atualize junto com o firmware.
+POWER_QUIET_AFTER_MS = 30000
+POWER_IDLE_AFTER_MS = 120000
+MIC_DB_GAIN_DEFAULT = 0.60
+MIC_DB_OFFSET_DEFAULT = 76.775
+ADC_VOLTS_PER_COUNT = 3.3 / 4096
+SENSITIVITY_MIN_DB = [60.0, 50.0, 40.0, 30.0, 20.0]
+
+ESTADOS = ['ACTIVE', 'QUIET', 'IDLE']
+
+# Corrente estimada da placa em cada estado (mA). Valores de referência para comparar
+# traços entre si, não uma medição: ajuste com um amperímetro na sua montagem.
+CORRENTE_MA = {
+    'ACTIVE': 45.0, # RP2040 a 125 MHz, OLED com brilho máximo, matriz acesa
+    'QUIET': 35.0,  # OLED com brilho reduzido, matriz atualizada a cada 200 ms
+    'IDLE': 12.0,   # clk_sys em 48 MHz, ADC a 1/4 da taxa, OLED e matriz desligados
+}
+
+
+# Calibração da placa (linhas cal_gain e cal_offset do comando S); padrão de fábrica.
+calibracao = {'ganho': MIC_DB_GAIN_DEFAULT, 'offset': MIC_DB_OFFSET_DEFAULT}
+
+
+def mic_rms_to_db(rms):
+    if rms <= 0.0001:
+        return 0.0
+    return max(0.0, calibracao['ganho'] * 20.0 * math.log10(rms) + calibracao['offset'])
+
+
+def nivel_silencio(sensibilidade):
+    # quiet_level_db() em main.c
+    return SENSITIVITY_MIN_DB[min(sensibilidade, 4)]
+
+
+def simula(amostras):
+    """Reproduz power_update() para uma sequência de (tempo_ms, nível_db, sensibilidade).
+    Devolve o tempo em cada estado (ms) e o número de transições."""
+    estado = 'ACTIVE'
+    ultimo_som = None
+    anterior = None
+    tempos = {e: 0 for e in ESTADOS}
+    transicoes = 0
+
+    for tempo, db, sensibilidade in amostras:
+        if ultimo_som is None:
+            ultimo_som = tempo
+        if anterior is not None:
+            tempos[estado] += tempo - anterior
+        anterior = tempo
+
+        if db >= nivel_silencio(sensibilidade):
+            ultimo_som = tempo
+        silencio = tempo - ultimo_som
+        proximo = 'IDLE' if silencio >= POWER_IDLE_AFTER_MS else \
+                  'QUIET' if silencio >= POWER_QUIET_AFTER_MS else 'ACTIVE'
+        if proximo != estado:
+            transicoes += 1
+            estado = proximo
+
+    return tempos, transicoes
+
+
+def le_telemetria(caminho):
+    # CSV gravado por script_logs_csv.py: usa o RMS do quadro, o mesmo critério do firmware.
+    with open(caminho, newline='') as arquivo:
+        for linha in csv.DictReader(arquivo):
+            yield int(linha['timestamp_ms']), mic_rms_to_db(float(linha['rms'])), int(linha['sensitivity'])
+
+
+def le_wav(caminho, sensibilidade, janela_ms=10):
+    # O fundo de escala do WAV corresponde ao fundo de escala do ADC (±2048 contagens).
+    with wave.open(caminho, 'rb') as w:
+        if w.getsampwidth() != 2:
+            raise SystemExit('Somente WAV de 16 bits')
+        canais = w.getnchannels()
+        por_janela = max(1, w.getframerate() * janela_ms // 1000)
+        tempo = 0
+        while True:
+            quadros = w.readframes(por_janela)
+            if not quadros:
+                break
+            valores = struct.unpack('<%dh' % (len(quadros) // 2), quadros)[::canais]
+            media_quadrados = sum(v * v for v in valores) / len(valores)
+            rms = math.sqrt(media_quadrados) / 16.0 * ADC_VOLTS_PER_COUNT
+            yield tempo, mic_rms_to_db(rms), sensibilidade
+            tempo += janela_ms
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Simula os estados de energia para um traço de áudio.')
+    parser.add_argument('traco', help='telemetry_*.csv (script_logs_csv.py) ou WAV de 16 bits')
+    parser.add_argument('--sensitivity', type=int, default=1, help='nível de sensibilidade para um WAV')
+    parser.add_argument('--cal-gain', type=float, default=MIC_DB_GAIN_DEFAULT, help='cal_gain da placa')
+    parser.add_argument('--cal-offset', type=float, default=MIC_DB_OFFSET_DEFAULT, help='cal_offset da placa')
+    args = parser.parse_args()
+    calibracao['ganho'] = args.cal_gain
+    calibracao['offset'] = args.cal_offset
+
+    if args.traco.lower().endswith('.wav'):
+        amostras = le_wav(args.traco, args.sensitivity)
+    else:
+        amostras = le_telemetria(args.traco)
+
+    tempos, transicoes = simula(amostras)
+    total = sum(tempos.values())
+    if total == 0:
+        sys.exit('Traço vazio')
+
+    carga_mah = 0.0
+    print('estado,tempo_s,fracao,corrente_ma')
+    for estado in ESTADOS:
+        print(f'{estado},{tempos[estado] / 1000:.1f},{tempos[estado] / total:.3f},{CORRENTE_MA[estado]:.1f}')
+        carga_mah += CORRENTE_MA[estado] * tempos[estado] / 3600000
+    media = carga_mah * 3600000 / total
+    print(f'# {transicoes} transições, corrente média estimada {media:.1f} mA '
+          f'({media / CORRENTE_MA["ACTIVE"]:.0%} do modo sempre ativo)')
+
+
+if __name__ == '__main__':
+    main()
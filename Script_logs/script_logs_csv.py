@@ -1,44 +1,169 @@
-import serial
-import pandas as pd
+import argparse
+import csv
+import os
+import sys
+import time
 from datetime import datetime
 
+from telemetry_decoder import CAMPOS, decodifica_quadro
+
 
 porta_serial = 'COM3' # mude para a porta serial do seu computador
 baudrate = 115200
-intervalo_ms = 500
 
-dados = []
-ultimo_log = None
-ultima_amostragem = datetime.min
+# Um arquivo novo é aberto quando o atual passa deste tamanho.
+TAMANHO_MAXIMO = 16 * 1024 * 1024
+# Linhas acumuladas antes de forçar a escrita em disco.
+LINHAS_POR_FLUSH = 64
+
+COLUNAS_BENCH = ['stage', 'n', 'min_cycles', 'mean_cycles', 'p99_cycles', 'min_us', 'mean_us', 'p99_us']
+
+
+class ArquivoRotativo:
+    """CSV gravado à medida que os dados chegam. Cada arquivo só recebe anexos;
+    ao passar de TAMANHO_MAXIMO o próximo começa com o cabeçalho de novo."""
+
+    def __init__(self, diretorio, prefixo, colunas, tamanho_maximo):
+        self.diretorio = diretorio
+        self.prefixo = prefixo
+        self.colunas = ['host_time'] + colunas
+        self.tamanho_maximo = tamanho_maximo
+        self.arquivo = None
+        self.escritor = None
+        self.pendentes = 0
+        self.indice = 0
+
+    def _abre(self):
+        if self.arquivo is not None:
+            self.arquivo.close()
+        nome = '%s_%s_%03d.csv' % (self.prefixo, datetime.now().strftime('%Y%m%d_%H%M%S'), self.indice)
+        self.indice += 1
+        self.arquivo = open(os.path.join(self.diretorio, nome), 'a', newline='')
+        self.escritor = csv.writer(self.arquivo)
+        self.escritor.writerow(self.colunas)
+        print(f'Gravando em {nome}', file=sys.stderr)
+
+    def grava(self, linha):
+        if self.arquivo is None or self.arquivo.tell() >= self.tamanho_maximo:
+            self._abre()
+        self.escritor.writerow(linha)
+        self.pendentes += 1
+        if self.pendentes >= LINHAS_POR_FLUSH:
+            self.flush()
+
+    def flush(self):
+        if self.arquivo is not None:
+            self.arquivo.flush()
+            self.pendentes = 0
+
+    def fecha(self):
+        if self.arquivo is not None:
+            self.arquivo.close()
+            self.arquivo = None
 
 
-def log_diferente(novo_log, ultimo_log):
-    return ultimo_log is None or novo_log != ultimo_log
+class Ingestor:
+    """Separa o fluxo da placa em registros binários de telemetria (quadros COBS entre 0x00)
+    e texto; do texto, só as linhas BENCH são gravadas, as demais vão para a tela."""
 
+    def __init__(self, telemetria, bench, eco=False):
+        self.telemetria = telemetria
+        self.bench = bench
+        self.eco = eco
+        self.resto = b''
+        self.texto = b''
+        self.registros = 0
+        self.descartados = 0
 
-# Abre a porta serial
-ser = serial.Serial(porta_serial, baudrate, timeout=1)
-nome_arquivo = 'serial_data.csv'
+    def alimenta(self, dados):
+        partes = (self.resto + dados).split(b'\x00')
+        # O último pedaço pode estar incompleto; espera pelo próximo delimitador.
+        self.resto = partes.pop()
+        agora = time.time()
+        for parte in partes:
+            if not parte:
+                continue
+            registro = decodifica_quadro(parte)
+            if registro is not None:
+                self.telemetria.grava([agora] + [registro[campo] for campo in CAMPOS])
+                self.registros += 1
+            else:
+                self._texto(parte, agora)
 
-try:
-    print(f"Monitoring serial door {porta_serial}... Press Ctrl+C to stop.")
+    def _texto(self, dados, agora):
+        linhas = (self.texto + dados).split(b'\n')
+        self.texto = linhas.pop()
+        for bruta in linhas:
+            linha = bruta.decode('utf-8', errors='replace').strip()
+            if linha.startswith('BENCH,') and linha != 'BENCH,' + ','.join(COLUNAS_BENCH):
+                campos = linha.split(',')[1:]
+                try:
+                    if len(campos) != len(COLUNAS_BENCH):
+                        raise ValueError(linha)
+                    self.bench.grava([agora, campos[0]] + [int(v) for v in campos[1:5]] +
+                                    [float(v) for v in campos[5:]])
+                except ValueError:
+                    self.descartados += 1
+            elif linha and self.eco:
+                print(linha)
+
+    def flush(self):
+        self.telemetria.flush()
+        self.bench.flush()
+
+
+def leitura_serial(ser):
     while True:
-        if ser.in_waiting > 0:
-            linha = ser.readline().decode('utf-8').strip()
-            timestamp = datetime.now()
+        yield ser.read(ser.in_waiting or 1)
+
+
+def leitura_arquivo(arquivo):
+    return iter(lambda: arquivo.read(65536), b'')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Grava a telemetria da placa em CSVs rotativos.')
+    parser.add_argument('porta', nargs='?', default=porta_serial,
+                        help='porta serial (ou pseudo-terminal) da placa')
+    parser.add_argument('--replay', metavar='ARQUIVO',
+                        help='lê uma captura binária gravada em vez da porta serial')
+    parser.add_argument('--baudrate', type=int, default=baudrate)
+    parser.add_argument('--dir', default='.', help='diretório dos arquivos CSV')
+    parser.add_argument('--max-bytes', type=int, default=TAMANHO_MAXIMO,
+                        help='tamanho a partir do qual um novo arquivo é aberto')
+    parser.add_argument('--eco', action='store_true', help='mostra as linhas de texto da placa')
+    args = parser.parse_args()
+
+    os.makedirs(args.dir, exist_ok=True)
+    ingestor = Ingestor(ArquivoRotativo(args.dir, 'telemetry', CAMPOS, args.max_bytes),
+                        ArquivoRotativo(args.dir, 'bench', COLUNAS_BENCH, args.max_bytes),
+                        eco=args.eco)
 
+    if args.replay:
+        origem = open(args.replay, 'rb')
+        fluxo = leitura_arquivo(origem)
+    else:
+        import serial
+        origem = serial.Serial(args.porta, args.baudrate, timeout=0.1)
+        fluxo = leitura_serial(origem)
+        print(f"Monitoring serial door {args.porta}... Press Ctrl+C to stop.", file=sys.stderr)
 
-            if (timestamp - ultima_amostragem).total_seconds() * 1000 >= intervalo_ms and log_diferente(linha, ultimo_log):
-                dados.append([timestamp.strftime('%Y-%m-%d %H:%M:%S'), linha])
-                print(f'{timestamp.strftime("%H:%M:%S")} - {linha}')
+    try:
+        for dados in fluxo:
+            if dados:
+                ingestor.alimenta(dados)
+            else:
+                # Porta ociosa: garante que o que chegou já está em disco.
+                ingestor.flush()
+    except KeyboardInterrupt:
+        print("\nSerial reading interupted!", file=sys.stderr)
+    finally:
+        origem.close()
+        ingestor.telemetria.fecha()
+        ingestor.bench.fecha()
+        print(f'{ingestor.registros} registros gravados, {ingestor.descartados} linhas BENCH inválidas',
+              file=sys.stderr)
 
-                ultimo_log = linha
-                ultima_amostragem = timestamp
 
-except KeyboardInterrupt:
-    print("\nSerial reading interupted!")
-finally:
-    ser.close()
-    df = pd.DataFrame(dados, columns=['Timestamp', 'Data'])
-    df.to_csv(nome_arquivo, index=False)
-    print(f'Data sucessfuly saved in {nome_arquivo}')
\ No newline at end of file
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,119 @@
+import struct
+import sys
+
+
+porta_serial = 'COM3' # mude para a porta serial do seu computador
+baudrate = 115200
+
+# Layout de telemetry_record_t (telemetry.h): little-endian, sem preenchimento.
+ESTAGIOS = ['mic_wait', 'mic_power', 'mic_decimate', 'spl', 'spectrum',
+            'display_draw', 'ssd1306_update', 'led_matrix', 'np_write']
+FORMATO = struct.Struct('<BBBBIf6fhhIIIIIIIH4ffIBBf%dH' % len(ESTAGIOS))
+CAMPOS = ['type', 'sensitivity', 'view', 'power', 'timestamp_ms', 'rms',
+          'laf', 'las', 'lcf', 'laeq', 'lafmax', 'lafmin', 'adc_min', 'adc_max',
+          'mic_overruns', 'pipeline_dropped', 'telemetry_dropped', 'frame_overruns', 'led_overruns',
+          'trigger_fired', 'armed_blocks', 'spl_load',
+          'adc0_db', 'adc1_db', 'adc2_db', 'adc3_db', 'temperature_c', 'channel_rate',
+          'channel_mask', 'source', 'dc_offset'] + \
+         ['us_' + nome for nome in ESTAGIOS]
+TIPO_QUADRO = 0x01
+
+# Layout de recorder_audio_record_t (recorder.h): parte de um evento gravado.
+AMOSTRAS_AUDIO = 100
+FORMATO_AUDIO = struct.Struct('<BBHII%dh' % AMOSTRAS_AUDIO)
+TIPO_AUDIO = 0x02
+
+
+def crc16(dados):
+    # CRC-16/CCITT (polinômio 0x1021, valor inicial 0xFFFF), igual ao firmware.
+    crc = 0xFFFF
+    for byte in dados:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(dados):
+    saida = bytearray()
+    i = 0
+    while i < len(dados):
+        codigo = dados[i]
+        if codigo == 0 or i + codigo > len(dados) + 1:
+            return None
+        saida += dados[i + 1:i + codigo]
+        i += codigo
+        if codigo < 0xFF and i < len(dados):
+            saida.append(0)
+    return bytes(saida)
+
+
+def registro_valido(quadro, formato, tipo):
+    # Registro sem o CRC, ou None se o tamanho, o CRC ou o tipo não conferem.
+    payload = cobs_decode(quadro)
+    if payload is None or len(payload) != formato.size + 2:
+        return None
+    registro, crc = payload[:-2], payload[-2] | (payload[-1] << 8)
+    if crc16(registro) != crc or registro[0] != tipo:
+        return None
+    return registro
+
+
+def decodifica_quadro(quadro):
+    """Devolve o registro como dicionário, ou None se o quadro não for telemetria válida
+    (por exemplo, texto de LOG_INFO ou linhas BENCH misturadas ao fluxo)."""
+    registro = registro_valido(quadro, FORMATO, TIPO_QUADRO)
+    if registro is None:
+        return None
+    return dict(zip(CAMPOS, FORMATO.unpack(registro)))
+
+
+def decodifica_audio(quadro):
+    """Devolve (seq, posição, amostras) de um registro de áudio, ou None."""
+    registro = registro_valido(quadro, FORMATO_AUDIO, TIPO_AUDIO)
+    if registro is None:
+        return None
+    campos = FORMATO_AUDIO.unpack(registro)
+    _, _, quantidade, seq, posicao = campos[:5]
+    return seq, posicao, campos[5:5 + quantidade]
+
+
+def quadros(fluxo):
+    # Os quadros são delimitados por 0x00; qualquer byte fora deles é descartado.
+    pendente = bytearray()
+    for bloco in fluxo:
+        for byte in bloco:
+            if byte == 0:
+                if pendente:
+                    yield bytes(pendente)
+                    pendente.clear()
+            else:
+                pendente.append(byte)
+
+
+def leitura_serial(ser):
+    while True:
+        yield ser.read(ser.in_waiting or 1)
+
+
+if __name__ == '__main__':
+    if len(sys.argv) > 1:
+        # Decodifica uma captura binária gravada em arquivo.
+        origem = open(sys.argv[1], 'rb')
+        fluxo = iter(lambda: origem.read(4096), b'')
+    else:
+        import serial
+        origem = serial.Serial(porta_serial, baudrate, timeout=1)
+        fluxo = leitura_serial(origem)
+
+    print(','.join(CAMPOS))
+    try:
+        for quadro in quadros(fluxo):
+            registro = decodifica_quadro(quadro)
+            if registro is not None:
+                print(','.join(str(registro[campo]) for campo in CAMPOS))
+    except KeyboardInterrupt:
+        print("\nSerial reading interupted!", file=sys.stderr)
+    finally:
+        origem.close()
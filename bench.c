@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include "bench.h"
+#include "hardware/clocks.h"
+
+#if BENCH_ENABLED
+
+// O SysTick é um contador decrescente de 24 bits.
+#define SYSTICK_MASK 0x00FFFFFFu
+
+static const char *STAGE_NAMES[BENCH_STAGES] = {
+    "mic_wait",
+    "mic_power",
+    "mic_decimate",
+    "spl",
+    "spectrum",
+    "display_draw",
+    "ssd1306_update",
+    "led_matrix",
+    "np_write",
+};
+
+// Ciclos das últimas medições de cada estágio.
+static uint32_t samples[BENCH_STAGES][BENCH_FRAMES];
+static uint16_t counts[BENCH_STAGES];
+static volatile uint32_t last_cycles[BENCH_STAGES];
+
+void bench_init_core(void) {
+    systick_hw->csr = 0;
+    systick_hw->rvr = SYSTICK_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5; // Habilitado, clock do processador, sem interrupção.
+
+    if (get_core_num() == 0)
+        printf("BENCH,stage,n,min_cycles,mean_cycles,p99_cycles,min_us,mean_us,p99_us\n");
+}
+
+/**
+ * Emite uma linha CSV com mínimo, média e percentil 99 do estágio.
+ */
+static void bench_report(bench_stage_t stage) {
+    uint32_t sorted[BENCH_FRAMES];
+    uint64_t sum = 0;
+
+    // Ordenação por inserção: só roda uma vez a cada BENCH_FRAMES quadros.
+    for (uint i = 0; i < BENCH_FRAMES; ++i) {
+        uint32_t v = samples[stage][i];
+        uint j = i;
+        for (; j > 0 && sorted[j - 1] > v; --j)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = v;
+        sum += v;
+    }
+
+    uint32_t min = sorted[0];
+    uint32_t mean = (uint32_t)(sum / BENCH_FRAMES);
+    uint32_t p99 = sorted[(BENCH_FRAMES * 99 + 99) / 100 - 1];
+    float cycles_per_us = clock_get_hz(clk_sys) / 1e6f;
+
+    printf("BENCH,%s,%u,%lu,%lu,%lu,%.1f,%.1f,%.1f\n", STAGE_NAMES[stage], BENCH_FRAMES,
+           (unsigned long)min, (unsigned long)mean, (unsigned long)p99,
+           min / cycles_per_us, mean / cycles_per_us, p99 / cycles_per_us);
+}
+
+void bench_stop(bench_stage_t stage, uint32_t start) {
+    uint32_t cycles = (start - systick_hw->cvr) & SYSTICK_MASK;
+
+    last_cycles[stage] = cycles;
+    samples[stage][counts[stage]++] = cycles;
+    if (counts[stage] == BENCH_FRAMES) {
+        counts[stage] = 0;
+        bench_report(stage);
+    }
+}
+
+uint16_t bench_last_us(bench_stage_t stage) {
+    uint32_t us = last_cycles[stage] / (clock_get_hz(clk_sys) / 1000000);
+    return us > UINT16_MAX ? UINT16_MAX : (uint16_t)us;
+}
+
+#endif // BENCH_ENABLED
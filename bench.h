@@ -0,0 +1,70 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "hardware/structs/systick.h"
+
+// Liga a medição de tempo dos estágios (definido pelo CMake com -DBENCH=ON).
+#ifndef BENCH_ENABLED
+#define BENCH_ENABLED 0
+#endif
+
+// Quantidade de quadros guardados por estágio; um relatório é emitido a cada BENCH_FRAMES medições.
+#define BENCH_FRAMES 128
+
+/**
+ * Estágios do laço principal. Cada estágio é medido sempre pelo mesmo núcleo.
+ */
+typedef enum {
+    BENCH_MIC_WAIT,       // Núcleo 0: espera do bloco do ADC
+    BENCH_MIC_POWER,      // Núcleo 0: mic_power()
+    BENCH_MIC_DECIMATE,   // Núcleo 0: mic_decimate()
+    BENCH_SPL,            // Núcleo 0: spl_process()
+    BENCH_SPECTRUM,       // Núcleo 0: spectrum_feed()/spectrum_compute()
+    BENCH_DISPLAY_DRAW,   // Núcleo 1: update_full_display()/update_spectrum_display()
+    BENCH_SSD1306_UPDATE, // Núcleo 1: ssd1306_update_async()
+    BENCH_LED_MATRIX,     // Núcleo 1: update_led_matrix()/update_led_spectrum()
+    BENCH_NP_WRITE,       // Núcleo 1: npWrite()
+    BENCH_STAGES
+} bench_stage_t;
+
+#if BENCH_ENABLED
+
+/**
+ * Liga o SysTick do núcleo que chamou, contando ciclos de clk_sys. Chamar uma vez em cada núcleo.
+ */
+void bench_init_core(void);
+
+/**
+ * Guarda a duração de um estágio e emite o relatório CSV quando completar BENCH_FRAMES medições.
+ * @param stage Estágio medido
+ * @param start Valor de bench_start() no início do estágio
+ */
+void bench_stop(bench_stage_t stage, uint32_t start);
+
+/**
+ * Duração da medição mais recente de um estágio, para a telemetria.
+ * @param stage Estágio medido
+ * @return Duração em microssegundos (saturada em 65535)
+ */
+uint16_t bench_last_us(bench_stage_t stage);
+
+/**
+ * Lê o contador de ciclos do núcleo atual.
+ * @return Valor a ser passado para bench_stop()
+ */
+static inline uint32_t bench_start(void) {
+    return systick_hw->cvr;
+}
+
+#else
+
+static inline void bench_init_core(void) {}
+static inline uint32_t bench_start(void) { return 0; }
+static inline void bench_stop(bench_stage_t stage, uint32_t start) { (void)stage; (void)start; }
+static inline uint16_t bench_last_us(bench_stage_t stage) { (void)stage; return 0; }
+
+#endif // BENCH_ENABLED
+
+#endif // BENCH_H
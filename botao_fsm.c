@@ -0,0 +1,99 @@
+#include "botao_fsm.h"
+
+void botao_fsm_init(botao_fsm_t* fsm, bool duplo) {
+    *fsm = (botao_fsm_t){ .duplo = duplo };
+}
+
+void botao_fsm_borda(botao_fsm_t* fsm, bool pressionado, uint32_t t_us) {
+    // Cada borda reinicia a janela de debounce; só o último nível conta.
+    fsm->bruto = pressionado;
+    fsm->bruto_us = t_us;
+    fsm->pendente = true;
+}
+
+void botao_fsm_pulso(botao_fsm_t* fsm, bool pressionado, uint32_t t_us) {
+    if (!fsm->pendente && !fsm->pulso && pressionado == fsm->estavel) {
+        fsm->pulso = true;
+        fsm->pulso_us = t_us;
+    }
+    // Bordas que vierem logo depois ainda passam pela janela de debounce.
+    botao_fsm_borda(fsm, pressionado, t_us);
+}
+
+void botao_fsm_amostra(botao_fsm_t* fsm, bool pressionado, uint32_t t_us) {
+    // A amostra vem depois de todas as bordas enfileiradas antes dela, então vale como a
+    // última borda, inclusive quando bordas se perderam com a fila cheia.
+    if (fsm->pendente || pressionado != fsm->estavel)
+        botao_fsm_borda(fsm, pressionado, t_us);
+}
+
+// Transições do nível estável; a de soltura devolve o evento do clique, se houver.
+static void botao_fsm_pressiona(botao_fsm_t* fsm, uint32_t t_us) {
+    fsm->estavel = true;
+    fsm->pressao_us = t_us;
+    fsm->longo_emitido = false;
+    fsm->segundo_clique = fsm->clique_pendente && t_us - fsm->soltura_us <= BOTAO_DUPLO_US;
+    if (fsm->segundo_clique)
+        fsm->clique_pendente = false;
+}
+
+static botao_evento_t botao_fsm_solta(botao_fsm_t* fsm, uint32_t t_us) {
+    fsm->estavel = false;
+    if (fsm->longo_emitido)
+        return BOTAO_NENHUM;
+    if (fsm->segundo_clique) {
+        fsm->segundo_clique = false;
+        return BOTAO_CLIQUE_DUPLO;
+    }
+    if (!fsm->duplo)
+        return BOTAO_CLIQUE;
+    fsm->clique_pendente = true;
+    fsm->soltura_us = t_us;
+    return BOTAO_NENHUM;
+}
+
+botao_evento_t botao_fsm_atualiza(botao_fsm_t* fsm, uint32_t agora_us) {
+    // Pulso completo: as duas transições no instante da interrupção.
+    if (fsm->pulso) {
+        fsm->pulso = false;
+        botao_evento_t e;
+        if (fsm->estavel) {
+            e = botao_fsm_solta(fsm, fsm->pulso_us);
+            botao_fsm_pressiona(fsm, fsm->pulso_us);
+        } else {
+            botao_fsm_pressiona(fsm, fsm->pulso_us);
+            e = botao_fsm_solta(fsm, fsm->pulso_us);
+        }
+        if (e != BOTAO_NENHUM)
+            return e;
+    }
+
+    // As diferenças em uint32_t continuam corretas quando o contador dá a volta.
+    if (fsm->pendente && agora_us - fsm->bruto_us >= BOTAO_DEBOUNCE_US) {
+        fsm->pendente = false;
+
+        // A transição vale a partir da borda, não do fim da janela de debounce.
+        if (fsm->bruto != fsm->estavel) {
+            if (fsm->bruto) {
+                botao_fsm_pressiona(fsm, fsm->bruto_us);
+            } else {
+                botao_evento_t e = botao_fsm_solta(fsm, fsm->bruto_us);
+                if (e != BOTAO_NENHUM)
+                    return e;
+            }
+        }
+    }
+
+    if (fsm->estavel && !fsm->longo_emitido && agora_us - fsm->pressao_us >= BOTAO_LONGO_US) {
+        fsm->longo_emitido = true;
+        fsm->segundo_clique = false;
+        return BOTAO_LONGO;
+    }
+
+    if (fsm->clique_pendente && agora_us - fsm->soltura_us > BOTAO_DUPLO_US) {
+        fsm->clique_pendente = false;
+        return BOTAO_CLIQUE;
+    }
+
+    return BOTAO_NENHUM;
+}
@@ -0,0 +1,84 @@
+#ifndef BOTAO_FSM_H
+#define BOTAO_FSM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Tempos da máquina de estados dos botões (µs, medidos pelo timer de hardware).
+#define BOTAO_DEBOUNCE_US 20000      // O nível precisa ficar estável por este tempo para valer.
+#define BOTAO_LONGO_US 800000        // Pressionado por mais que isto é um clique longo.
+#define BOTAO_DUPLO_US 300000        // Intervalo máximo entre soltar e pressionar de novo num clique duplo.
+
+/**
+ * Eventos entregues ao laço principal.
+ */
+typedef enum {
+    BOTAO_NENHUM,
+    BOTAO_CLIQUE,       // Pressionado e solto
+    BOTAO_CLIQUE_DUPLO, // Dois cliques dentro de BOTAO_DUPLO_US
+    BOTAO_LONGO         // Mantido pressionado por BOTAO_LONGO_US (emitido sem esperar soltar)
+} botao_evento_t;
+
+/**
+ * Estado de um botão. Não depende do SDK: as bordas chegam com o instante em que a
+ * interrupção ocorreu e o tempo atual é passado por quem chama.
+ */
+typedef struct {
+    bool duplo;          // Detecta clique duplo (o clique simples espera BOTAO_DUPLO_US)
+    bool bruto;          // Último nível lido na interrupção (true = pressionado)
+    uint32_t bruto_us;   // Instante da última borda
+    bool pendente;       // Há uma borda ainda dentro da janela de debounce
+    bool estavel;        // Nível depois do debounce
+    uint32_t pressao_us; // Instante em que o botão foi pressionado
+    bool longo_emitido;  // BOTAO_LONGO já foi entregue nesta pressão
+    bool segundo_clique; // Esta pressão é a segunda de um clique duplo
+    bool clique_pendente; // Clique aguardando o fim da janela do clique duplo
+    uint32_t soltura_us; // Instante em que o último clique terminou
+    bool pulso;          // Pulso completo (duas bordas numa interrupção) ainda não entregue
+    uint32_t pulso_us;   // Instante do pulso
+} botao_fsm_t;
+
+/**
+ * Inicializa o estado com o botão solto.
+ * @param fsm Estado do botão
+ * @param duplo true para detectar clique duplo
+ */
+void botao_fsm_init(botao_fsm_t* fsm, bool duplo);
+
+/**
+ * Registra uma borda vinda da interrupção.
+ * @param fsm Estado do botão
+ * @param pressionado Nível do pino logo após a borda
+ * @param t_us Instante da borda
+ */
+void botao_fsm_borda(botao_fsm_t* fsm, bool pressionado, uint32_t t_us);
+
+/**
+ * Registra as duas bordas entregues numa única interrupção (o pino foi e voltou enquanto
+ * as interrupções estavam desligadas, por exemplo durante uma gravação na flash).
+ * Fora da janela de debounce, com o nível de volta ao estável, conta como um pulso
+ * completo (pressionar e soltar, ou soltar e pressionar); senão, como uma borda comum.
+ * @param fsm Estado do botão
+ * @param pressionado Nível do pino depois das duas bordas
+ * @param t_us Instante da interrupção
+ */
+void botao_fsm_pulso(botao_fsm_t* fsm, bool pressionado, uint32_t t_us);
+
+/**
+ * Registra o nível lido no fim da janela de debounce (alarme armado pela borda em t_us).
+ * Esse nível, já assentado, vale no lugar do lido na interrupção da última borda.
+ * @param fsm Estado do botão
+ * @param pressionado Nível do pino no fim da janela
+ * @param t_us Instante da borda que armou o alarme
+ */
+void botao_fsm_amostra(botao_fsm_t* fsm, bool pressionado, uint32_t t_us);
+
+/**
+ * Avança os temporizadores até agora_us. Chamar até devolver BOTAO_NENHUM.
+ * @param fsm Estado do botão
+ * @param agora_us Tempo atual
+ * @return Próximo evento, ou BOTAO_NENHUM
+ */
+botao_evento_t botao_fsm_atualiza(botao_fsm_t* fsm, uint32_t agora_us);
+
+#endif // BOTAO_FSM_H
@@ -0,0 +1,174 @@
+#include "calibration.h"
+#include <math.h>
+#include "hardware/sync.h"
+
+// Pedido do núcleo 1: a referência é escrita antes de o contador mudar.
+static volatile float requested_db;
+static volatile uint32_t requests;
+static uint32_t handled;
+
+static enum { CALIBRATION_IDLE, CALIBRATION_SETTLING, CALIBRATION_MEASURING } state;
+static float reference_db;
+static uint32_t start_ms;
+
+// Medição: energia total (em contagens²), trecho atual e extremos entre trechos.
+static uint64_t total_sum_squared;
+static uint64_t total_count;
+static uint64_t segment_sum_squared;
+static uint32_t segment_count;
+static uint32_t segment_start_ms;
+static float segment_min;
+static float segment_max;
+static int32_t peak;
+static uint32_t crossings;
+static int last_sign;
+static uint64_t decimated_samples; // Amostras em que os cruzamentos foram contados
+
+// Última medição aceita desde o boot: 20·log10(V) e a referência usada.
+static bool has_point;
+static float point_volts_db;
+static float point_reference_db;
+
+void calibration_request(float reference_db) {
+    requested_db = reference_db;
+    __mem_fence_release();
+    ++requests;
+}
+
+static void start_measuring(uint32_t now_ms) {
+    state = CALIBRATION_MEASURING;
+    start_ms = segment_start_ms = now_ms;
+    total_sum_squared = total_count = 0;
+    segment_sum_squared = segment_count = 0;
+    segment_min = INFINITY;
+    segment_max = 0;
+    peak = 0;
+    crossings = 0;
+    last_sign = 0;
+    decimated_samples = 0;
+}
+
+/**
+ * Soma o trecho à medição. Só trechos completos entram na estabilidade: o último pode
+ * ter uma fração de ciclo do tom.
+ */
+static void close_segment(bool complete) {
+    if (segment_count == 0)
+        return;
+
+    if (complete) {
+        float mean_square = (float)segment_sum_squared / segment_count;
+        segment_min = fminf(segment_min, mean_square);
+        segment_max = fmaxf(segment_max, mean_square);
+    }
+    total_sum_squared += segment_sum_squared;
+    total_count += segment_count;
+    segment_sum_squared = segment_count = 0;
+}
+
+/**
+ * Conta as trocas de sinal das amostras decimadas, que já estão sem o nível DC e sem o
+ * ruído acima da banda de áudio. Amostras zero não mudam o sinal anterior.
+ */
+static void count_crossings(const int16_t* samples, uint count) {
+    for (uint i = 0; i < count; ++i) {
+        int sign = (samples[i] > 0) - (samples[i] < 0);
+        if (sign != 0 && sign != last_sign) {
+            if (last_sign != 0)
+                ++crossings;
+            last_sign = sign;
+        }
+    }
+    decimated_samples += count;
+}
+
+static void finish(calibration_result_t* result) {
+    close_segment(false);
+    state = CALIBRATION_IDLE;
+
+    float gain, offset;
+    mic_get_calibration(&gain, &offset);
+
+    // 20·log10(V RMS) da medição inteira: o valor que mic_rms_to_db() recebe.
+    float rms = sqrtf((float)total_sum_squared / (float)total_count) * ADC_VOLTS_PER_COUNT;
+    float volts_db = 20.0f * log10f(rms);
+
+    // Duração pelas amostras contadas e pela taxa decimada: now_ms só avança em blocos
+    // inteiros e conta o tempo até o bloco ser atendido, não o que ele contém.
+    float seconds = (float)decimated_samples / mic_get_decimated_rate();
+
+    *result = (calibration_result_t){
+        .reference_db = reference_db,
+        .measured_db = gain * volts_db + offset,
+        .spread_db = 10.0f * log10f(segment_max / segment_min),
+        .frequency_hz = crossings / 2.0f / seconds,
+        .gain = gain,
+        .offset = offset,
+    };
+
+    if (peak >= CALIBRATION_CLIP_COUNTS)
+        result->status = CALIBRATION_CLIPPED;
+    else if (!(result->spread_db <= CALIBRATION_MAX_SPREAD_DB))
+        result->status = CALIBRATION_UNSTABLE;
+    else if (fabsf(result->frequency_hz - CALIBRATION_FREQUENCY_HZ) >
+             CALIBRATION_FREQUENCY_HZ * CALIBRATION_FREQUENCY_TOLERANCE)
+        result->status = CALIBRATION_WRONG_FREQUENCY;
+    else
+        result->status = CALIBRATION_OK;
+
+    if (result->status != CALIBRATION_OK)
+        return;
+
+    // Duas referências distantes: reta pelos dois pontos. Senão, só o offset muda.
+    if (has_point && fabsf(reference_db - point_reference_db) >= CALIBRATION_TWO_POINT_DB) {
+        float two_point_gain = (reference_db - point_reference_db) / (volts_db - point_volts_db);
+        if (!(two_point_gain >= CALIBRATION_GAIN_MIN && two_point_gain <= CALIBRATION_GAIN_MAX)) {
+            result->status = CALIBRATION_BAD_GAIN;
+            return;
+        }
+        result->gain = two_point_gain;
+        result->two_point = true;
+    }
+    result->offset = reference_db - result->gain * volts_db;
+
+    has_point = true;
+    point_volts_db = volts_db;
+    point_reference_db = reference_db;
+}
+
+bool calibration_feed(const mic_block_stats_t* block, const int16_t* decimated, uint count, uint32_t now_ms,
+                      calibration_result_t* result) {
+    if (requests != handled) {
+        handled = requests;
+        __mem_fence_acquire();
+        reference_db = requested_db;
+        state = CALIBRATION_SETTLING;
+        start_ms = now_ms;
+    }
+
+    if (state == CALIBRATION_IDLE || block->count == 0)
+        return false;
+
+    if (state == CALIBRATION_SETTLING) {
+        if (now_ms - start_ms < CALIBRATION_SETTLE_MS)
+            return false;
+        start_measuring(now_ms);
+    }
+
+    if (now_ms - segment_start_ms >= CALIBRATION_SEGMENT_MS) {
+        close_segment(true);
+        segment_start_ms = now_ms;
+    }
+
+    segment_sum_squared += block->sum_squared;
+    segment_count += block->count;
+    if (block->max > peak) peak = block->max;
+    if (-block->min > peak) peak = -block->min;
+    count_crossings(decimated, count);
+
+    if (now_ms - start_ms < CALIBRATION_MEASURE_MS)
+        return false;
+
+    finish(result);
+    return true;
+}
@@ -0,0 +1,76 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "mic.h"
+
+// Calibrador padrão: 94 dB (1 Pa) em 1 kHz, onde a ponderação A é 0 dB.
+#define CALIBRATION_REFERENCE_DB 94.0f
+#define CALIBRATION_FREQUENCY_HZ 1000.0f
+
+// Espera o calibrador estabilizar e depois mede; a medição é dividida em trechos para
+// conferir a estabilidade.
+#define CALIBRATION_SETTLE_MS 500
+#define CALIBRATION_MEASURE_MS 3000
+#define CALIBRATION_SEGMENT_MS 100
+
+// Critérios de aceitação: diferença entre o trecho mais forte e o mais fraco, desvio da
+// frequência medida e pico máximo (contagens do ADC, sem o nível DC).
+#define CALIBRATION_MAX_SPREAD_DB 1.0f
+#define CALIBRATION_FREQUENCY_TOLERANCE 0.1f
+#define CALIBRATION_CLIP_COUNTS 2000
+
+// Duas medições com referências pelo menos tão distantes definem também o ganho.
+#define CALIBRATION_TWO_POINT_DB 10.0f
+#define CALIBRATION_GAIN_MIN 0.2f
+#define CALIBRATION_GAIN_MAX 5.0f
+
+/**
+ * Resultado de uma calibração.
+ */
+typedef enum {
+    CALIBRATION_OK,
+    CALIBRATION_CLIPPED,         // Sinal saturou o ADC: use um nível menor ou afaste o calibrador
+    CALIBRATION_UNSTABLE,        // Nível variou mais que CALIBRATION_MAX_SPREAD_DB
+    CALIBRATION_WRONG_FREQUENCY, // Não parece o tom do calibrador
+    CALIBRATION_BAD_GAIN         // Ganho das duas medições fora da faixa aceitável
+} calibration_status_t;
+
+typedef struct {
+    calibration_status_t status;
+    float reference_db; // Nível do calibrador
+    float measured_db;  // Nível medido com a calibração anterior
+    float spread_db;    // Diferença entre o trecho mais forte e o mais fraco
+    float frequency_hz; // Cruzamentos por zero pela duração das amostras decimadas
+    float gain;         // Fatores novos para mic_set_calibration()
+    float offset;
+    bool two_point;     // O ganho também foi calculado
+} calibration_result_t;
+
+/**
+ * Pede uma calibração com o calibrador já encaixado no microfone. Pode ser chamada
+ * pelo núcleo 1 (console); a medição é feita pelo núcleo 0.
+ * @param reference_db Nível do calibrador (dB)
+ */
+void calibration_request(float reference_db);
+
+/**
+ * Acumula um bloco se há calibração em andamento; sem pedido, só compara um contador.
+ * Os fatores novos não são aplicados: o chamador decide pelo status.
+ *
+ * Uma medição só corrige o offset, mantendo o ganho atual. Se a anterior (desde o boot)
+ * usou uma referência a pelo menos CALIBRATION_TWO_POINT_DB de distância, as duas
+ * definem o ganho e o offset.
+ * @param block Estatísticas do bloco do microfone, já sem o nível DC (mic_remove_dc())
+ * @param decimated Amostras decimadas do mesmo bloco (mic_decimate())
+ * @param count Número de amostras decimadas
+ * @param now_ms Tempo atual
+ * @param result Recebe o resultado quando a medição termina
+ * @return true quando a medição termina e result foi preenchido
+ */
+bool calibration_feed(const mic_block_stats_t* block, const int16_t* decimated, uint count, uint32_t now_ms,
+                      calibration_result_t* result);
+
+#endif // CALIBRATION_H
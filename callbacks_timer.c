@@ -1,63 +1,155 @@
 #include "callbacks_timer.h"
 
-#include "pico/bootrom.h"  // Configuração para teste do bootsel
 #include "pico/stdlib.h"
+#include "hardware/sync.h"
 #include "init_GPIO.h"
-#include <stdio.h>
 
-// Variáveis para debounce
-static volatile uint32_t ultima_interrupcao_b = 0;
-static volatile uint32_t ultima_interrupcao_a = 0;
+/**
+ * Entrada capturada na interrupção: só o pino, o nível e o instante do timer de hardware.
+ * Debounce, clique longo e clique duplo são tratados fora da interrupção (botao_fsm.c).
+ */
+typedef enum {
+    BOTAO_BORDA,   // Uma borda
+    BOTAO_PULSO,   // Descida e subida juntas numa interrupção (o pino foi e voltou)
+    BOTAO_AMOSTRA, // Nível lido pelo alarme no fim da janela de debounce
+} botao_tipo_t;
 
+typedef struct {
+    uint8_t gpio;
+    uint8_t tipo;
+    bool pressionado;
+    uint32_t t_us;
+} botao_borda_t;
 
-// No topo do arquivo principal (main.c ou equivalente)
-float threshold = 0.5f;  // Mantenha esta linha que você já tem
+/**
+ * Fila sem trava de um produtor (interrupções do GPIO e do alarme, que têm a mesma
+ * prioridade e não se interrompem) e um consumidor (laço principal), todos no núcleo 0;
+ * mesmo esquema de índices de pipeline.c.
+ */
+static botao_borda_t fila[BOTAO_FILA_SIZE];
+static volatile uint32_t head;
+static volatile uint32_t tail;
+static volatile uint32_t perdidos;
 
-// Variáveis globais para armazenar os valores de sensibilidade e threshold
-extern uint8_t sensitivity_level;
-// init_GPIO.h
-extern float threshold;  // Declaração externa
+_Static_assert((BOTAO_FILA_SIZE & (BOTAO_FILA_SIZE - 1)) == 0,
+               "BOTAO_FILA_SIZE deve ser potência de 2");
 
-// Variáveis globais para armazenar os valores de x e y do joystick
-extern int x;  // Declarado em outro arquivo (por exemplo, main.c)
-extern int y;  // Declarado em outro arquivo (por exemplo, main.c)
+// O alarme lê o pino um pouco antes do fim da janela, para a amostra chegar à fila
+// antes de botao_fsm_atualiza() fechar a janela.
+#define BOTAO_ALARME_US (BOTAO_DEBOUNCE_US - 1000)
+
+static botao_fsm_t fsm_a;
+static botao_fsm_t fsm_b;
+
+// Alarme de debounce de cada botão (0 sem alarme) e instante da borda que o armou.
+static alarm_id_t alarme[2];
+static uint32_t alarme_borda_us[2];
+
+static inline uint botao_indice(uint gpio) {
+    return gpio == BOTAO_B;
+}
+
+static void botao_enfileira(uint gpio, botao_tipo_t tipo, bool pressionado, uint32_t t_us) {
+    uint32_t h = head;
+
+    if (h - tail >= BOTAO_FILA_SIZE) {
+        ++perdidos;
+        return;
+    }
+
+    fila[h % BOTAO_FILA_SIZE] = (botao_borda_t){
+        .gpio = gpio,
+        .tipo = tipo,
+        .pressionado = pressionado,
+        .t_us = t_us,
+    };
+    __mem_fence_release();
+    head = h + 1;
+}
+
+// Fim da janela de debounce: o nível agora já assentou.
+static int64_t botao_alarme(alarm_id_t id, void* user_data) {
+    uint gpio = (uint)(uintptr_t)user_data;
+    uint i = botao_indice(gpio);
+    (void)id;
+
+    alarme[i] = 0;
+    botao_enfileira(gpio, BOTAO_AMOSTRA, !gpio_get(gpio), alarme_borda_us[i]);
+    return 0;
+}
 
 // Função de callback para tratar interrupções dos botões
 void botao_callback(uint gpio, uint32_t eventos) {
-    uint32_t tempo_atual = to_ms_since_boot(get_absolute_time());
-    
+    if (gpio != BOTAO_A && gpio != BOTAO_B)
+        return;
+
+    // Com as interrupções desligadas (gravação na flash, por exemplo), um toque inteiro
+    // chega como uma interrupção só, com as duas bordas marcadas.
+    const uint32_t ambas = GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE;
+    botao_tipo_t tipo = (eventos & ambas) == ambas ? BOTAO_PULSO : BOTAO_BORDA;
+
+    // Botões com pull-up: nível baixo é pressionado.
+    uint32_t agora = time_us_32();
+    botao_enfileira(gpio, tipo, !gpio_get(gpio), agora);
+
+    // Cada borda reinicia a janela do botão. Sem alarme livre, vale o nível lido aqui.
+    uint i = botao_indice(gpio);
+    if (alarme[i] > 0)
+        cancel_alarm(alarme[i]);
+    alarme_borda_us[i] = agora;
+    alarme[i] = add_alarm_in_us(BOTAO_ALARME_US, botao_alarme, (void*)(uintptr_t)gpio, true);
+    if (alarme[i] < 0)
+        alarme[i] = 0;
+}
+
+static botao_fsm_t* botao_fsm(uint gpio) {
     switch (gpio) {
-        case BOTAO_A:
-            if (tempo_atual - ultima_interrupcao_a > DEBOUNCE_TIME) {
-                ultima_interrupcao_a = tempo_atual;
-                if (eventos & GPIO_IRQ_EDGE_FALL) {
-                    printf("Botão A pressionado\n");
-                    sensitivity_level = (sensitivity_level % 5) + 1; // Cicla entre 1 e 5.
-                    threshold = sensitivity_level * 0.1f;            // Ajusta o limiar com base no nível.
-                    printf("Sensibilidade ajustada: %d, Limiar: %.2f\n", sensitivity_level, threshold);
-                }
-            }
-            break;
-
-        case BOTAO_B:
-            if (tempo_atual - ultima_interrupcao_b > DEBOUNCE_TIME) {
-                ultima_interrupcao_b = tempo_atual;
-                if (eventos & GPIO_IRQ_EDGE_FALL) {
-                    printf("Botão B pressionado\n");
-                    reset_usb_boot(0, 0); // Entra no modo bootsel
-                }
+        case BOTAO_A: return &fsm_a;
+        case BOTAO_B: return &fsm_b;
+        default:      return NULL;
+    }
+}
+
+bool botao_proximo_evento(uint8_t* pino, botao_evento_t* evento) {
+    // Entrega as bordas pendentes às máquinas de estados.
+    uint32_t t = tail;
+    while (t != head) {
+        __mem_fence_acquire();
+        botao_borda_t borda = fila[t % BOTAO_FILA_SIZE];
+        botao_fsm_t* fsm = botao_fsm(borda.gpio);
+        if (fsm) {
+            switch (borda.tipo) {
+                case BOTAO_BORDA:   botao_fsm_borda(fsm, borda.pressionado, borda.t_us); break;
+                case BOTAO_PULSO:   botao_fsm_pulso(fsm, borda.pressionado, borda.t_us); break;
+                case BOTAO_AMOSTRA: botao_fsm_amostra(fsm, borda.pressionado, borda.t_us); break;
             }
-            break;
-    
-        default:
-            break;
+        }
+        tail = ++t;
     }
+
+    uint32_t agora = time_us_32();
+    static const uint8_t pinos[] = {BOTAO_A, BOTAO_B};
+    for (uint i = 0; i < count_of(pinos); ++i) {
+        botao_evento_t e = botao_fsm_atualiza(botao_fsm(pinos[i]), agora);
+        if (e != BOTAO_NENHUM) {
+            *pino = pinos[i];
+            *evento = e;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t botao_get_perdidos(void) {
+    return perdidos;
 }
 
 // Função para inicializar um botão
-void botao_init(uint8_t pino) {
+void botao_init(uint8_t pino, bool duplo) {
+    botao_fsm_init(botao_fsm(pino), duplo);
+
     gpio_init(pino);
     gpio_set_dir(pino, GPIO_IN);
     gpio_pull_up(pino);
-    gpio_set_irq_enabled_with_callback(pino, GPIO_IRQ_EDGE_FALL, true, &botao_callback);
-}
\ No newline at end of file
+    gpio_set_irq_enabled_with_callback(pino, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, &botao_callback);
+}
@@ -3,8 +3,33 @@
 
 #include <stdbool.h>
 #include "pico/stdlib.h"
+#include "botao_fsm.h"
+
+// Capacidade da fila de bordas e amostras entre as interrupções e o laço principal (potência de 2).
+#define BOTAO_FILA_SIZE 16
 
 void botao_callback(uint gpio, uint32_t eventos);
-void botao_init(uint8_t pino);
 
-#endif
\ No newline at end of file
+/**
+ * Configura o pino com pull-up e interrupção nas duas bordas. Cada borda arma um alarme
+ * que lê o pino de novo no fim da janela de debounce.
+ * @param pino BOTAO_A ou BOTAO_B
+ * @param duplo true para detectar clique duplo neste botão
+ */
+void botao_init(uint8_t pino, bool duplo);
+
+/**
+ * Processa as bordas enfileiradas pela interrupção e os temporizadores dos botões.
+ * Deve ser chamada no laço principal até devolver false.
+ * @param pino Recebe o pino que gerou o evento
+ * @param evento Recebe o evento
+ * @return false quando não há mais eventos
+ */
+bool botao_proximo_evento(uint8_t* pino, botao_evento_t* evento);
+
+/**
+ * Bordas e amostras descartadas porque a fila estava cheia.
+ */
+uint32_t botao_get_perdidos(void);
+
+#endif
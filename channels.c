@@ -0,0 +1,81 @@
+#include "channels.h"
+#include <math.h>
+
+// Soma das estatísticas dos blocos do quadro, por entrada do ADC.
+static struct {
+    uint64_t sum_squared;
+    int64_t sum;
+    uint32_t count;
+} frame[MIC_INPUTS];
+
+static uint32_t frame_start_us;
+
+void channels_init(void) {
+    for (uint channel = 0; channel < MIC_INPUTS; ++channel)
+        frame[channel].sum_squared = frame[channel].sum = frame[channel].count = 0;
+    frame_start_us = time_us_32();
+}
+
+void channels_accumulate(const uint16_t* block, const mic_block_stats_t* mic) {
+    uint stride = mic_channel_count();
+
+    for (uint channel = 0; channel < MIC_INPUTS; ++channel) {
+        mic_block_stats_t stats;
+        const uint16_t* samples = mic_channel_samples(block, channel);
+        if (samples == NULL)
+            continue;
+
+        if (channel == MIC_CHANNEL)
+            stats = *mic;
+        else
+            mic_block_stats(samples, SAMPLES, stride, &stats);
+
+        frame[channel].sum_squared += stats.sum_squared;
+        frame[channel].sum += stats.sum;
+        frame[channel].count += stats.count;
+    }
+}
+
+void channels_close_frame(channels_levels_t* levels, uint32_t now_us) {
+    uint32_t elapsed_us = now_us - frame_start_us;
+    frame_start_us = now_us;
+
+    *levels = (channels_levels_t){0};
+    levels->rate = elapsed_us ? (uint32_t)((uint64_t)frame[MIC_CHANNEL].count * 1000000u / elapsed_us) : 0;
+
+    for (uint channel = 0; channel < MIC_INPUTS; ++channel) {
+        uint32_t count = frame[channel].count;
+        if (count == 0)
+            continue;
+
+        if (channel == MIC_TEMP_CHANNEL) {
+            // O sensor de temperatura usa a leitura média, não o RMS em torno do ponto médio.
+            levels->temperature_c = mic_temperature_c((float)frame[channel].sum / count + ADC_MIDPOINT);
+        } else {
+            // Variância em torno da média: a componente DC da entrada não entra no nível.
+            float mean = (float)frame[channel].sum / count;
+            float variance = (float)frame[channel].sum_squared / count - mean * mean;
+            levels->db[channel] = mic_rms_to_db(sqrtf(fmaxf(variance, 0.f)) * ADC_VOLTS_PER_COUNT);
+        }
+
+        frame[channel].sum_squared = frame[channel].sum = frame[channel].count = 0;
+    }
+}
+
+float channels_display_db(const channels_levels_t* levels, channels_source_t source, float mic_db) {
+    switch (source) {
+        case CHANNELS_SOURCE_EXTERNAL:
+            return levels->db[MIC_EXT_CHANNEL];
+        case CHANNELS_SOURCE_LOUDEST: {
+            // O microfone da placa entra com o nível do medidor, as outras entradas com o RMS.
+            float db = mic_db;
+            for (uint channel = 0; channel < MIC_TEMP_CHANNEL; ++channel) {
+                if (channel != MIC_CHANNEL && levels->db[channel] > db)
+                    db = levels->db[channel];
+            }
+            return db;
+        }
+        default:
+            return mic_db;
+    }
+}
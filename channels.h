@@ -0,0 +1,57 @@
+#ifndef CHANNELS_H
+#define CHANNELS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "mic.h"
+
+/**
+ * De onde vem o nível exibido no display e na matriz de LEDs.
+ */
+typedef enum {
+    CHANNELS_SOURCE_MIC,      // Microfone da placa (medidor completo, LAF)
+    CHANNELS_SOURCE_EXTERNAL, // Microfone externo (RMS do quadro)
+    CHANNELS_SOURCE_LOUDEST,  // Maior nível entre as entradas de áudio capturadas
+    CHANNELS_SOURCES
+} channels_source_t;
+
+/**
+ * Níveis de um quadro para cada entrada do ADC.
+ */
+typedef struct {
+    float db[MIC_TEMP_CHANNEL]; // Nível (dB, escala de mic_rms_to_db()) das entradas 0 a 3; 0 se não capturada
+    float temperature_c;        // Sensor interno (°C); 0 se não capturado
+    uint32_t rate;              // Amostras por segundo de cada entrada, medidas no quadro
+} channels_levels_t;
+
+/**
+ * Zera os acumuladores. Deve ser chamada depois de mic_set_channels().
+ */
+void channels_init(void);
+
+/**
+ * Acumula as estatísticas de um bloco para cada entrada, lendo o bloco intercalado
+ * sem copiar. O microfone da placa já foi calculado pelo chamador e não é refeito.
+ * @param block Bloco de mic_wait_ready_buffer()
+ * @param mic Estatísticas de MIC_CHANNEL neste bloco
+ */
+void channels_accumulate(const uint16_t* block, const mic_block_stats_t* mic);
+
+/**
+ * Fecha o quadro: calcula os níveis e a vazão de cada entrada e zera os acumuladores.
+ * @param levels Recebe os níveis
+ * @param now_us Tempo atual (time_us_32())
+ */
+void channels_close_frame(channels_levels_t* levels, uint32_t now_us);
+
+/**
+ * Nível exibido conforme a fonte escolhida.
+ * @param levels Níveis do quadro
+ * @param source Fonte escolhida
+ * @param mic_db Nível do medidor para o microfone da placa (LAF)
+ * @return Nível (dB)
+ */
+float channels_display_db(const channels_levels_t* levels, channels_source_t source, float mic_db);
+
+#endif // CHANNELS_H
@@ -0,0 +1,70 @@
+#include "console.h"
+#include <string.h>
+#include "log.h"
+
+static struct {
+    const char* name;
+    console_handler_t handler;
+} commands[CONSOLE_COMMANDS_MAX];
+static uint command_count;
+
+static char line[CONSOLE_LINE_MAX + 1];
+static uint line_len;
+static bool line_overflow;
+
+bool console_register(const char* name, console_handler_t handler) {
+    if (command_count >= CONSOLE_COMMANDS_MAX)
+        return false;
+
+    commands[command_count].name = name;
+    commands[command_count].handler = handler;
+    ++command_count;
+    return true;
+}
+
+static void console_execute(char* text) {
+    while (*text == ' ')
+        ++text;
+    if (*text == '\0')
+        return;
+
+    char* args = text;
+    while (*args != '\0' && *args != ' ')
+        ++args;
+    if (*args != '\0')
+        *args++ = '\0';
+    while (*args == ' ')
+        ++args;
+
+    for (uint i = 0; i < command_count; ++i) {
+        if (strcmp(commands[i].name, text) == 0) {
+            commands[i].handler(args);
+            return;
+        }
+    }
+    LOG_ERROR("Comando desconhecido: %s\n", text);
+}
+
+bool console_poll(void) {
+    bool executed = false;
+    int c;
+
+    while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        if (c == '\r' || c == '\n') {
+            // Linhas longas demais são descartadas por inteiro.
+            if (!line_overflow && line_len > 0) {
+                line[line_len] = '\0';
+                console_execute(line);
+                executed = true;
+            }
+            line_len = 0;
+            line_overflow = false;
+        } else if (line_len < CONSOLE_LINE_MAX) {
+            line[line_len++] = (char)c;
+        } else {
+            line_overflow = true;
+        }
+    }
+
+    return executed;
+}
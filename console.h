@@ -0,0 +1,32 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdbool.h>
+#include "pico/stdlib.h"
+
+// Maior linha aceita (sem o '\n') e número máximo de comandos registrados.
+#define CONSOLE_LINE_MAX 48
+#define CONSOLE_COMMANDS_MAX 8
+
+/**
+ * Trata um comando. args aponta para o resto da linha, sem espaços no início
+ * (string vazia se não houver argumentos).
+ */
+typedef void (*console_handler_t)(const char* args);
+
+/**
+ * Registra um comando de texto recebido pelo stdio (USB ou UART).
+ * @param name Primeira palavra da linha (ex.: "L")
+ * @param handler Função chamada com o resto da linha
+ * @return false se a tabela de comandos está cheia
+ */
+bool console_register(const char* name, console_handler_t handler);
+
+/**
+ * Lê os caracteres disponíveis sem bloquear e executa as linhas completas.
+ * Chamada pelo laço do núcleo 1, que é quem escreve no stdio.
+ * @return true se algum comando foi executado
+ */
+bool console_poll(void);
+
+#endif // CONSOLE_H
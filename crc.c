@@ -0,0 +1,22 @@
+#include "crc.h"
+
+uint16_t crc16_ccitt(const uint8_t* data, uint len) {
+    uint16_t crc = 0xFFFF;
+    for (uint i = 0; i < len; ++i) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+uint32_t crc32_update(uint32_t crc, const uint8_t* data, uint len) {
+    // Sem tabela: só é usada fora do caminho da captura (gravação na flash).
+    crc = ~crc;
+    for (uint i = 0; i < len; ++i) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+    }
+    return ~crc;
+}
@@ -0,0 +1,25 @@
+#ifndef CRC_H
+#define CRC_H
+
+#include <stdint.h>
+#include "pico/stdlib.h"
+
+/**
+ * CRC-16/CCITT (polinômio 0x1021, valor inicial 0xFFFF), usado nos quadros de telemetria.
+ * @param data Dados
+ * @param len Tamanho em bytes
+ * @return CRC dos dados
+ */
+uint16_t crc16_ccitt(const uint8_t* data, uint len);
+
+/**
+ * CRC-32 (IEEE 802.3, o mesmo de zlib.crc32), que pode ser calculado em partes:
+ * crc32_update(crc32_update(0, a, n), b, m) == crc32 de a seguido de b.
+ * @param crc Resultado da parte anterior, ou 0 no início
+ * @param data Dados
+ * @param len Tamanho em bytes
+ * @return CRC acumulado
+ */
+uint32_t crc32_update(uint32_t crc, const uint8_t* data, uint len);
+
+#endif // CRC_H
@@ -0,0 +1,47 @@
+#include "flash_store.h"
+#include "pico/flash.h"
+
+// Tempo máximo esperando o outro núcleo parar antes de desistir da operação.
+#define FLASH_STORE_TIMEOUT_MS 100
+
+/**
+ * Operação executada com o XIP desligado: nada aqui pode ler a flash,
+ * e os dados a gravar precisam estar na RAM.
+ */
+typedef struct {
+    uint32_t offset;
+    const uint8_t* data; // NULL para apagar
+    uint32_t len;
+} flash_store_op_t;
+
+static void __no_inline_not_in_flash_func(flash_store_run)(void* param) {
+    const flash_store_op_t* op = param;
+    if (op->data == NULL)
+        flash_range_erase(op->offset, op->len);
+    else
+        flash_range_program(op->offset, op->data, op->len);
+}
+
+void flash_store_core_init(void) {
+    flash_safe_execute_core_init();
+}
+
+const uint8_t* flash_store_ptr(uint32_t offset) {
+    return (const uint8_t*)(XIP_BASE + offset);
+}
+
+bool flash_store_erase(uint32_t offset, uint32_t len) {
+    if (offset % FLASH_SECTOR_SIZE || len % FLASH_SECTOR_SIZE)
+        return false;
+
+    flash_store_op_t op = {offset, NULL, len};
+    return flash_safe_execute(flash_store_run, &op, FLASH_STORE_TIMEOUT_MS) == PICO_OK;
+}
+
+bool flash_store_program(uint32_t offset, const uint8_t* data, uint32_t len) {
+    if (offset % FLASH_PAGE_SIZE || len % FLASH_PAGE_SIZE)
+        return false;
+
+    flash_store_op_t op = {offset, data, len};
+    return flash_safe_execute(flash_store_run, &op, FLASH_STORE_TIMEOUT_MS) == PICO_OK;
+}
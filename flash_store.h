@@ -0,0 +1,52 @@
+#ifndef FLASH_STORE_H
+#define FLASH_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+
+/**
+ * Regiões reservadas no fim da flash, abaixo delas fica o programa.
+ * Todas começam e terminam em limite de setor (FLASH_SECTOR_SIZE).
+ */
+
+// Gravador de eventos (recorder.h): 14 posições de 9 setores.
+#define FLASH_RECORDER_SIZE (14 * 9 * FLASH_SECTOR_SIZE)
+#define FLASH_RECORDER_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_RECORDER_SIZE)
+
+// Configurações (settings.h): dois setores usados alternadamente.
+#define FLASH_SETTINGS_SIZE (2 * FLASH_SECTOR_SIZE)
+#define FLASH_SETTINGS_OFFSET (FLASH_RECORDER_OFFSET - FLASH_SETTINGS_SIZE)
+
+/**
+ * Prepara o núcleo 0 para ser pausado enquanto o núcleo 1 apaga ou grava a flash.
+ * Deve ser chamada pelo núcleo 0 depois de multicore_launch_core1().
+ */
+void flash_store_core_init(void);
+
+/**
+ * Ponteiro de leitura (XIP) para um endereço da flash.
+ * @param offset Deslocamento a partir do início da flash
+ * @return Ponteiro para os dados mapeados em memória
+ */
+const uint8_t* flash_store_ptr(uint32_t offset);
+
+/**
+ * Apaga setores inteiros. O outro núcleo fica parado durante a operação (~45 ms por setor).
+ * @param offset Deslocamento, múltiplo de FLASH_SECTOR_SIZE
+ * @param len Tamanho, múltiplo de FLASH_SECTOR_SIZE
+ * @return false se os argumentos não estão alinhados ou o outro núcleo não pôde ser pausado
+ */
+bool flash_store_erase(uint32_t offset, uint32_t len);
+
+/**
+ * Grava páginas já apagadas. O outro núcleo fica parado durante a operação (~1 ms por página).
+ * @param offset Deslocamento, múltiplo de FLASH_PAGE_SIZE
+ * @param data Dados na RAM
+ * @param len Tamanho, múltiplo de FLASH_PAGE_SIZE
+ * @return false se os argumentos não estão alinhados ou o outro núcleo não pôde ser pausado
+ */
+bool flash_store_program(uint32_t offset, const uint8_t* data, uint32_t len);
+
+#endif // FLASH_STORE_H
@@ -0,0 +1,56 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+/**
+ * Verificações dos testes no computador. Cada falha é impressa e contada;
+ * o teste termina com return check_report().
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+static int check_failures;
+
+#define CHECK(cond)                                                                  \
+    do {                                                                             \
+        if (!(cond)) {                                                               \
+            fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond);       \
+            ++check_failures;                                                        \
+        }                                                                            \
+    } while (0)
+
+#define CHECK_NEAR(a, b, tol)                                                        \
+    do {                                                                             \
+        double check_a_ = (a), check_b_ = (b);                                       \
+        if (!(fabs(check_a_ - check_b_) <= (tol))) {                                 \
+            fprintf(stderr, "%s:%d: falhou: %s = %g, esperado %g (±%g)\n", __FILE__,  \
+                    __LINE__, #a, check_a_, check_b_, (double)(tol));                \
+            ++check_failures;                                                        \
+        }                                                                            \
+    } while (0)
+
+static inline int check_report(void) {
+    if (check_failures)
+        fprintf(stderr, "%d verificação(ões) falharam\n", check_failures);
+    return check_failures ? 1 : 0;
+}
+
+/**
+ * Relógio do computador (não o tempo virtual do fake HAL), para os benchmarks.
+ */
+static inline uint64_t check_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Linha de benchmark: BENCH_HOST,nome,iterações,ns por iteração.
+ */
+static inline void check_bench(const char* name, uint64_t iterations, uint64_t elapsed_ns) {
+    printf("BENCH_HOST,%s,%llu,%.1f\n", name, (unsigned long long)iterations, (double)elapsed_ns / iterations);
+}
+
+#endif // CHECK_H
@@ -0,0 +1,1276 @@
+#define _GNU_SOURCE
+#include "fake_hal.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "hardware/structs/systick.h"
+
+// Unidade do tempo virtual: 1/256 de ciclo do clock de 48 MHz do ADC, para que o período
+// de conversão ((1 + clkdiv) ciclos, com divisor fracionário) seja exato.
+#define TICK_FRAC_BITS 8
+#define TICKS_PER_US (48ull << TICK_FRAC_BITS)
+#define US_TO_TICKS(us) ((uint64_t)(us) * TICKS_PER_US)
+
+#define GPIO_COUNT 30
+#define ALARM_COUNT 16 // Mesmo tamanho do pool padrão do SDK.
+#define PIO_LOG_WORDS 8192
+#define FIFO_DEPTH 4
+
+void fake_oled_i2c_word(uint16_t word); // fake_oled.c
+
+static uint64_t now_ticks;
+static uint current_core;
+static uint32_t sev_count;
+static bool event_flag;
+
+static void fatal(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "fake_hal: ");
+    vfprintf(stderr, fmt, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+    abort();
+}
+
+// ----- Registro de texto -----
+
+static FILE* trace_file;
+static bool trace_checked;
+
+bool fake_trace_open(const char* path) {
+    if (trace_file)
+        fclose(trace_file);
+    trace_file = path ? fopen(path, "w") : NULL;
+    trace_checked = true;
+    return !path || trace_file;
+}
+
+static void trace(const char* fmt, ...) {
+    if (!trace_checked) {
+        const char* path = getenv("FAKE_HAL_TRACE");
+        trace_checked = true;
+        if (path)
+            trace_file = fopen(path, "w");
+    }
+    if (!trace_file)
+        return;
+
+    va_list args;
+    va_start(args, fmt);
+    fprintf(trace_file, "%llu,", (unsigned long long)(now_ticks / TICKS_PER_US));
+    vfprintf(trace_file, fmt, args);
+    fputc('\n', trace_file);
+    va_end(args);
+}
+
+// ----- Interrupções -----
+
+static bool irq_masked;  // save_and_disable_interrupts()
+static bool in_handler;  // Um tratador está rodando (não há aninhamento)
+static irq_handler_t irq_handlers[IRQ_COUNT];
+static bool irq_enabled[IRQ_COUNT];
+
+static gpio_irq_callback_t gpio_callback;
+static uint32_t gpio_irq_mask[GPIO_COUNT];
+static uint32_t gpio_irq_pending[GPIO_COUNT];
+
+static bool dma_irq_line(void);
+static bool alarms_due(void);
+static void alarms_fire_due(void);
+
+static bool irq_deliverable(void) {
+    return !irq_masked && !in_handler;
+}
+
+// Verdadeiro se alguma interrupção está esperando para ser atendida (acorda __wfi()).
+static bool irq_pending(void) {
+    if (dma_irq_line() && irq_enabled[DMA_IRQ_0] && irq_handlers[DMA_IRQ_0])
+        return true;
+    for (uint i = 0; i < GPIO_COUNT; ++i) {
+        if (gpio_irq_pending[i])
+            return true;
+    }
+    return alarms_due();
+}
+
+// Atende as interrupções pendentes, se estiverem ligadas.
+static void service_irqs(void) {
+    while (irq_deliverable()) {
+        if (dma_irq_line() && irq_enabled[DMA_IRQ_0] && irq_handlers[DMA_IRQ_0]) {
+            in_handler = true;
+            irq_handlers[DMA_IRQ_0]();
+            in_handler = false;
+            continue;
+        }
+
+        bool gpio = false;
+        for (uint i = 0; i < GPIO_COUNT; ++i) {
+            uint32_t events = gpio_irq_pending[i];
+            if (!events)
+                continue;
+            gpio_irq_pending[i] = 0;
+            gpio = true;
+            if (gpio_callback) {
+                in_handler = true;
+                gpio_callback(i, events);
+                in_handler = false;
+            }
+        }
+        if (gpio)
+            continue;
+
+        if (!alarms_due())
+            break;
+        alarms_fire_due();
+    }
+}
+
+uint32_t save_and_disable_interrupts(void) {
+    uint32_t status = irq_masked;
+    irq_masked = true;
+    return status;
+}
+
+void restore_interrupts(uint32_t status) {
+    irq_masked = status;
+    service_irqs();
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    irq_handlers[num] = handler;
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    irq_enabled[num] = enabled;
+    service_irqs();
+}
+
+uint get_core_num(void) {
+    return current_core;
+}
+
+void fake_set_core(uint core) {
+    current_core = core;
+}
+
+// ----- Alarmes e timers repetitivos -----
+
+typedef struct {
+    alarm_id_t id; // 0 = livre
+    uint64_t due;
+    alarm_callback_t callback;
+    void* user_data;
+    repeating_timer_t* timer; // Não nulo para timers repetitivos
+} fake_alarm_t;
+
+static fake_alarm_t alarms[ALARM_COUNT];
+static alarm_id_t next_alarm_id = 1;
+static uint alarm_failures;
+
+static fake_alarm_t* alarm_earliest(void) {
+    fake_alarm_t* earliest = NULL;
+    for (uint i = 0; i < ALARM_COUNT; ++i) {
+        if (alarms[i].id && (!earliest || alarms[i].due < earliest->due))
+            earliest = &alarms[i];
+    }
+    return earliest;
+}
+
+static bool alarms_due(void) {
+    fake_alarm_t* alarm = alarm_earliest();
+    return alarm && alarm->due <= now_ticks;
+}
+
+static alarm_id_t alarm_add(uint64_t due, alarm_callback_t callback, void* user_data, repeating_timer_t* timer) {
+    if (alarm_failures) {
+        --alarm_failures;
+        return PICO_ERROR_GENERIC;
+    }
+    for (uint i = 0; i < ALARM_COUNT; ++i) {
+        if (!alarms[i].id) {
+            alarms[i] = (fake_alarm_t){next_alarm_id++, due, callback, user_data, timer};
+            if (next_alarm_id <= 0)
+                next_alarm_id = 1;
+            return alarms[i].id;
+        }
+    }
+    return PICO_ERROR_GENERIC;
+}
+
+// Volta a agendar um alarme que disparou; o slot original pode ter sido usado no callback.
+static void alarm_reinsert(const fake_alarm_t* alarm) {
+    for (uint i = 0; i < ALARM_COUNT; ++i) {
+        if (!alarms[i].id) {
+            alarms[i] = *alarm;
+            return;
+        }
+    }
+    fatal("pool de alarmes cheio ao reagendar");
+}
+
+static void alarm_fire(fake_alarm_t* alarm) {
+    fake_alarm_t copy = *alarm;
+    alarm->id = 0;
+
+    in_handler = true;
+    if (copy.timer) {
+        bool again = copy.timer->callback(copy.timer);
+        // O timer pode ter sido cancelado dentro do callback.
+        if (again && copy.timer->alarm_id == copy.id) {
+            uint64_t delay = US_TO_TICKS(llabs(copy.timer->delay_us));
+            copy.due = copy.timer->delay_us < 0 ? copy.due + delay : now_ticks + delay;
+            alarm_reinsert(&copy); // Mantém o id, como o SDK.
+        } else if (copy.timer->alarm_id == copy.id) {
+            copy.timer->alarm_id = 0;
+        }
+    } else {
+        int64_t reschedule = copy.callback(copy.id, copy.user_data);
+        if (reschedule) {
+            copy.due = reschedule > 0 ? copy.due + US_TO_TICKS(reschedule) : now_ticks + US_TO_TICKS(-reschedule);
+            alarm_reinsert(&copy);
+        }
+    }
+    in_handler = false;
+}
+
+static void alarms_fire_due(void) {
+    fake_alarm_t* alarm;
+    while (irq_deliverable() && (alarm = alarm_earliest()) && alarm->due <= now_ticks)
+        alarm_fire(alarm);
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void* user_data, bool fire_if_past) {
+    (void)fire_if_past;
+    alarm_id_t id = alarm_add(now_ticks + US_TO_TICKS(us), callback, user_data, NULL);
+    if (id > 0)
+        service_irqs();
+    return id;
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void* user_data, bool fire_if_past) {
+    return add_alarm_in_us((uint64_t)ms * 1000, callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t id) {
+    for (uint i = 0; i < ALARM_COUNT; ++i) {
+        if (id > 0 && alarms[i].id == id) {
+            alarms[i].id = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void* user_data,
+                            repeating_timer_t* out) {
+    out->delay_us = delay_us;
+    out->user_data = user_data;
+    out->callback = callback;
+    out->alarm_id = alarm_add(now_ticks + US_TO_TICKS(llabs(delay_us)), NULL, NULL, out);
+    return out->alarm_id > 0;
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void* user_data,
+                            repeating_timer_t* out) {
+    return add_repeating_timer_us((int64_t)delay_ms * 1000, callback, user_data, out);
+}
+
+bool cancel_repeating_timer(repeating_timer_t* timer) {
+    bool cancelled = cancel_alarm(timer->alarm_id);
+    timer->alarm_id = 0;
+    return cancelled;
+}
+
+void fake_alarm_fail_next(uint count) {
+    alarm_failures = count;
+}
+
+uint fake_alarms_pending(void) {
+    uint count = 0;
+    for (uint i = 0; i < ALARM_COUNT; ++i)
+        count += alarms[i].id != 0;
+    return count;
+}
+
+// ----- ADC -----
+
+adc_hw_t fake_adc_hw;
+
+static struct {
+    bool running;
+    uint selected;
+    uint round_robin;
+    float clkdiv;
+    uint64_t period; // Ticks por conversão
+    uint64_t next;   // Instante da próxima conversão
+    uint64_t conversions;
+    uint16_t fifo[FIFO_DEPTH];
+    uint fifo_count;
+    fake_adc_source_t source[5];
+    void* user[5];
+} adc = {.period = 1ull << TICK_FRAC_BITS};
+
+static float adc_default(uint input, double t_s, void* user) {
+    (void)t_s;
+    (void)user;
+    return input == 4 ? 876.f : 2048.f; // Sensor de temperatura: 0,706 V (~27 °C)
+}
+
+static uint16_t adc_sample(uint input) {
+    fake_adc_source_t source = adc.source[input] ? adc.source[input] : adc_default;
+    float value = source(input, (double)now_ticks / (TICKS_PER_US * 1e6), adc.user[input]);
+    if (!(value >= 0.f)) // Também pega NaN
+        value = 0.f;
+    if (value > 4095.f)
+        value = 4095.f;
+    return (uint16_t)lrintf(value);
+}
+
+void fake_adc_set_source(uint input, fake_adc_source_t source, void* user) {
+    adc.source[input] = source;
+    adc.user[input] = user;
+}
+
+typedef struct {
+    double frequency, amplitude, dc;
+} sine_t;
+
+static sine_t sines[5];
+
+static float sine_source(uint input, double t_s, void* user) {
+    const sine_t* s = user;
+    (void)input;
+    return (float)(s->dc + s->amplitude * sin(2.0 * 3.14159265358979323846 * s->frequency * t_s));
+}
+
+void fake_adc_sine(uint input, double frequency_hz, double amplitude, double dc) {
+    sines[input] = (sine_t){frequency_hz, amplitude, dc};
+    fake_adc_set_source(input, sine_source, &sines[input]);
+}
+
+uint64_t fake_adc_conversions(void) {
+    return adc.conversions;
+}
+
+double fake_adc_rate(void) {
+    return 48e6 / (1.0 + adc.clkdiv);
+}
+
+void adc_init(void) {
+    adc.running = false;
+    adc.selected = 0;
+    adc.round_robin = 0;
+    adc.fifo_count = 0;
+}
+
+void adc_gpio_init(uint gpio) {
+    if (gpio < 26 || gpio > 29)
+        fatal("adc_gpio_init(%u): pino sem ADC", gpio);
+    trace("ADC,gpio,%u", gpio);
+}
+
+void adc_select_input(uint input) {
+    if (input > 4)
+        fatal("adc_select_input(%u)", input);
+    adc.selected = input;
+}
+
+uint adc_get_selected_input(void) {
+    return adc.selected;
+}
+
+void adc_set_round_robin(uint input_mask) {
+    adc.round_robin = input_mask & 0x1f;
+}
+
+void adc_set_temp_sensor_enabled(bool enable) {
+    trace("ADC,temp,%d", enable);
+}
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift) {
+    if (!en || !dreq_en || dreq_thresh != 1 || err_in_fifo || byte_shift)
+        fatal("adc_fifo_setup: só o modo com DREQ a cada amostra de 12 bits é simulado");
+}
+
+void adc_run(bool run) {
+    if (run && !adc.running)
+        adc.next = now_ticks + adc.period;
+    adc.running = run;
+    trace("ADC,run,%d", run);
+}
+
+void adc_fifo_drain(void) {
+    adc.fifo_count = 0;
+}
+
+void adc_set_clkdiv(float clkdiv) {
+    adc.clkdiv = clkdiv;
+    adc.period = (uint64_t)llround((1.0 + clkdiv) * (1 << TICK_FRAC_BITS));
+    trace("ADC,clkdiv,%.3f", clkdiv);
+}
+
+uint16_t adc_read(void) {
+    ++adc.conversions;
+    return adc_sample(adc.selected);
+}
+
+// ----- DMA -----
+
+typedef struct {
+    bool claimed;
+    dma_channel_config config;
+    volatile void* write;      // Registradores (o valor de partida do próximo disparo)
+    const volatile void* read;
+    uint32_t count;
+    uint32_t remaining;
+    bool busy;
+    bool irq0_enabled;
+    bool irq0_status;
+} fake_dma_t;
+
+static fake_dma_t dma[NUM_DMA_CHANNELS];
+static dma_hw_t dma_regs;
+static uint32_t dma_merged;
+
+pio_hw_t fake_pio0_hw;
+pio_hw_t fake_pio1_hw;
+
+static i2c_hw_t i2c_regs[2] = {{.status = I2C_IC_STATUS_TFE_BITS}, {.status = I2C_IC_STATUS_TFE_BITS}};
+i2c_inst_t fake_i2c0_inst = {&i2c_regs[0], 0, 0};
+i2c_inst_t fake_i2c1_inst = {&i2c_regs[1], 1, 0};
+
+static void i2c_word(i2c_inst_t* i2c, uint16_t word);
+static void pio_word(PIO pio, uint sm, uint32_t word);
+
+static bool dma_irq_line(void) {
+    for (uint i = 0; i < NUM_DMA_CHANNELS; ++i) {
+        if (dma[i].irq0_enabled && dma[i].irq0_status)
+            return true;
+    }
+    return false;
+}
+
+static fake_dma_t* dma_channel(uint channel) {
+    if (channel >= NUM_DMA_CHANNELS)
+        fatal("canal de DMA %u inválido", channel);
+    return &dma[channel];
+}
+
+static uint dma_size(const fake_dma_t* ch) {
+    return 1u << ch->config.size;
+}
+
+static uint32_t dma_read_word(fake_dma_t* ch) {
+    const volatile uint8_t* p = ch->read;
+    uint32_t value = ch->config.size == DMA_SIZE_8 ? *p
+                   : ch->config.size == DMA_SIZE_16 ? *(const volatile uint16_t*)p
+                   : *(const volatile uint32_t*)p;
+    if (ch->config.read_increment)
+        ch->read = p + dma_size(ch);
+    return value;
+}
+
+static void dma_write_word(fake_dma_t* ch, uint32_t value) {
+    volatile uint8_t* p = ch->write;
+    if (ch->config.size == DMA_SIZE_8)
+        *p = (uint8_t)value;
+    else if (ch->config.size == DMA_SIZE_16)
+        *(volatile uint16_t*)p = (uint16_t)value;
+    else
+        *(volatile uint32_t*)p = value;
+
+    if (!ch->config.write_increment)
+        return;
+    uintptr_t next = (uintptr_t)p + dma_size(ch);
+    if (ch->config.ring_write && ch->config.ring_bits) {
+        uintptr_t mask = ((uintptr_t)1 << ch->config.ring_bits) - 1;
+        next = ((uintptr_t)p & ~mask) | (next & mask);
+    }
+    ch->write = (volatile void*)next;
+}
+
+static void dma_start(uint channel);
+
+static void dma_complete(uint channel) {
+    fake_dma_t* ch = &dma[channel];
+    ch->busy = false;
+    if (ch->irq0_enabled && dma_irq_line())
+        ++dma_merged;
+    ch->irq0_status = true;
+    if (ch->config.chain_to != channel)
+        dma_start(ch->config.chain_to);
+}
+
+// Transferências para periféricos que o fake HAL consome na hora: FIFO do I2C e da PIO, ou memória.
+static void dma_run_immediate(uint channel) {
+    fake_dma_t* ch = &dma[channel];
+    volatile void* target = ch->write;
+
+    for (uint i = 0; i < 2; ++i) {
+        i2c_inst_t* i2c = i ? &fake_i2c1_inst : &fake_i2c0_inst;
+        if (target == (volatile void*)&i2c->hw->data_cmd) {
+            while (ch->remaining) {
+                i2c_word(i2c, (uint16_t)dma_read_word(ch));
+                --ch->remaining;
+            }
+            dma_complete(channel);
+            return;
+        }
+    }
+
+    for (uint i = 0; i < 2; ++i) {
+        PIO pio = i ? pio1 : pio0;
+        for (uint sm = 0; sm < 4; ++sm) {
+            if (target == (volatile void*)&pio->txf[sm]) {
+                while (ch->remaining) {
+                    pio_word(pio, sm, dma_read_word(ch));
+                    --ch->remaining;
+                }
+                dma_complete(channel);
+                return;
+            }
+        }
+    }
+
+    while (ch->remaining) {
+        dma_write_word(ch, dma_read_word(ch));
+        --ch->remaining;
+    }
+    dma_complete(channel);
+}
+
+static void dma_start(uint channel) {
+    fake_dma_t* ch = dma_channel(channel);
+    if (!ch->config.enable)
+        return;
+    ch->busy = true;
+    ch->remaining = ch->count;
+    if (ch->read == (const volatile void*)&adc_hw->fifo) {
+        // Pacing pelo ADC: as amostras chegam em adc_convert().
+        if (ch->config.dreq != DREQ_ADC)
+            fatal("DMA %u lê o FIFO do ADC sem DREQ_ADC", channel);
+        return;
+    }
+    dma_run_immediate(channel);
+    service_irqs();
+}
+
+dma_hw_t* fake_dma_hw(void) {
+    // Um abort pedido na escrita anterior termina antes do próximo acesso.
+    for (uint i = 0; i < NUM_DMA_CHANNELS; ++i) {
+        if (dma_regs.abort & (1u << i))
+            dma[i].busy = false;
+    }
+    dma_regs.abort = 0;
+    return &dma_regs;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    return (dma_channel_config){
+        .size = DMA_SIZE_32,
+        .read_increment = true,
+        .write_increment = false,
+        .dreq = DREQ_FORCE,
+        .chain_to = channel,
+        .enable = true,
+    };
+}
+
+int dma_claim_unused_channel(bool required) {
+    for (uint i = 0; i < NUM_DMA_CHANNELS; ++i) {
+        if (!dma[i].claimed) {
+            dma[i].claimed = true;
+            return (int)i;
+        }
+    }
+    if (required)
+        fatal("sem canais de DMA livres");
+    return -1;
+}
+
+void dma_channel_claim(uint channel) {
+    if (dma_channel(channel)->claimed)
+        fatal("canal de DMA %u já em uso", channel);
+    dma[channel].claimed = true;
+}
+
+void dma_channel_unclaim(uint channel) {
+    dma_channel(channel)->claimed = false;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr,
+                           const volatile void* read_addr, uint transfer_count, bool trigger) {
+    fake_dma_t* ch = dma_channel(channel);
+    ch->config = *config;
+    ch->write = write_addr;
+    ch->read = read_addr;
+    ch->count = transfer_count;
+    if (trigger)
+        dma_start(channel);
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void* read_addr, bool trigger) {
+    dma_channel(channel)->read = read_addr;
+    if (trigger)
+        dma_start(channel);
+}
+
+void dma_channel_set_write_addr(uint channel, volatile void* write_addr, bool trigger) {
+    dma_channel(channel)->write = write_addr;
+    if (trigger)
+        dma_start(channel);
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger) {
+    dma_channel(channel)->count = trans_count;
+    if (trigger)
+        dma_start(channel);
+}
+
+void dma_channel_start(uint channel) {
+    dma_start(channel);
+}
+
+void dma_channel_abort(uint channel) {
+    dma_channel(channel)->busy = false;
+}
+
+bool dma_channel_is_busy(uint channel) {
+    return dma_channel(channel)->busy;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+    while (dma_channel(channel)->busy) {
+        if (!adc.running)
+            fatal("espera pelo DMA %u sem ADC ligado", channel);
+        fake_advance_us(1);
+    }
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+    dma_channel(channel)->irq0_enabled = enabled;
+}
+
+bool dma_channel_get_irq0_status(uint channel) {
+    return dma_channel(channel)->irq0_status;
+}
+
+void dma_channel_acknowledge_irq0(uint channel) {
+    dma_channel(channel)->irq0_status = false;
+}
+
+uint32_t fake_dma_irq_merged(void) {
+    return dma_merged;
+}
+
+// Uma conversão: a amostra vai para o canal de DMA que espera o ADC ou, sem canal, para o FIFO.
+static void adc_convert(void) {
+    uint16_t sample = adc_sample(adc.selected);
+    ++adc.conversions;
+
+    if (adc.round_robin) {
+        uint input = adc.selected;
+        do {
+            input = (input + 1) % 5;
+        } while (!(adc.round_robin & (1u << input)));
+        adc.selected = input;
+    }
+
+    for (uint i = 0; i < NUM_DMA_CHANNELS; ++i) {
+        fake_dma_t* ch = &dma[i];
+        if (ch->busy && ch->read == (const volatile void*)&adc_hw->fifo) {
+            dma_write_word(ch, sample);
+            if (--ch->remaining == 0)
+                dma_complete(i);
+            return;
+        }
+    }
+    if (adc.fifo_count < FIFO_DEPTH)
+        adc.fifo[adc.fifo_count++] = sample;
+}
+
+// ----- Avanço do tempo -----
+
+// Executa os eventos até target ou, com until_irq, até alguma interrupção ficar pendente.
+static void run_events(uint64_t target, bool until_irq) {
+    for (;;) {
+        if (until_irq && irq_pending())
+            return;
+
+        uint64_t next = UINT64_MAX;
+        fake_alarm_t* alarm = alarm_earliest();
+        bool is_alarm = false;
+        if (adc.running)
+            next = adc.next;
+        // Com as interrupções desligadas, um alarme vencido só fica pendente.
+        if (alarm && alarm->due < next && (alarm->due > now_ticks || irq_deliverable())) {
+            next = alarm->due;
+            is_alarm = true;
+        }
+
+        if (next == UINT64_MAX) {
+            if (until_irq)
+                fatal("__wfi()/__wfe() sem nenhum evento que possa acordar o núcleo");
+            break;
+        }
+        if (!until_irq && next > target)
+            break;
+
+        if (next > now_ticks)
+            now_ticks = next;
+        if (is_alarm) {
+            if (!irq_deliverable())
+                continue; // Vencido e pendente: volta ao teste do início.
+            alarm_fire(alarm);
+        } else {
+            adc_convert();
+            adc.next += adc.period;
+        }
+        service_irqs();
+    }
+    if (!until_irq && target > now_ticks)
+        now_ticks = target;
+    service_irqs();
+}
+
+void fake_advance_us(uint64_t us) {
+    run_events(now_ticks + US_TO_TICKS(us), false);
+}
+
+void tight_loop_contents(void) {
+    fake_advance_us(1);
+}
+
+void __wfi(void) {
+    run_events(0, true);
+}
+
+void __wfe(void) {
+    if (event_flag) {
+        event_flag = false;
+        return;
+    }
+    run_events(0, true);
+}
+
+void __sev(void) {
+    ++sev_count;
+    event_flag = true;
+}
+
+uint32_t fake_sev_count(void) {
+    return sev_count;
+}
+
+absolute_time_t get_absolute_time(void) {
+    return now_ticks / TICKS_PER_US;
+}
+
+uint32_t to_ms_since_boot(absolute_time_t t) {
+    return (uint32_t)(t / 1000);
+}
+
+uint64_t to_us_since_boot(absolute_time_t t) {
+    return t;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t)(now_ticks / TICKS_PER_US);
+}
+
+uint64_t time_us_64(void) {
+    return now_ticks / TICKS_PER_US;
+}
+
+void sleep_us(uint64_t us) {
+    fake_advance_us(us);
+}
+
+void sleep_ms(uint32_t ms) {
+    fake_advance_us((uint64_t)ms * 1000);
+}
+
+void busy_wait_us(uint64_t us) {
+    fake_advance_us(us);
+}
+
+// ----- I2C -----
+
+static uint32_t* i2c_log;
+static size_t i2c_log_count, i2c_log_capacity;
+static uint32_t i2c_transactions;
+static uint32_t i2c_baud_sys_hz[2]; // clk_sys quando o baud foi calculado
+
+static void i2c_word(i2c_inst_t* i2c, uint16_t word) {
+    if (!(i2c->hw->enable & 1))
+        fatal("escrita no I2C%u desabilitado", i2c->index);
+    if (i2c_log_count == i2c_log_capacity) {
+        i2c_log_capacity = i2c_log_capacity ? 2 * i2c_log_capacity : 4096;
+        i2c_log = realloc(i2c_log, i2c_log_capacity * sizeof(*i2c_log));
+    }
+    uint32_t addr = i2c->hw->tar & 0x7f;
+    i2c_log[i2c_log_count++] = (addr << 16) | (word & 0x7ff);
+    if (word & I2C_IC_DATA_CMD_STOP_BITS)
+        ++i2c_transactions;
+    if (addr == FAKE_OLED_ADDR)
+        fake_oled_i2c_word(word);
+    trace("I2C%u,0x%02x,0x%03x", i2c->index, addr, word & 0x7ff);
+}
+
+uint i2c_init(i2c_inst_t* i2c, uint baudrate) {
+    i2c->hw->enable = 1;
+    return i2c_set_baudrate(i2c, baudrate);
+}
+
+uint i2c_set_baudrate(i2c_inst_t* i2c, uint baudrate) {
+    i2c->baudrate = baudrate;
+    i2c_baud_sys_hz[i2c->index] = clock_get_hz(clk_sys);
+    trace("I2C%u,baud,%u", i2c->index, baudrate);
+    return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop) {
+    uint32_t tar = i2c->hw->tar;
+    i2c->hw->tar = addr;
+    for (size_t i = 0; i < len; ++i) {
+        uint16_t word = src[i];
+        if (i == len - 1 && !nostop)
+            word |= I2C_IC_DATA_CMD_STOP_BITS;
+        i2c_word(i2c, word);
+    }
+    i2c->hw->tar = tar;
+    // Tempo de barramento: 9 bits por byte.
+    if (i2c->baudrate)
+        fake_advance_us((len + 1) * 9 * 1000000ull / fake_i2c_scl_hz(i2c));
+    return (int)len;
+}
+
+const uint32_t* fake_i2c_words(size_t* count) {
+    *count = i2c_log_count;
+    return i2c_log;
+}
+
+uint32_t fake_i2c_transactions(void) {
+    return i2c_transactions;
+}
+
+void fake_i2c_clear(void) {
+    i2c_log_count = 0;
+    i2c_transactions = 0;
+}
+
+uint32_t fake_i2c_scl_hz(i2c_inst_t* i2c) {
+    if (!i2c_baud_sys_hz[i2c->index])
+        return 0;
+    return (uint32_t)((uint64_t)i2c->baudrate * clock_get_hz(clk_sys) / i2c_baud_sys_hz[i2c->index]);
+}
+
+// ----- PIO -----
+
+static struct {
+    uint32_t words[PIO_LOG_WORDS];
+    size_t count;
+    float clkdiv;
+    bool claimed;
+} pio_sm[2][4];
+
+static uint pio_index(PIO pio) {
+    return pio == pio1;
+}
+
+static void pio_word(PIO pio, uint sm, uint32_t word) {
+    uint i = pio_index(pio);
+    if (pio_sm[i][sm].count < PIO_LOG_WORDS)
+        pio_sm[i][sm].words[pio_sm[i][sm].count++] = word;
+    trace("PIO%u,%u,0x%08x", i, sm, word);
+}
+
+uint pio_add_program(PIO pio, const pio_program_t* program) {
+    (void)pio;
+    (void)program;
+    return 0;
+}
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+    uint i = pio_index(pio);
+    for (uint sm = 0; sm < 4; ++sm) {
+        if (!pio_sm[i][sm].claimed) {
+            pio_sm[i][sm].claimed = true;
+            return (int)sm;
+        }
+    }
+    if (required)
+        fatal("sem máquinas de estado livres na PIO%u", i);
+    return -1;
+}
+
+void pio_gpio_init(PIO pio, uint pin) {
+    gpio_set_function(pin, pio == pio1 ? GPIO_FUNC_PIO1 : GPIO_FUNC_PIO0);
+}
+
+int pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out) {
+    (void)pio;
+    (void)sm;
+    for (uint i = 0; i < pin_count; ++i)
+        gpio_set_dir(pin_base + i, is_out);
+    return PICO_OK;
+}
+
+int pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config* config) {
+    (void)initial_pc;
+    pio_sm_set_clkdiv(pio, sm, config->clkdiv);
+    return PICO_OK;
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) {
+    trace("PIO%u,%u,enabled,%d", pio_index(pio), sm, enabled);
+}
+
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div) {
+    pio_sm[pio_index(pio)][sm].clkdiv = div;
+    trace("PIO%u,%u,clkdiv,%.4f", pio_index(pio), sm, div);
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+    pio_word(pio, sm, data);
+}
+
+const uint32_t* fake_pio_words(PIO pio, uint sm, size_t* count) {
+    *count = pio_sm[pio_index(pio)][sm].count;
+    return pio_sm[pio_index(pio)][sm].words;
+}
+
+void fake_pio_clear(void) {
+    for (uint i = 0; i < 2; ++i) {
+        for (uint sm = 0; sm < 4; ++sm)
+            pio_sm[i][sm].count = 0;
+    }
+}
+
+float fake_pio_clkdiv(PIO pio, uint sm) {
+    return pio_sm[pio_index(pio)][sm].clkdiv;
+}
+
+// ----- GPIO -----
+
+static struct {
+    bool out;
+    bool output_level;
+    bool input_level;
+    bool driven; // Nível de entrada imposto por fake_gpio_drive()
+    bool pull_up;
+    enum gpio_function function;
+} gpio[GPIO_COUNT];
+
+static void gpio_check(uint pin) {
+    if (pin >= GPIO_COUNT)
+        fatal("GPIO %u inválido", pin);
+}
+
+void gpio_init(uint pin) {
+    gpio_check(pin);
+    gpio[pin].out = false;
+    gpio[pin].output_level = false;
+    gpio[pin].function = GPIO_FUNC_SIO;
+}
+
+void gpio_set_dir(uint pin, bool out) {
+    gpio_check(pin);
+    gpio[pin].out = out;
+}
+
+void gpio_put(uint pin, bool value) {
+    gpio_check(pin);
+    if (gpio[pin].output_level != value)
+        trace("GPIO,%u,%d", pin, value);
+    gpio[pin].output_level = value;
+}
+
+bool gpio_get(uint pin) {
+    gpio_check(pin);
+    if (gpio[pin].out)
+        return gpio[pin].output_level;
+    return gpio[pin].driven ? gpio[pin].input_level : gpio[pin].pull_up;
+}
+
+void gpio_pull_up(uint pin) {
+    gpio_check(pin);
+    gpio[pin].pull_up = true;
+}
+
+void gpio_pull_down(uint pin) {
+    gpio_check(pin);
+    gpio[pin].pull_up = false;
+}
+
+void gpio_set_function(uint pin, enum gpio_function fn) {
+    gpio_check(pin);
+    gpio[pin].function = fn;
+}
+
+void gpio_set_irq_enabled(uint pin, uint32_t event_mask, bool enabled) {
+    gpio_check(pin);
+    if (enabled)
+        gpio_irq_mask[pin] |= event_mask;
+    else
+        gpio_irq_mask[pin] &= ~event_mask;
+}
+
+void gpio_set_irq_enabled_with_callback(uint pin, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback) {
+    gpio_set_irq_enabled(pin, event_mask, enabled);
+    gpio_callback = callback;
+}
+
+void fake_gpio_drive(uint pin, bool level) {
+    gpio_check(pin);
+    bool before = gpio_get(pin);
+    gpio[pin].driven = true;
+    gpio[pin].input_level = level;
+    if (gpio[pin].out || before == level)
+        return;
+
+    trace("GPIO,%u,%d", pin, level);
+    uint32_t edge = level ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+    if (gpio_irq_mask[pin] & edge) {
+        gpio_irq_pending[pin] |= edge;
+        service_irqs();
+    }
+}
+
+bool fake_gpio_level(uint pin) {
+    return gpio_get(pin);
+}
+
+// ----- Clocks -----
+
+static uint32_t clock_hz[CLK_COUNT] = {
+    [clk_ref] = 12 * MHZ,
+    [clk_sys] = 125 * MHZ,
+    [clk_peri] = 125 * MHZ,
+    [clk_usb] = 48 * MHZ,
+    [clk_adc] = 48 * MHZ,
+    [clk_rtc] = 46875,
+};
+static uint32_t clock_changes;
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+    return clock_hz[clk_index];
+}
+
+bool clock_configure(enum clock_index clk_index, uint32_t src, uint32_t auxsrc, uint32_t src_freq, uint32_t freq) {
+    (void)src;
+    (void)auxsrc;
+    if (freq > src_freq)
+        return false;
+    clock_hz[clk_index] = freq;
+    ++clock_changes;
+    trace("CLOCK,%u,%u", clk_index, freq);
+    return true;
+}
+
+uint32_t fake_clock_changes(void) {
+    return clock_changes;
+}
+
+// ----- SysTick -----
+
+static systick_hw_t systick;
+
+systick_hw_t* fake_systick(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t ns = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+    uint64_t cycles = (uint64_t)((double)ns * clock_get_hz(clk_sys) / 1e9);
+    systick.cvr = 0xffffffu - (uint32_t)(cycles & 0xffffffu);
+    return &systick;
+}
+
+// ----- Flash -----
+
+static uint8_t* flash_memory;
+static uint32_t flash_ops;
+static int flash_cut_at = -1;
+static uint flash_failures;
+static uint64_t flash_busy_us;
+
+uint8_t* fake_flash_memory(void) {
+    if (!flash_memory) {
+        // Compartilhada com os processos filhos, para os testes de queda de energia.
+        flash_memory = mmap(NULL, PICO_FLASH_SIZE_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (flash_memory == MAP_FAILED)
+            fatal("mmap da flash falhou");
+        memset(flash_memory, 0xff, PICO_FLASH_SIZE_BYTES);
+    }
+    return flash_memory;
+}
+
+// Conta a operação e, se for a escolhida, deixa só parte dela feita e "desliga a placa".
+static bool flash_power_cut(void) {
+    ++flash_ops;
+    if (flash_cut_at < 0 || flash_cut_at-- > 0)
+        return false;
+    return true;
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    if (flash_offs % FLASH_SECTOR_SIZE || count % FLASH_SECTOR_SIZE || flash_offs + count > PICO_FLASH_SIZE_BYTES)
+        fatal("flash_range_erase(0x%x, %zu) fora do alinhamento", flash_offs, count);
+    if (!irq_masked)
+        fatal("flash_range_erase() com interrupções ligadas; use flash_safe_execute()");
+    trace("FLASH,erase,0x%x,%zu", flash_offs, count);
+
+    uint8_t* memory = fake_flash_memory() + flash_offs;
+    if (flash_power_cut()) {
+        memset(memory, 0xff, count / 2);
+        _exit(FAKE_POWER_CUT_EXIT);
+    }
+    memset(memory, 0xff, count);
+    flash_busy_us += count / FLASH_SECTOR_SIZE * FAKE_FLASH_ERASE_US;
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t* data, size_t count) {
+    if (flash_offs % FLASH_PAGE_SIZE || count % FLASH_PAGE_SIZE || flash_offs + count > PICO_FLASH_SIZE_BYTES)
+        fatal("flash_range_program(0x%x, %zu) fora do alinhamento", flash_offs, count);
+    if (!irq_masked)
+        fatal("flash_range_program() com interrupções ligadas; use flash_safe_execute()");
+    trace("FLASH,program,0x%x,%zu", flash_offs, count);
+
+    // Gravar só leva bits de 1 para 0.
+    uint8_t* memory = fake_flash_memory() + flash_offs;
+    size_t done = flash_power_cut() ? count / 3 : count;
+    for (size_t i = 0; i < done; ++i)
+        memory[i] &= data[i];
+    if (done != count)
+        _exit(FAKE_POWER_CUT_EXIT);
+    flash_busy_us += count / FLASH_PAGE_SIZE * FAKE_FLASH_PAGE_US;
+}
+
+int flash_safe_execute(void (*func)(void*), void* param, uint32_t enter_exit_timeout_ms) {
+    (void)enter_exit_timeout_ms;
+    if (flash_failures) {
+        --flash_failures;
+        return PICO_ERROR_TIMEOUT;
+    }
+
+    // O núcleo 0 fica parado com as interrupções desligadas; o ADC e o DMA continuam.
+    uint32_t status = save_and_disable_interrupts();
+    flash_busy_us = 0;
+    func(param);
+    fake_advance_us(flash_busy_us);
+    restore_interrupts(status);
+    return PICO_OK;
+}
+
+bool flash_safe_execute_core_init(void) {
+    return true;
+}
+
+void fake_flash_erase_all(void) {
+    memset(fake_flash_memory(), 0xff, PICO_FLASH_SIZE_BYTES);
+}
+
+void fake_flash_fail_next(uint count) {
+    flash_failures = count;
+}
+
+void fake_flash_power_cut_after(int ops) {
+    flash_cut_at = ops;
+}
+
+uint32_t fake_flash_ops(void) {
+    return flash_ops;
+}
+
+bool fake_flash_load(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return false;
+    size_t read = fread(fake_flash_memory(), 1, PICO_FLASH_SIZE_BYTES, f);
+    fclose(f);
+    return read == PICO_FLASH_SIZE_BYTES;
+}
+
+bool fake_flash_save(const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f)
+        return false;
+    size_t written = fwrite(fake_flash_memory(), 1, PICO_FLASH_SIZE_BYTES, f);
+    return fclose(f) == 0 && written == PICO_FLASH_SIZE_BYTES;
+}
+
+// ----- stdio -----
+
+static char* stdin_text;
+static size_t stdin_pos, stdin_len;
+static uint8_t* stdout_bytes;
+static size_t stdout_len, stdout_capacity;
+
+bool stdio_init_all(void) {
+    return true;
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    (void)timeout_us;
+    if (stdin_pos == stdin_len)
+        return PICO_ERROR_TIMEOUT;
+    return (unsigned char)stdin_text[stdin_pos++];
+}
+
+void fake_stdin_push(const char* text) {
+    size_t len = strlen(text);
+    stdin_text = realloc(stdin_text, stdin_len + len);
+    memcpy(stdin_text + stdin_len, text, len);
+    stdin_len += len;
+}
+
+void stdio_put_string(const char* s, int len, bool newline, bool cr_translation) {
+    (void)cr_translation;
+    size_t need = stdout_len + (size_t)len + newline;
+    if (need > stdout_capacity) {
+        stdout_capacity = need * 2;
+        stdout_bytes = realloc(stdout_bytes, stdout_capacity);
+    }
+    memcpy(stdout_bytes + stdout_len, s, (size_t)len);
+    stdout_len += (size_t)len;
+    if (newline)
+        stdout_bytes[stdout_len++] = '\n';
+}
+
+const uint8_t* fake_stdout(size_t* len) {
+    *len = stdout_len;
+    return stdout_bytes;
+}
+
+void fake_stdout_clear(void) {
+    stdout_len = 0;
+}
+
+// ----- Diversos -----
+
+static void (*core1_entry)(void);
+static uint32_t bootsel_requests;
+
+void multicore_launch_core1(void (*entry)(void)) {
+    core1_entry = entry;
+}
+
+void (*fake_core1_entry(void))(void) {
+    return core1_entry;
+}
+
+void reset_usb_boot(uint32_t usb_activity_gpio_pin_mask, uint32_t disable_interface_mask) {
+    (void)usb_activity_gpio_pin_mask;
+    (void)disable_interface_mask;
+    ++bootsel_requests;
+}
+
+uint32_t fake_bootsel_requests(void) {
+    return bootsel_requests;
+}
@@ -0,0 +1,321 @@
+#ifndef FAKE_HAL_H
+#define FAKE_HAL_H
+
+/**
+ * Fake HAL para compilar e testar o firmware no computador (host/CMakeLists.txt).
+ *
+ * Os cabeçalhos do SDK em host/include declaram as mesmas funções que o firmware usa;
+ * aqui ficam os controles e registros que os testes e a ferramenta de replay usam:
+ * tempo virtual, fontes do ADC (funções, WAV ou PCM), registro do tráfego no I2C e na
+ * PIO, modelo do SSD1306 com saída em PBM, GPIO com bordas e uma flash na RAM com
+ * queda de energia simulada.
+ *
+ * O tempo só anda quando alguém espera: fake_advance_us(), sleep_*(), tight_loop_contents(),
+ * __wfi(), __wfe() ou uma operação na flash. Nesse avanço o ADC converte (no ritmo do
+ * divisor configurado), o DMA grava os blocos e chama a interrupção, e alarmes e timers
+ * repetitivos disparam, tudo em ordem cronológica. Enquanto as interrupções estão
+ * desligadas (save_and_disable_interrupts() ou flash_safe_execute()), o hardware continua
+ * e os tratadores ficam pendentes, como na placa.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "pico/stdlib.h"
+#include "pico/sync.h"
+#include "pico/multicore.h"
+#include "pico/bootrom.h"
+#include "pico/flash.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/flash.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/sync.h"
+
+// ----- Tempo -----
+
+/**
+ * Avança o tempo virtual, executando os eventos do período.
+ * @param us Microssegundos
+ */
+void fake_advance_us(uint64_t us);
+
+/**
+ * Escolhe o núcleo devolvido por get_core_num().
+ * @param core 0 ou 1
+ */
+void fake_set_core(uint core);
+
+/**
+ * Contador de chamadas a __sev().
+ */
+uint32_t fake_sev_count(void);
+
+// ----- ADC -----
+
+/**
+ * Fonte de uma entrada do ADC.
+ * @param input Entrada (0 a 4)
+ * @param t_s Instante da conversão (s)
+ * @param user Ponteiro passado em fake_adc_set_source()
+ * @return Leitura (contagens; limitada a 0-4095)
+ */
+typedef float (*fake_adc_source_t)(uint input, double t_s, void* user);
+
+/**
+ * Troca a fonte de uma entrada. Sem fonte, as entradas 0 a 3 leem o ponto médio (2048)
+ * e o sensor de temperatura lê ~27 °C.
+ */
+void fake_adc_set_source(uint input, fake_adc_source_t source, void* user);
+
+/**
+ * Tom senoidal: dc + amplitude · sen(2π·f·t).
+ * @param input Entrada
+ * @param frequency_hz Frequência
+ * @param amplitude Amplitude de pico (contagens)
+ * @param dc Nível médio (contagens)
+ */
+void fake_adc_sine(uint input, double frequency_hz, double amplitude, double dc);
+
+/**
+ * Reproduz um arquivo como sinal de uma entrada, com interpolação linear entre as amostras.
+ * Arquivos RIFF/WAVE (PCM de 8, 16, 24 ou 32 bits, ou float de 32 bits; só o primeiro
+ * canal) usam a taxa do cabeçalho; qualquer outro arquivo é lido como PCM cru de 16 bits
+ * little-endian na taxa pcm_rate.
+ * @param input Entrada
+ * @param path Arquivo
+ * @param pcm_rate Taxa do PCM cru (Hz); ignorada para WAV
+ * @param full_scale Contagens do ADC correspondentes ao fundo de escala do arquivo
+ * @param dc Nível médio (contagens)
+ * @param loop true para repetir o arquivo; senão, depois do fim a entrada fica em dc
+ * @return Duração do arquivo (s), ou negativo se não pôde ser lido
+ */
+double fake_adc_play_file(uint input, const char* path, double pcm_rate, double full_scale, double dc, bool loop);
+
+/**
+ * Conversões feitas pelo ADC desde o início.
+ */
+uint64_t fake_adc_conversions(void);
+
+/**
+ * Taxa atual do ADC (conversões por segundo, somando as entradas do rodízio).
+ */
+double fake_adc_rate(void);
+
+// ----- DMA -----
+
+/**
+ * Blocos concluídos pelo DMA com a interrupção ainda pendente de um bloco anterior,
+ * ou seja, interrupções que a placa teria juntado numa só.
+ */
+uint32_t fake_dma_irq_merged(void);
+
+// ----- I2C -----
+
+/**
+ * Palavras escritas em DATA_CMD (pelo DMA ou por i2c_write_blocking()), na ordem.
+ * Bits 0-10: a palavra (byte e bits de controle, como I2C_IC_DATA_CMD_STOP_BITS);
+ * bits 16-22: endereço do alvo.
+ * @param count Recebe a quantidade
+ * @return Registro do barramento
+ */
+const uint32_t* fake_i2c_words(size_t* count);
+
+/**
+ * Transações (palavras com STOP) desde o último fake_i2c_clear().
+ */
+uint32_t fake_i2c_transactions(void);
+
+/**
+ * Apaga o registro do barramento I2C.
+ */
+void fake_i2c_clear(void);
+
+/**
+ * Frequência real do SCL: a pedida em i2c_init()/i2c_set_baudrate(), corrigida se o
+ * clk_sys mudou depois (o I2C conta ciclos do clk_sys).
+ * @param i2c Instância
+ * @return Hz
+ */
+uint32_t fake_i2c_scl_hz(i2c_inst_t* i2c);
+
+// ----- Display SSD1306 (alvo 0x3C) -----
+
+#define FAKE_OLED_ADDR 0x3C
+#define FAKE_OLED_WIDTH 128
+#define FAKE_OLED_PAGES 8
+
+/**
+ * Estado do display montado a partir do tráfego no I2C: comandos de janela e
+ * endereçamento horizontal, como no controlador.
+ */
+typedef struct {
+    uint8_t ram[FAKE_OLED_PAGES][FAKE_OLED_WIDTH]; // GDDRAM, uma página de 8 linhas por vez
+    bool on;                // SET_DISP | 1
+    uint8_t contrast;       // SET_CONTRAST
+    uint32_t data_bytes;    // Bytes gravados na GDDRAM
+    uint32_t command_bytes; // Bytes de comando recebidos
+} fake_oled_t;
+
+/**
+ * Estado atual do display.
+ */
+const fake_oled_t* fake_oled(void);
+
+/**
+ * Grava a GDDRAM do display como imagem PBM (P4, 128x64; pixel aceso = preto).
+ * @param path Arquivo
+ * @return false se o arquivo não pôde ser escrito
+ */
+bool fake_oled_write_pbm(const char* path);
+
+/**
+ * Grava como PBM qualquer framebuffer no formato do SSD1306 (páginas de 8 linhas,
+ * um byte por coluna, bit 0 no alto), por exemplo o buffer de um ssd1306_t.
+ * @param path Arquivo
+ * @param buffer Framebuffer
+ * @param width Largura (pixels)
+ * @param height Altura (pixels, múltiplo de 8)
+ * @return false se o arquivo não pôde ser escrito
+ */
+bool fake_pbm_write(const char* path, const uint8_t* buffer, uint width, uint height);
+
+// ----- PIO -----
+
+/**
+ * Palavras escritas na FIFO de TX de uma máquina de estados (pelo DMA ou por
+ * pio_sm_put_blocking()), na ordem.
+ * @param count Recebe a quantidade
+ */
+const uint32_t* fake_pio_words(PIO pio, uint sm, size_t* count);
+
+/**
+ * Apaga os registros das FIFOs da PIO.
+ */
+void fake_pio_clear(void);
+
+/**
+ * Divisor de clock atual de uma máquina de estados.
+ */
+float fake_pio_clkdiv(PIO pio, uint sm);
+
+// ----- GPIO -----
+
+/**
+ * Muda o nível de um pino de entrada visto de fora (um botão, por exemplo). A borda
+ * vai para a interrupção do GPIO se habilitada; com as interrupções desligadas, as
+ * bordas do mesmo pino se juntam num só evento, como no registrador de status da placa.
+ * @param gpio Pino
+ * @param level Nível
+ */
+void fake_gpio_drive(uint gpio, bool level);
+
+/**
+ * Último nível escrito por gpio_put() (ou o nível de entrada).
+ */
+bool fake_gpio_level(uint gpio);
+
+// ----- Alarmes -----
+
+/**
+ * Faz as próximas chamadas de add_alarm_in_us() falharem (pool de alarmes cheio).
+ * @param count Número de chamadas
+ */
+void fake_alarm_fail_next(uint count);
+
+/**
+ * Alarmes e timers repetitivos agendados.
+ */
+uint fake_alarms_pending(void);
+
+// ----- Flash -----
+
+// Tempo em que as operações na flash deixam o núcleo 0 parado.
+#define FAKE_FLASH_ERASE_US 45000 // Por setor
+#define FAKE_FLASH_PAGE_US 1000   // Por página
+
+// Código de saída do processo numa queda de energia simulada.
+#define FAKE_POWER_CUT_EXIT 77
+
+/**
+ * Conteúdo da flash, para o teste mexer nos bytes sem passar pelas operações
+ * (um bit que apodreceu, por exemplo).
+ */
+uint8_t* fake_flash_memory(void);
+
+/**
+ * Apaga a flash inteira (0xFF).
+ */
+void fake_flash_erase_all(void);
+
+/**
+ * Faz as próximas chamadas de flash_safe_execute() falharem sem mexer na flash
+ * (o outro núcleo não respondeu).
+ */
+void fake_flash_fail_next(uint count);
+
+/**
+ * Corta a energia no meio de uma operação: a operação de número ops (contando a partir
+ * de agora) grava ou apaga só parte dos bytes e o processo termina com
+ * FAKE_POWER_CUT_EXIT. A flash é compartilhada com processos criados por fork(),
+ * então o teste pode cortar num filho e conferir o resultado no pai.
+ * @param ops Número da operação, ou negativo para desligar
+ */
+void fake_flash_power_cut_after(int ops);
+
+/**
+ * Operações (flash_range_erase()/flash_range_program()) feitas desde o início.
+ */
+uint32_t fake_flash_ops(void);
+
+/**
+ * Lê ou grava a imagem da flash num arquivo, para manter o conteúdo entre execuções.
+ */
+bool fake_flash_load(const char* path);
+bool fake_flash_save(const char* path);
+
+// ----- stdio -----
+
+/**
+ * Acrescenta texto à entrada lida por getchar_timeout_us().
+ */
+void fake_stdin_push(const char* text);
+
+/**
+ * Bytes escritos por stdio_put_string() desde o último fake_stdout_clear().
+ * (printf() vai direto para a saída do processo.)
+ * @param len Recebe a quantidade
+ */
+const uint8_t* fake_stdout(size_t* len);
+void fake_stdout_clear(void);
+
+// ----- Diversos -----
+
+/**
+ * Função passada a multicore_launch_core1().
+ */
+void (*fake_core1_entry(void))(void);
+
+/**
+ * Chamadas a reset_usb_boot().
+ */
+uint32_t fake_bootsel_requests(void);
+
+/**
+ * Chamadas a clock_configure().
+ */
+uint32_t fake_clock_changes(void);
+
+/**
+ * Grava um registro de texto de todo o tráfego (I2C, PIO, GPIO, flash, clocks e ADC),
+ * uma linha por evento com o instante em µs. Também ligado pela variável de ambiente
+ * FAKE_HAL_TRACE=arquivo.
+ * @param path Arquivo, ou NULL para fechar
+ * @return false se o arquivo não pôde ser aberto
+ */
+bool fake_trace_open(const char* path);
+
+#endif // FAKE_HAL_H
@@ -0,0 +1,128 @@
+#include "fake_hal.h"
+
+#include <stdio.h>
+
+// Número de bytes de argumento de cada comando do SSD1306 usado pelo firmware.
+static uint oled_command_args(uint8_t command) {
+    switch (command) {
+    case 0x20: // SET_MEM_ADDR
+    case 0x81: // SET_CONTRAST
+    case 0x8D: // SET_CHARGE_PUMP
+    case 0xA8: // SET_MUX_RATIO
+    case 0xD3: // SET_DISP_OFFSET
+    case 0xD5: // SET_DISP_CLK_DIV
+    case 0xD9: // SET_PRECHARGE
+    case 0xDA: // SET_COM_PIN_CFG
+    case 0xDB: // SET_VCOM_DESEL
+        return 1;
+    case 0x21: // SET_COL_ADDR
+    case 0x22: // SET_PAGE_ADDR
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+static fake_oled_t oled;
+
+static struct {
+    bool in_transaction;  // Já recebeu o byte de controle
+    bool data;            // Byte de controle 0x40: dados na GDDRAM
+    uint8_t command;      // Comando esperando argumentos
+    uint8_t args[2];
+    uint args_needed, args_received;
+    uint8_t col_start, col_end, page_start, page_end;
+    uint8_t col, page;
+} parser = {.col_end = FAKE_OLED_WIDTH - 1, .page_end = FAKE_OLED_PAGES - 1};
+
+static void oled_command_done(void) {
+    switch (parser.command) {
+    case 0x21:
+        parser.col_start = parser.col = parser.args[0] & 0x7f;
+        parser.col_end = parser.args[1] & 0x7f;
+        break;
+    case 0x22:
+        parser.page_start = parser.page = parser.args[0] & 0x07;
+        parser.page_end = parser.args[1] & 0x07;
+        break;
+    case 0x81:
+        oled.contrast = parser.args[0];
+        break;
+    case 0xAE:
+    case 0xAF:
+        oled.on = parser.command & 1;
+        break;
+    }
+}
+
+static void oled_command_byte(uint8_t byte) {
+    ++oled.command_bytes;
+    if (parser.args_needed) {
+        parser.args[parser.args_received++] = byte;
+        if (parser.args_received == parser.args_needed) {
+            parser.args_needed = 0;
+            oled_command_done();
+        }
+        return;
+    }
+    parser.command = byte;
+    parser.args_received = 0;
+    parser.args_needed = oled_command_args(byte);
+    if (!parser.args_needed)
+        oled_command_done();
+}
+
+// Endereçamento horizontal: coluna a coluna dentro da janela, passando para a próxima página no fim.
+static void oled_data_byte(uint8_t byte) {
+    ++oled.data_bytes;
+    oled.ram[parser.page][parser.col] = byte;
+    if (parser.col < parser.col_end) {
+        ++parser.col;
+        return;
+    }
+    parser.col = parser.col_start;
+    parser.page = parser.page < parser.page_end ? parser.page + 1 : parser.page_start;
+}
+
+void fake_oled_i2c_word(uint16_t word) {
+    uint8_t byte = word & 0xff;
+    if (!parser.in_transaction) {
+        // Byte de controle: Co = 0 nos fluxos usados pelo firmware, D/C no bit 6.
+        parser.in_transaction = true;
+        parser.data = byte & 0x40;
+    } else if (parser.data) {
+        oled_data_byte(byte);
+    } else {
+        oled_command_byte(byte);
+    }
+    if (word & I2C_IC_DATA_CMD_STOP_BITS)
+        parser.in_transaction = false;
+}
+
+const fake_oled_t* fake_oled(void) {
+    return &oled;
+}
+
+bool fake_pbm_write(const char* path, const uint8_t* buffer, uint width, uint height) {
+    FILE* f = fopen(path, "wb");
+    if (!f)
+        return false;
+
+    fprintf(f, "P4\n%u %u\n", width, height);
+    for (uint y = 0; y < height; ++y) {
+        uint8_t packed = 0;
+        for (uint x = 0; x < width; ++x) {
+            bool on = buffer[(y / 8) * width + x] & (1u << (y % 8));
+            packed |= on << (7 - x % 8);
+            if (x % 8 == 7 || x == width - 1) {
+                fputc(packed, f);
+                packed = 0;
+            }
+        }
+    }
+    return fclose(f) == 0;
+}
+
+bool fake_oled_write_pbm(const char* path) {
+    return fake_pbm_write(path, &oled.ram[0][0], FAKE_OLED_WIDTH, FAKE_OLED_PAGES * 8);
+}
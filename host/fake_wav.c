@@ -0,0 +1,136 @@
+#include "fake_hal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Arquivo carregado numa entrada do ADC, com as amostras já normalizadas em [-1, 1].
+typedef struct {
+    float* samples;
+    size_t count;
+    double rate;
+    double full_scale;
+    double dc;
+    double start_s; // Instante em que o arquivo começou a tocar
+    bool loop;
+} fake_wav_t;
+
+static fake_wav_t players[5];
+
+static uint32_t read_le(const uint8_t* p, uint bytes) {
+    uint32_t value = 0;
+    for (uint i = 0; i < bytes; ++i)
+        value |= (uint32_t)p[i] << (8 * i);
+    return value;
+}
+
+// Converte uma amostra de um formato do WAV para [-1, 1].
+static float decode(const uint8_t* p, uint bits, bool is_float) {
+    if (is_float) {
+        float value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+    switch (bits) {
+    case 8:
+        return (p[0] - 128) / 128.f;
+    case 16:
+        return (int16_t)read_le(p, 2) / 32768.f;
+    case 24:
+        return ((int32_t)(read_le(p, 3) << 8) >> 8) / 8388608.f;
+    default:
+        return (int32_t)read_le(p, 4) / 2147483648.f;
+    }
+}
+
+static bool load_wav(fake_wav_t* player, const uint8_t* data, size_t size) {
+    if (size < 12 || memcmp(data, "RIFF", 4) || memcmp(data + 8, "WAVE", 4))
+        return false;
+
+    uint format = 0, channels = 0, bits = 0;
+    const uint8_t* pcm = NULL;
+    size_t pcm_size = 0;
+    for (size_t pos = 12; pos + 8 <= size;) {
+        uint32_t chunk = read_le(data + pos + 4, 4);
+        const uint8_t* body = data + pos + 8;
+        if (chunk > size - pos - 8)
+            chunk = (uint32_t)(size - pos - 8);
+        if (!memcmp(data + pos, "fmt ", 4) && chunk >= 16) {
+            format = read_le(body, 2);
+            channels = read_le(body + 2, 2);
+            player->rate = read_le(body + 4, 4);
+            bits = read_le(body + 14, 2);
+            if (format == 0xfffe && chunk >= 26) // WAVE_FORMAT_EXTENSIBLE: formato no subtipo
+                format = read_le(body + 24, 2);
+        } else if (!memcmp(data + pos, "data", 4)) {
+            pcm = body;
+            pcm_size = chunk;
+        }
+        pos += 8 + chunk + (chunk & 1);
+    }
+
+    bool is_float = format == 3 && bits == 32;
+    if (!pcm || !channels || !player->rate || !(format == 1 || is_float) ||
+        !(bits == 8 || bits == 16 || bits == 24 || bits == 32)) {
+        fprintf(stderr, "fake_wav: formato não suportado (formato %u, %u bits)\n", format, bits);
+        return false;
+    }
+
+    uint frame = channels * bits / 8;
+    player->count = pcm_size / frame;
+    player->samples = malloc(player->count * sizeof(float));
+    for (size_t i = 0; i < player->count; ++i)
+        player->samples[i] = decode(pcm + i * frame, bits, is_float);
+    return true;
+}
+
+static void load_pcm(fake_wav_t* player, const uint8_t* data, size_t size, double rate) {
+    player->rate = rate;
+    player->count = size / 2;
+    player->samples = malloc(player->count * sizeof(float));
+    for (size_t i = 0; i < player->count; ++i)
+        player->samples[i] = (int16_t)read_le(data + 2 * i, 2) / 32768.f;
+}
+
+float fake_wav_sample(uint input, double t_s, void* user) {
+    const fake_wav_t* player = user;
+    (void)input;
+
+    double position = (t_s - player->start_s) * player->rate;
+    size_t i = (size_t)position;
+    if (player->loop) {
+        i %= player->count;
+    } else if (position < 0.0 || i + 1 >= player->count) {
+        return (float)player->dc;
+    }
+    double frac = position - (double)(size_t)position;
+    float a = player->samples[i];
+    float b = player->samples[(i + 1) % player->count];
+    return (float)(player->dc + player->full_scale * (a + (b - a) * frac));
+}
+
+double fake_adc_play_file(uint input, const char* path, double pcm_rate, double full_scale, double dc, bool loop) {
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return -1.0;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* data = malloc(size > 0 ? (size_t)size : 1);
+    size_t read = fread(data, 1, (size_t)(size > 0 ? size : 0), f);
+    fclose(f);
+
+    fake_wav_t* player = &players[input];
+    free(player->samples);
+    *player = (fake_wav_t){.full_scale = full_scale, .dc = dc, .start_s = time_us_64() / 1e6, .loop = loop};
+
+    bool ok = read >= 12 && !memcmp(data, "RIFF", 4) ? load_wav(player, data, read)
+                                                      : (load_pcm(player, data, read, pcm_rate), pcm_rate > 0);
+    free(data);
+    if (!ok || player->count < 2)
+        return -1.0;
+
+    // O arquivo começa a tocar agora.
+    fake_adc_set_source(input, fake_wav_sample, player);
+    return player->count / player->rate;
+}
@@ -0,0 +1,33 @@
+#ifndef _HARDWARE_ADC_H
+#define _HARDWARE_ADC_H
+
+#include "pico.h"
+
+typedef struct {
+    volatile uint32_t cs;
+    volatile uint32_t result;
+    volatile uint32_t fcs;
+    volatile uint32_t fifo;
+    volatile uint32_t div;
+} adc_hw_t;
+
+/**
+ * O DMA do fake HAL reconhece &adc_hw->fifo como origem e lê as amostras da fonte
+ * configurada em fake_adc_set_source() / fake_adc_play_file().
+ */
+extern adc_hw_t fake_adc_hw;
+#define adc_hw (&fake_adc_hw)
+
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+uint adc_get_selected_input(void);
+void adc_set_round_robin(uint input_mask);
+void adc_set_temp_sensor_enabled(bool enable);
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift);
+void adc_run(bool run);
+void adc_fifo_drain(void);
+void adc_set_clkdiv(float clkdiv);
+uint16_t adc_read(void);
+
+#endif // _HARDWARE_ADC_H
@@ -0,0 +1,93 @@
+#ifndef _HARDWARE_DMA_H
+#define _HARDWARE_DMA_H
+
+#include "pico.h"
+
+#define NUM_DMA_CHANNELS 12
+
+// Pedidos de dados dos periféricos (os números do RP2040).
+#define DREQ_PIO0_TX0 0
+#define DREQ_PIO1_TX0 8
+#define DREQ_I2C0_TX 32
+#define DREQ_I2C1_TX 34
+#define DREQ_ADC 36
+#define DREQ_FORCE 63
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+};
+
+/**
+ * Configuração de um canal com os campos separados, no lugar do registrador CTRL.
+ */
+typedef struct {
+    enum dma_channel_transfer_size size;
+    bool read_increment;
+    bool write_increment;
+    uint dreq;
+    bool ring_write;
+    uint ring_bits;
+    uint chain_to;
+    bool enable;
+} dma_channel_config;
+
+typedef struct {
+    volatile uint32_t abort;
+} dma_hw_t;
+
+/**
+ * Cada acesso conclui o abort pedido pelo acesso anterior, então o laço
+ * "while (dma_hw->abort)" termina como na placa.
+ */
+dma_hw_t* fake_dma_hw(void);
+#define dma_hw (fake_dma_hw())
+
+static inline void channel_config_set_transfer_data_size(dma_channel_config* c, enum dma_channel_transfer_size size) {
+    c->size = size;
+}
+
+static inline void channel_config_set_read_increment(dma_channel_config* c, bool incr) {
+    c->read_increment = incr;
+}
+
+static inline void channel_config_set_write_increment(dma_channel_config* c, bool incr) {
+    c->write_increment = incr;
+}
+
+static inline void channel_config_set_dreq(dma_channel_config* c, uint dreq) {
+    c->dreq = dreq;
+}
+
+static inline void channel_config_set_ring(dma_channel_config* c, bool write, uint size_bits) {
+    c->ring_write = write;
+    c->ring_bits = size_bits;
+}
+
+static inline void channel_config_set_chain_to(dma_channel_config* c, uint chain_to) {
+    c->chain_to = chain_to;
+}
+
+static inline void channel_config_set_enable(dma_channel_config* c, bool enable) {
+    c->enable = enable;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel);
+int dma_claim_unused_channel(bool required);
+void dma_channel_claim(uint channel);
+void dma_channel_unclaim(uint channel);
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr,
+                           const volatile void* read_addr, uint transfer_count, bool trigger);
+void dma_channel_set_read_addr(uint channel, const volatile void* read_addr, bool trigger);
+void dma_channel_set_write_addr(uint channel, volatile void* write_addr, bool trigger);
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger);
+void dma_channel_start(uint channel);
+void dma_channel_abort(uint channel);
+bool dma_channel_is_busy(uint channel);
+void dma_channel_wait_for_finish_blocking(uint channel);
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+bool dma_channel_get_irq0_status(uint channel);
+void dma_channel_acknowledge_irq0(uint channel);
+
+#endif // _HARDWARE_DMA_H
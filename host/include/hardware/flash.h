@@ -0,0 +1,18 @@
+#ifndef _HARDWARE_FLASH_H
+#define _HARDWARE_FLASH_H
+
+#include "pico.h"
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+
+/**
+ * A flash inteira fica na RAM do fake HAL (apagada = 0xFF), vista no endereço XIP.
+ */
+uint8_t* fake_flash_memory(void);
+#define XIP_BASE ((uintptr_t)fake_flash_memory())
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t* data, size_t count);
+
+#endif // _HARDWARE_FLASH_H
@@ -0,0 +1,50 @@
+#ifndef _HARDWARE_I2C_H
+#define _HARDWARE_I2C_H
+
+#include "pico.h"
+
+#define I2C_IC_DATA_CMD_CMD_BITS 0x00000100
+#define I2C_IC_DATA_CMD_STOP_BITS 0x00000200
+#define I2C_IC_DATA_CMD_RESTART_BITS 0x00000400
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS 0x00000040
+#define I2C_IC_STATUS_TFE_BITS 0x00000004
+#define I2C_IC_STATUS_MST_ACTIVITY_BITS 0x00000020
+
+/**
+ * Registradores usados pelo firmware. Escritas em data_cmd só chegam ao fake HAL
+ * pelo DMA (a palavra é gravada no registro do barramento); status indica sempre
+ * barramento livre, e raw_intr_stat pode ser alterado pelos testes para simular um NACK.
+ */
+typedef struct {
+    volatile uint32_t tar;
+    volatile uint32_t data_cmd;
+    volatile uint32_t enable;
+    volatile uint32_t status;
+    volatile uint32_t raw_intr_stat;
+    volatile uint32_t clr_tx_abrt;
+} i2c_hw_t;
+
+typedef struct i2c_inst {
+    i2c_hw_t* hw;
+    uint index;
+    uint baudrate;
+} i2c_inst_t;
+
+extern i2c_inst_t fake_i2c0_inst;
+extern i2c_inst_t fake_i2c1_inst;
+#define i2c0 (&fake_i2c0_inst)
+#define i2c1 (&fake_i2c1_inst)
+
+static inline i2c_hw_t* i2c_get_hw(i2c_inst_t* i2c) {
+    return i2c->hw;
+}
+
+static inline uint i2c_get_dreq(i2c_inst_t* i2c, bool is_tx) {
+    return (i2c->index ? 34 : 32) + !is_tx;
+}
+
+uint i2c_init(i2c_inst_t* i2c, uint baudrate);
+uint i2c_set_baudrate(i2c_inst_t* i2c, uint baudrate);
+int i2c_write_blocking(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop);
+
+#endif // _HARDWARE_I2C_H
@@ -0,0 +1,19 @@
+#ifndef _HARDWARE_IRQ_H
+#define _HARDWARE_IRQ_H
+
+#include "pico.h"
+
+enum irq_num {
+    TIMER_IRQ_0 = 0,
+    IO_IRQ_BANK0 = 13,
+    DMA_IRQ_0 = 11,
+    DMA_IRQ_1 = 12,
+    IRQ_COUNT = 32,
+};
+
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+
+#endif // _HARDWARE_IRQ_H
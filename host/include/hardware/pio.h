@@ -0,0 +1,83 @@
+#ifndef _HARDWARE_PIO_H
+#define _HARDWARE_PIO_H
+
+#include "pico.h"
+#include "hardware/gpio.h"
+
+typedef struct {
+    volatile uint32_t txf[4];
+} pio_hw_t;
+
+typedef pio_hw_t* PIO;
+
+extern pio_hw_t fake_pio0_hw;
+extern pio_hw_t fake_pio1_hw;
+#define pio0 (&fake_pio0_hw)
+#define pio1 (&fake_pio1_hw)
+
+#define PIO_FIFO_JOIN_NONE 0
+#define PIO_FIFO_JOIN_TX 1
+#define PIO_FIFO_JOIN_RX 2
+
+typedef struct {
+    const uint16_t* instructions;
+    uint8_t length;
+    int8_t origin;
+} pio_program_t;
+
+typedef struct {
+    float clkdiv;
+    uint sideset_base;
+    bool out_shift_right;
+    bool autopull;
+    uint pull_threshold;
+    uint fifo_join;
+    uint wrap_target;
+    uint wrap;
+} pio_sm_config;
+
+static inline pio_sm_config pio_get_default_sm_config(void) {
+    return (pio_sm_config){.clkdiv = 1.f, .pull_threshold = 32};
+}
+
+static inline void sm_config_set_sideset_pins(pio_sm_config* c, uint base) {
+    c->sideset_base = base;
+}
+
+static inline void sm_config_set_out_shift(pio_sm_config* c, bool shift_right, bool autopull, uint threshold) {
+    c->out_shift_right = shift_right;
+    c->autopull = autopull;
+    c->pull_threshold = threshold;
+}
+
+static inline void sm_config_set_fifo_join(pio_sm_config* c, uint join) {
+    c->fifo_join = join;
+}
+
+static inline void sm_config_set_clkdiv(pio_sm_config* c, float div) {
+    c->clkdiv = div;
+}
+
+static inline void sm_config_set_wrap(pio_sm_config* c, uint wrap_target, uint wrap) {
+    c->wrap_target = wrap_target;
+    c->wrap = wrap;
+}
+
+static inline uint pio_get_dreq(PIO pio, uint sm, bool is_tx) {
+    return (pio == pio0 ? 0 : 8) + (is_tx ? sm : sm + 4);
+}
+
+uint pio_add_program(PIO pio, const pio_program_t* program);
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_gpio_init(PIO pio, uint pin);
+int pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out);
+int pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config* config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div);
+
+/**
+ * Palavras escritas na FIFO de TX (pelo DMA ou aqui) ficam no registro da PIO (fake_pio_words()).
+ */
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+
+#endif // _HARDWARE_PIO_H
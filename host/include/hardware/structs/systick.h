@@ -0,0 +1,20 @@
+#ifndef _HARDWARE_STRUCTS_SYSTICK_H
+#define _HARDWARE_STRUCTS_SYSTICK_H
+
+#include "pico.h"
+
+typedef struct {
+    volatile uint32_t csr;
+    volatile uint32_t rvr;
+    volatile uint32_t cvr;
+    volatile uint32_t calib;
+} systick_hw_t;
+
+/**
+ * SysTick do fake HAL: cada acesso atualiza cvr com o relógio do computador convertido
+ * em ciclos do clk_sys (contador decrescente de 24 bits, como na placa).
+ */
+systick_hw_t* fake_systick(void);
+#define systick_hw (fake_systick())
+
+#endif // _HARDWARE_STRUCTS_SYSTICK_H
@@ -0,0 +1,29 @@
+#ifndef _HARDWARE_SYNC_H
+#define _HARDWARE_SYNC_H
+
+#include "pico.h"
+
+static inline void __mem_fence_release(void) {
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void __mem_fence_acquire(void) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+/**
+ * __wfi() e __wfe() avançam o tempo virtual até o próximo evento do fake HAL
+ * (bloco do ADC, alarme ou timer); __sev() só é contado.
+ */
+void __sev(void);
+void __wfe(void);
+void __wfi(void);
+
+/**
+ * As "interrupções" do fake HAL (DMA, alarmes, timers e GPIO) ficam pendentes enquanto
+ * desligadas e são atendidas por restore_interrupts().
+ */
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+#endif // _HARDWARE_SYNC_H
@@ -0,0 +1,8 @@
+#ifndef _HARDWARE_UART_H
+#define _HARDWARE_UART_H
+
+#include "pico.h"
+
+// O stdio do fake HAL não passa por UART; o cabeçalho existe só para o include de main.c.
+
+#endif // _HARDWARE_UART_H
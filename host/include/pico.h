@@ -0,0 +1,45 @@
+#ifndef _PICO_H
+#define _PICO_H
+
+/**
+ * Substituto de pico.h para a compilação no computador (host/CMakeLists.txt):
+ * só os tipos e macros que o firmware usa. As funções ficam em host/fake_hal.c.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+#define KHZ 1000
+#define MHZ 1000000
+
+// Códigos de retorno do SDK.
+#define PICO_OK 0
+#define PICO_ERROR_GENERIC -1
+#define PICO_ERROR_TIMEOUT -2
+
+// A placa do projeto é a Pico W, com 2 MB de flash.
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#endif
+
+// No computador não há RAM separada da flash.
+#define __not_in_flash_func(name) name
+#define __no_inline_not_in_flash_func(name) __attribute__((noinline)) name
+
+/**
+ * Cada volta de um laço de espera ativa avança o tempo virtual em 1 µs, para que o
+ * hardware do fake HAL (ADC, DMA, alarmes) ande enquanto o firmware espera por ele.
+ */
+void tight_loop_contents(void);
+
+/**
+ * Núcleo que está "executando"; os testes trocam com fake_set_core().
+ */
+uint get_core_num(void);
+
+#endif // _PICO_H
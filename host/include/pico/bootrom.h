@@ -0,0 +1,11 @@
+#ifndef _PICO_BOOTROM_H
+#define _PICO_BOOTROM_H
+
+#include "pico.h"
+
+/**
+ * Só conta as chamadas (fake_bootsel_requests()).
+ */
+void reset_usb_boot(uint32_t usb_activity_gpio_pin_mask, uint32_t disable_interface_mask);
+
+#endif // _PICO_BOOTROM_H
@@ -0,0 +1,14 @@
+#ifndef _PICO_FLASH_H
+#define _PICO_FLASH_H
+
+#include "pico.h"
+#include "hardware/flash.h"
+
+/**
+ * Executa func com as "interrupções" do núcleo 0 paradas pelo tempo que a operação
+ * levaria na placa (fake_flash_*), como a pausa do outro núcleo no SDK.
+ */
+int flash_safe_execute(void (*func)(void*), void* param, uint32_t enter_exit_timeout_ms);
+bool flash_safe_execute_core_init(void);
+
+#endif // _PICO_FLASH_H
@@ -0,0 +1,12 @@
+#ifndef _PICO_MULTICORE_H
+#define _PICO_MULTICORE_H
+
+#include "pico.h"
+
+/**
+ * Guarda a função do núcleo 1 sem executá-la: os testes chamam as tarefas do núcleo 1
+ * diretamente (fake_core1_entry()).
+ */
+void multicore_launch_core1(void (*entry)(void));
+
+#endif // _PICO_MULTICORE_H
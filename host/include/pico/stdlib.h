@@ -0,0 +1,24 @@
+#ifndef _PICO_STDLIB_H
+#define _PICO_STDLIB_H
+
+#include <stdio.h>
+#include "pico.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+#include "hardware/uart.h"
+#include "hardware/sync.h"
+
+bool stdio_init_all(void);
+
+/**
+ * Lê um caractere do stdio sem bloquear (fila de fake_stdin_push()).
+ * @return Caractere, ou PICO_ERROR_TIMEOUT
+ */
+int getchar_timeout_us(uint32_t timeout_us);
+
+/**
+ * Escreve no stdio; os bytes ficam gravados para os testes (fake_stdout()).
+ */
+void stdio_put_string(const char* s, int len, bool newline, bool cr_translation);
+
+#endif // _PICO_STDLIB_H
@@ -0,0 +1,28 @@
+#ifndef _PICO_SYNC_H
+#define _PICO_SYNC_H
+
+#include "pico.h"
+#include "hardware/sync.h"
+
+/**
+ * Seção crítica: no computador só um contexto roda por vez, então basta desligar
+ * as "interrupções" do fake HAL.
+ */
+typedef struct {
+    uint32_t saved;
+    bool initialized;
+} critical_section_t;
+
+static inline void critical_section_init(critical_section_t* cs) {
+    cs->initialized = true;
+}
+
+static inline void critical_section_enter_blocking(critical_section_t* cs) {
+    cs->saved = save_and_disable_interrupts();
+}
+
+static inline void critical_section_exit(critical_section_t* cs) {
+    restore_interrupts(cs->saved);
+}
+
+#endif // _PICO_SYNC_H
@@ -0,0 +1,45 @@
+#ifndef _PICO_TIME_H
+#define _PICO_TIME_H
+
+#include "pico.h"
+
+/**
+ * Tempo virtual do fake HAL: só avança com fake_advance_us(), sleep_*(),
+ * tight_loop_contents(), __wfi(), __wfe() e as operações na flash. Alarmes e timers
+ * repetitivos disparam quando o tempo passa pelo prazo deles.
+ */
+typedef uint64_t absolute_time_t;
+
+absolute_time_t get_absolute_time(void);
+uint32_t to_ms_since_boot(absolute_time_t t);
+uint64_t to_us_since_boot(absolute_time_t t);
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void busy_wait_us(uint64_t us);
+
+typedef int32_t alarm_id_t;
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void* user_data);
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void* user_data, bool fire_if_past);
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void* user_data, bool fire_if_past);
+bool cancel_alarm(alarm_id_t id);
+
+typedef struct repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t* rt);
+
+struct repeating_timer {
+    int64_t delay_us;
+    void* user_data;
+    alarm_id_t alarm_id;
+    repeating_timer_callback_t callback;
+};
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void* user_data,
+                            repeating_timer_t* out);
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void* user_data,
+                            repeating_timer_t* out);
+bool cancel_repeating_timer(repeating_timer_t* timer);
+
+#endif // _PICO_TIME_H
@@ -0,0 +1,44 @@
+#ifndef _WS2818B_PIO_H
+#define _WS2818B_PIO_H
+
+/**
+ * Substituto do cabeçalho gerado por pico_generate_pio_header() a partir de
+ * ws2818b.pio: mesmo programa e a mesma inicialização da máquina de estados.
+ */
+
+#include "hardware/pio.h"
+#include "hardware/clocks.h"
+
+static const uint16_t ws2818b_program_instructions[] = {
+    0x6221, //  0: out    x, 1            side 0 [2]
+    0x1123, //  1: jmp    !x, 3           side 1 [1]
+    0x1400, //  2: jmp    0               side 1 [4]
+    0xa442, //  3: nop                    side 0 [4]
+};
+
+static const pio_program_t ws2818b_program = {
+    .instructions = ws2818b_program_instructions,
+    .length = 4,
+    .origin = -1,
+};
+
+static inline pio_sm_config ws2818b_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + 0, offset + 3);
+    return c;
+}
+
+static inline void ws2818b_program_init(PIO pio, uint sm, uint offset, uint pin, float freq) {
+    pio_gpio_init(pio, pin);
+    pio_sm_set_consecutive_pindirs(pio, sm, pin, 1, true);
+    pio_sm_config c = ws2818b_program_get_default_config(offset);
+    sm_config_set_sideset_pins(&c, pin);
+    sm_config_set_out_shift(&c, true, true, 24);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_TX);
+    float prescaler = clock_get_hz(clk_sys) / (10.f * freq);
+    sm_config_set_clkdiv(&c, prescaler);
+    pio_sm_init(pio, sm, offset, &c);
+    pio_sm_set_enabled(pio, sm, true);
+}
+
+#endif // _WS2818B_PIO_H
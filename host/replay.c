@@ -0,0 +1,134 @@
+// Reproduz um WAV (ou PCM cru de 16 bits) como sinal do microfone e passa pela mesma
+// cadeia do laço principal: captura contínua, nível DC, decimação, medidor e espectro.
+// Imprime uma linha CSV por quadro de 200 ms e, com --pbm, grava o display de cada quadro.
+//
+//   replay sala.wav [--scale 1000] [--dc 2048] [--rate 16000] [--sensitivity 1] [--pbm dir]
+//
+// --scale é o número de contagens do ADC correspondente ao fundo de escala do arquivo;
+// --rate só vale para PCM cru. O tráfego dos barramentos vai para FAKE_HAL_TRACE, se definida.
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "fake_hal.h"
+#include "mic.h"
+#include "spl.h"
+#include "spectrum.h"
+#include "ssd1306.h"
+
+#define FRAME_US 200000
+
+extern ssd1306_t display;
+void i2c_setup(void);
+void update_full_display(ssd1306_t* display, float db_value, uint8_t sensitivity);
+
+static void usage(void) {
+    fprintf(stderr, "uso: replay arquivo [--scale contagens] [--dc contagens] [--rate Hz] "
+                    "[--sensitivity 1-5] [--pbm diretorio]\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2)
+        usage();
+
+    const char* path = argv[1];
+    const char* pbm_dir = NULL;
+    double scale = 1000.0, dc = ADC_MIDPOINT, pcm_rate = 16000.0;
+    int sensitivity = 1;
+    for (int i = 2; i < argc; ++i) {
+        if (i + 1 == argc)
+            usage();
+        if (!strcmp(argv[i], "--scale"))
+            scale = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--dc"))
+            dc = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--rate"))
+            pcm_rate = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--sensitivity"))
+            sensitivity = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--pbm"))
+            pbm_dir = argv[++i];
+        else
+            usage();
+    }
+    if (sensitivity < 1 || sensitivity > 5)
+        usage();
+
+    // As mensagens do firmware na inicialização vão para o stderr; o stdout fica só com o CSV.
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+    i2c_setup();
+    ssd1306_init(&display, i2c1, 64, 128, FAKE_OLED_ADDR, false);
+    mic_init();
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    double duration = fake_adc_play_file(MIC_CHANNEL, path, pcm_rate, scale, dc, false);
+    if (duration < 0) {
+        fprintf(stderr, "replay: não foi possível ler %s\n", path);
+        return 1;
+    }
+
+    spl_init(mic_get_decimated_rate());
+    spectrum_init(mic_get_decimated_rate());
+    mic_start_continuous();
+
+    printf("t_ms,rms_counts,laf,las,lcf,laeq,lafmax,lafmin,band_250,band_500,band_1k,band_2k,band_4k\n");
+
+    uint64_t start_us = time_us_64();
+    uint64_t next_frame_us = start_us + FRAME_US;
+    uint64_t frame_sum_squared = 0;
+    uint32_t frame_count = 0;
+    float band_db[SPECTRUM_BANDS] = {0};
+    int16_t decimated[MIC_DECIMATED_MAX_SAMPLES];
+    uint frame = 0;
+
+    while (time_us_64() - start_us < duration * 1e6) {
+        const uint16_t* adc_buffer = mic_wait_ready_buffer();
+
+        mic_block_stats_t block;
+        mic_block_stats(adc_buffer, SAMPLES, mic_channel_count(), &block);
+        mic_remove_dc(&block);
+        frame_sum_squared += block.sum_squared;
+        frame_count += block.count;
+
+        uint count = mic_decimate(adc_buffer, decimated);
+        for (uint i = 0; i < count; i += MIC_DECIMATED_SAMPLES) {
+            spl_process(&decimated[i], MIC_DECIMATED_SAMPLES);
+            if (spectrum_feed(&decimated[i], MIC_DECIMATED_SAMPLES))
+                spectrum_compute(band_db);
+        }
+
+        if (time_us_64() < next_frame_us)
+            continue;
+        next_frame_us += FRAME_US;
+
+        spl_levels_t levels;
+        spl_get_levels(&levels);
+        printf("%llu,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n",
+               (unsigned long long)((time_us_64() - start_us) / 1000), sqrt((double)frame_sum_squared / frame_count),
+               levels.laf, levels.las, levels.lcf, levels.laeq, levels.lafmax, levels.lafmin, band_db[0], band_db[1],
+               band_db[2], band_db[3], band_db[4]);
+        frame_sum_squared = 0;
+        frame_count = 0;
+
+        update_full_display(&display, levels.laf, sensitivity);
+        ssd1306_update(&display);
+        if (pbm_dir) {
+            char pbm_path[512];
+            snprintf(pbm_path, sizeof(pbm_path), "%s/frame_%05u.pbm", pbm_dir, frame);
+            if (!fake_oled_write_pbm(pbm_path)) {
+                fprintf(stderr, "replay: não foi possível gravar %s\n", pbm_path);
+                return 1;
+            }
+        }
+        ++frame;
+    }
+
+    mic_stop_continuous();
+    return 0;
+}
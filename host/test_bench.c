@@ -0,0 +1,167 @@
+// Benchmark dos estágios (bench.c) no computador: os mesmos estágios do laço principal,
+// medidos pelo SysTick do fake HAL (relógio do computador em ciclos do clk_sys), e o
+// relatório CSV que a placa imprime com -DBENCH=ON.
+
+#define BENCH_ENABLED 1
+#include "bench.c"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "fake_hal.h"
+#include "check.h"
+#include "matrizLED.h"
+#include "mic.h"
+#include "spectrum.h"
+#include "spl.h"
+#include "ssd1306.h"
+
+extern ssd1306_t display;
+void i2c_setup(void);
+void npInit(uint pin);
+void update_full_display(ssd1306_t* display, float db_value, uint8_t sensitivity);
+void update_led_matrix(float db, uint8_t sensitivity);
+
+#define REPORT_PATH "test_bench_report.csv"
+
+// Espera ativa pelo relógio do computador, para um estágio de duração conhecida.
+static void spin_us(uint32_t us) {
+    uint64_t end = check_now_ns() + us * 1000ull;
+    while (check_now_ns() < end)
+        ;
+}
+
+// Um quadro de cada estágio, na ordem do laço principal.
+static void run_frame(int16_t* decimated, float* band_db, uint frame) {
+    uint32_t t = bench_start();
+    const uint16_t* adc_buffer = mic_wait_ready_buffer();
+    bench_stop(BENCH_MIC_WAIT, t);
+
+    t = bench_start();
+    mic_block_stats_t block;
+    mic_block_stats(adc_buffer, SAMPLES, 1, &block);
+    mic_remove_dc(&block);
+    bench_stop(BENCH_MIC_POWER, t);
+
+    t = bench_start();
+    uint count = mic_decimate(adc_buffer, decimated);
+    bench_stop(BENCH_MIC_DECIMATE, t);
+
+    for (uint i = 0; i < count; i += MIC_DECIMATED_SAMPLES) {
+        t = bench_start();
+        spl_process(&decimated[i], MIC_DECIMATED_SAMPLES);
+        bench_stop(BENCH_SPL, t);
+
+        t = bench_start();
+        if (spectrum_feed(&decimated[i], MIC_DECIMATED_SAMPLES))
+            spectrum_compute(band_db);
+        bench_stop(BENCH_SPECTRUM, t);
+    }
+
+    float db = 50.f + (frame % 40);
+    t = bench_start();
+    update_full_display(&display, db, 1);
+    bench_stop(BENCH_DISPLAY_DRAW, t);
+
+    t = bench_start();
+    ssd1306_update_async(&display);
+    bench_stop(BENCH_SSD1306_UPDATE, t);
+    ssd1306_wait_update(&display);
+
+    t = bench_start();
+    update_led_matrix(db, 1);
+    bench_stop(BENCH_LED_MATRIX, t);
+
+    t = bench_start();
+    npWrite();
+    bench_stop(BENCH_NP_WRITE, t);
+}
+
+// Lê uma linha BENCH,estágio,... do relatório.
+static bool find_stage(const char* report, const char* stage, unsigned* n, unsigned long cycles[3], float us[3]) {
+    char prefix[64];
+    snprintf(prefix, sizeof(prefix), "BENCH,%s,", stage);
+    const char* line = strstr(report, prefix);
+    return line && sscanf(line + strlen(prefix), "%u,%lu,%lu,%lu,%f,%f,%f", n, &cycles[0], &cycles[1], &cycles[2],
+                          &us[0], &us[1], &us[2]) == 7;
+}
+
+// Relatório de BENCH_FRAMES medições de um estágio de 200 us e de BENCH_FRAMES quadros:
+// cabeçalho, uma linha por estágio com o mínimo abaixo da média e do p99 (um único atraso
+// grande do computador pode pôr a média acima do p99) e o estágio conhecido certo em us.
+static void test_report(void) {
+    static int16_t decimated[MIC_DECIMATED_MAX_SAMPLES];
+    float band_db[SPECTRUM_BANDS] = {0};
+    const char* header = "BENCH,stage,n,min_cycles,mean_cycles,p99_cycles,min_us,mean_us,p99_us\n";
+
+    // O relatório vai para um arquivo, como o CSV que o script lê do serial.
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    FILE* report_file = fopen(REPORT_PATH, "w+");
+    dup2(fileno(report_file), STDOUT_FILENO);
+
+    bench_init_core();
+    for (uint frame = 0; frame < BENCH_FRAMES; ++frame) {
+        uint32_t t = bench_start();
+        spin_us(200);
+        bench_stop(BENCH_MIC_WAIT, t);
+    }
+    for (uint frame = 0; frame < BENCH_FRAMES; ++frame)
+        run_frame(decimated, band_db, frame);
+
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    static char report[8192];
+    fseek(report_file, 0, SEEK_SET);
+    size_t length = fread(report, 1, sizeof(report) - 1, report_file);
+    report[length] = '\0';
+    fclose(report_file);
+    unlink(REPORT_PATH);
+    fputs(report, stdout);
+
+    CHECK(strncmp(report, header, strlen(header)) == 0);
+
+    // O menor valor não sofre com as interrupções do computador.
+    unsigned n;
+    unsigned long cycles[3];
+    float us[3];
+    CHECK(find_stage(report, "mic_wait", &n, cycles, us));
+    CHECK_NEAR(us[0], 200.0, 10.0);
+
+    const char* frames = strchr(strstr(report, "BENCH,mic_wait,"), '\n') + 1;
+    for (uint stage = 0; stage < BENCH_STAGES; ++stage) {
+        bool found = find_stage(frames, STAGE_NAMES[stage], &n, cycles, us);
+        CHECK(found);
+        if (!found)
+            continue;
+        CHECK(n == BENCH_FRAMES);
+        CHECK(cycles[0] <= cycles[1] && cycles[0] <= cycles[2]);
+        CHECK_NEAR(us[1], cycles[1] / (clock_get_hz(clk_sys) / 1e6), 0.1);
+    }
+    CHECK(bench_last_us(BENCH_NP_WRITE) < 1000);
+}
+
+int main(void) {
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    dup2(STDERR_FILENO, STDOUT_FILENO); // Mensagens de inicialização do firmware
+    i2c_setup();
+    ssd1306_init(&display, i2c1, 64, 128, FAKE_OLED_ADDR, false);
+    npInit(LED_PIN);
+    mic_init();
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    spl_init(mic_get_decimated_rate());
+    spectrum_init(mic_get_decimated_rate());
+    fake_adc_sine(MIC_CHANNEL, 1000.0, 500.0, ADC_MIDPOINT);
+    mic_start_continuous();
+
+    test_report();
+
+    mic_stop_continuous();
+    return check_report();
+}
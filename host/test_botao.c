@@ -0,0 +1,249 @@
+// Botões: a máquina de estados (botao_fsm.c) com bordas sintéticas e o caminho da
+// interrupção (callbacks_timer.c) com o GPIO e os alarmes do fake HAL: ressaltos, a
+// amostra do alarme, o toque inteiro com as interrupções desligadas e a falta de alarme.
+
+#include "fake_hal.h"
+#include "check.h"
+#include "callbacks_timer.h"
+#include "init_GPIO.h"
+
+#define MS 1000u
+
+// Avança a máquina de 1 em 1 ms até ate_us e devolve o primeiro evento.
+static botao_evento_t fsm_ate(botao_fsm_t* fsm, uint32_t* t, uint32_t ate_us) {
+    botao_evento_t e = BOTAO_NENHUM;
+    while (*t != ate_us) {
+        *t += MS;
+        botao_evento_t agora = botao_fsm_atualiza(fsm, *t);
+        if (e == BOTAO_NENHUM)
+            e = agora;
+    }
+    return e;
+}
+
+// Clique, clique longo (sem esperar soltar) e clique duplo, com o contador perto da volta.
+static void test_fsm_eventos(void) {
+    const uint32_t bases[] = {0, 0xFFFFFFFFu - 500 * MS};
+    for (uint b = 0; b < 2; ++b) {
+        botao_fsm_t fsm;
+        botao_fsm_init(&fsm, false);
+        uint32_t t = bases[b];
+
+        botao_fsm_borda(&fsm, true, t);
+        CHECK(fsm_ate(&fsm, &t, bases[b] + 100 * MS) == BOTAO_NENHUM);
+        botao_fsm_borda(&fsm, false, t);
+        CHECK(fsm_ate(&fsm, &t, bases[b] + 130 * MS) == BOTAO_CLIQUE);
+
+        botao_fsm_borda(&fsm, true, t);
+        CHECK(fsm_ate(&fsm, &t, bases[b] + 130 * MS + BOTAO_LONGO_US + MS) == BOTAO_LONGO);
+        botao_fsm_borda(&fsm, false, t);
+        CHECK(fsm_ate(&fsm, &t, t + 50 * MS) == BOTAO_NENHUM);
+
+        botao_fsm_init(&fsm, true);
+        botao_fsm_borda(&fsm, true, t);
+        CHECK(fsm_ate(&fsm, &t, t + 80 * MS) == BOTAO_NENHUM);
+        botao_fsm_borda(&fsm, false, t);
+        CHECK(fsm_ate(&fsm, &t, t + 120 * MS) == BOTAO_NENHUM); // Espera o segundo clique
+        botao_fsm_borda(&fsm, true, t);
+        CHECK(fsm_ate(&fsm, &t, t + 60 * MS) == BOTAO_NENHUM);
+        botao_fsm_borda(&fsm, false, t);
+        CHECK(fsm_ate(&fsm, &t, t + 50 * MS) == BOTAO_CLIQUE_DUPLO);
+        CHECK(fsm_ate(&fsm, &t, t + BOTAO_DUPLO_US + MS) == BOTAO_NENHUM);
+    }
+}
+
+// Ressaltos mais curtos que a janela não geram eventos; o nível final decide.
+static void test_fsm_ressalto(void) {
+    botao_fsm_t fsm;
+    botao_fsm_init(&fsm, false);
+    uint32_t t = 1000;
+
+    for (uint i = 0; i < 6; ++i)
+        botao_fsm_borda(&fsm, i % 2 == 0, t + i * 2 * MS);
+    CHECK(fsm_ate(&fsm, &t, t + 10 * MS) == BOTAO_NENHUM);
+    CHECK(!fsm.estavel);
+
+    botao_fsm_borda(&fsm, true, t);
+    botao_fsm_borda(&fsm, false, t + 3 * MS);
+    CHECK(fsm_ate(&fsm, &t, t + 100 * MS) == BOTAO_NENHUM);
+    CHECK(!fsm.estavel);
+}
+
+// Pulso: pressionar e soltar numa interrupção só é um clique; no botão com clique duplo,
+// dois pulsos seguidos são um clique duplo; dentro da janela vale como borda comum.
+static void test_fsm_pulso(void) {
+    botao_fsm_t fsm;
+    botao_fsm_init(&fsm, false);
+    uint32_t t = 5000;
+
+    botao_fsm_pulso(&fsm, false, t);
+    CHECK(botao_fsm_atualiza(&fsm, t) == BOTAO_CLIQUE);
+    CHECK(fsm_ate(&fsm, &t, t + 100 * MS) == BOTAO_NENHUM);
+
+    // Pressionado: soltar e pressionar de novo também é um clique.
+    botao_fsm_borda(&fsm, true, t);
+    CHECK(fsm_ate(&fsm, &t, t + 100 * MS) == BOTAO_NENHUM);
+    botao_fsm_pulso(&fsm, true, t);
+    CHECK(botao_fsm_atualiza(&fsm, t) == BOTAO_CLIQUE);
+    CHECK(fsm.estavel);
+    botao_fsm_borda(&fsm, false, t);
+    CHECK(fsm_ate(&fsm, &t, t + 100 * MS) == BOTAO_CLIQUE);
+
+    botao_fsm_init(&fsm, true);
+    botao_fsm_pulso(&fsm, false, t);
+    CHECK(fsm_ate(&fsm, &t, t + 100 * MS) == BOTAO_NENHUM);
+    botao_fsm_pulso(&fsm, false, t);
+    CHECK(botao_fsm_atualiza(&fsm, t) == BOTAO_CLIQUE_DUPLO);
+
+    // Com uma borda ainda na janela, o pulso é ressalto.
+    botao_fsm_init(&fsm, false);
+    botao_fsm_borda(&fsm, true, t);
+    CHECK(fsm_ate(&fsm, &t, t + 2 * MS) == BOTAO_NENHUM);
+    botao_fsm_pulso(&fsm, true, t);
+    CHECK(fsm_ate(&fsm, &t, t + 100 * MS) == BOTAO_NENHUM);
+    CHECK(fsm.estavel);
+}
+
+// A amostra substitui o nível da última borda e recupera bordas perdidas.
+static void test_fsm_amostra(void) {
+    botao_fsm_t fsm;
+    botao_fsm_init(&fsm, false);
+    uint32_t t = 7000;
+
+    botao_fsm_borda(&fsm, false, t); // Lido no meio do ressalto
+    botao_fsm_amostra(&fsm, true, t);
+    CHECK(fsm_ate(&fsm, &t, t + 50 * MS) == BOTAO_NENHUM);
+    CHECK(fsm.estavel);
+
+    // Soltura cuja borda não entrou na fila.
+    botao_fsm_amostra(&fsm, false, t);
+    CHECK(fsm_ate(&fsm, &t, t + 50 * MS) == BOTAO_CLIQUE);
+
+    // Nível igual ao estável e nada pendente: nada muda.
+    botao_fsm_amostra(&fsm, false, t);
+    CHECK(!fsm.pendente);
+}
+
+// Esvazia os eventos dos botões até ate_us, avançando o tempo virtual de 1 em 1 ms.
+static uint eventos_ate(uint64_t ate_us, uint8_t pinos[], botao_evento_t eventos[], uint max) {
+    uint n = 0;
+    while (time_us_64() < ate_us) {
+        fake_advance_us(MS);
+        uint8_t pino;
+        botao_evento_t e;
+        while (botao_proximo_evento(&pino, &e)) {
+            if (n < max) {
+                pinos[n] = pino;
+                eventos[n] = e;
+            }
+            ++n;
+        }
+    }
+    return n;
+}
+
+// Botões com pull-up: pressionado é nível baixo.
+static void pressiona(uint pino, bool pressionado) {
+    fake_gpio_drive(pino, !pressionado);
+}
+
+// Pressão e soltura com ressaltos de 300 us pela interrupção: um clique, e o alarme de
+// cada borda foi cancelado pela seguinte.
+static void test_irq_ressalto(void) {
+    uint8_t pinos[4];
+    botao_evento_t eventos[4];
+
+    for (uint i = 0; i < 5; ++i) {
+        pressiona(BOTAO_B, i % 2 == 0);
+        fake_advance_us(300);
+    }
+    CHECK(fake_alarms_pending() == 1);
+    CHECK(eventos_ate(time_us_64() + 100 * MS, pinos, eventos, 4) == 0);
+    CHECK(fake_alarms_pending() == 0);
+
+    for (uint i = 0; i < 5; ++i) {
+        pressiona(BOTAO_B, i % 2 == 1);
+        fake_advance_us(300);
+    }
+    CHECK(eventos_ate(time_us_64() + 100 * MS, pinos, eventos, 4) == 1);
+    CHECK(pinos[0] == BOTAO_B && eventos[0] == BOTAO_CLIQUE);
+    CHECK(botao_get_perdidos() == 0);
+}
+
+// Toque inteiro com as interrupções desligadas (como durante uma gravação na flash):
+// chega uma interrupção com as duas bordas, e ainda assim é um clique.
+static void test_irq_pulso(void) {
+    uint8_t pinos[4];
+    botao_evento_t eventos[4];
+
+    uint32_t status = save_and_disable_interrupts();
+    pressiona(BOTAO_B, true);
+    fake_advance_us(40 * MS);
+    pressiona(BOTAO_B, false);
+    fake_advance_us(5 * MS);
+    restore_interrupts(status);
+
+    CHECK(eventos_ate(time_us_64() + 100 * MS, pinos, eventos, 4) == 1);
+    CHECK(pinos[0] == BOTAO_B && eventos[0] == BOTAO_CLIQUE);
+
+    // No botão A, dois toques assim são um clique duplo.
+    for (uint i = 0; i < 2; ++i) {
+        status = save_and_disable_interrupts();
+        pressiona(BOTAO_A, true);
+        fake_advance_us(30 * MS);
+        pressiona(BOTAO_A, false);
+        restore_interrupts(status);
+        CHECK(eventos_ate(time_us_64() + 100 * MS, pinos, eventos, 4) == i);
+    }
+    CHECK(pinos[0] == BOTAO_A && eventos[0] == BOTAO_CLIQUE_DUPLO);
+    CHECK(eventos_ate(time_us_64() + BOTAO_DUPLO_US + 50 * MS, pinos, eventos, 4) == 0);
+}
+
+// Com a fila cheia de ressaltos, a soltura se perde; a amostra do alarme a recupera.
+static void test_irq_fila_cheia(void) {
+    uint8_t pinos[4];
+    botao_evento_t eventos[4];
+    uint32_t perdidos = botao_get_perdidos();
+
+    pressiona(BOTAO_B, true);
+    CHECK(eventos_ate(time_us_64() + 100 * MS, pinos, eventos, 4) == 0);
+
+    // Bordas a cada 50 us sem o laço rodar: a fila enche antes do fim.
+    for (uint i = 0; i < BOTAO_FILA_SIZE + 3; ++i) {
+        pressiona(BOTAO_B, i % 2 == 1);
+        fake_advance_us(50);
+    }
+    CHECK(botao_get_perdidos() > perdidos);
+
+    CHECK(eventos_ate(time_us_64() + 100 * MS, pinos, eventos, 4) == 1);
+    CHECK(pinos[0] == BOTAO_B && eventos[0] == BOTAO_CLIQUE);
+}
+
+// Sem alarme livre, o nível lido na interrupção continua valendo.
+static void test_irq_sem_alarme(void) {
+    uint8_t pinos[4];
+    botao_evento_t eventos[4];
+
+    fake_alarm_fail_next(2);
+    pressiona(BOTAO_B, true);
+    CHECK(eventos_ate(time_us_64() + 60 * MS, pinos, eventos, 4) == 0);
+    pressiona(BOTAO_B, false);
+    CHECK(fake_alarms_pending() == 0);
+    CHECK(eventos_ate(time_us_64() + 100 * MS, pinos, eventos, 4) == 1);
+    CHECK(pinos[0] == BOTAO_B && eventos[0] == BOTAO_CLIQUE);
+}
+
+int main(void) {
+    test_fsm_eventos();
+    test_fsm_ressalto();
+    test_fsm_pulso();
+    test_fsm_amostra();
+
+    botao_init(BOTAO_A, true);
+    botao_init(BOTAO_B, false);
+    test_irq_ressalto();
+    test_irq_pulso();
+    test_irq_fila_cheia();
+    test_irq_sem_alarme();
+    return check_report();
+}
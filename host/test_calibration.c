@@ -0,0 +1,145 @@
+// Calibração (calibration.c) com tons sintéticos no ADC do fake HAL, pelo mesmo caminho do
+// laço principal: uma medição corrige o offset, duas com referências distantes definem o
+// ganho, a frequência sai das amostras decimadas, e sinais saturados, instáveis, fora de
+// 1 kHz ou com ganho absurdo são recusados sem mudar os fatores.
+
+#include <math.h>
+#include "fake_hal.h"
+#include "check.h"
+#include "calibration.h"
+#include "mic.h"
+
+// Tom de 1 kHz cuja amplitude muda no meio da medição.
+typedef struct {
+    double amplitude, later_amplitude, change_s;
+} step_tone_t;
+
+static const double PI = 3.14159265358979323846;
+
+static float step_source(uint input, double t_s, void* user) {
+    const step_tone_t* tone = user;
+    (void)input;
+    double amplitude = t_s < tone->change_s ? tone->amplitude : tone->later_amplitude;
+    return (float)(ADC_MIDPOINT + amplitude * sin(2.0 * PI * CALIBRATION_FREQUENCY_HZ * t_s));
+}
+
+// 20·log10 do RMS em volts de um seno com a amplitude dada (contagens).
+static double volts_db(double amplitude) {
+    return 20.0 * log10(amplitude / sqrt(2.0) * ADC_VOLTS_PER_COUNT);
+}
+
+// Pede a calibração e passa blocos como o laço principal até o resultado sair.
+static calibration_result_t calibrate(float reference_db) {
+    static int16_t decimated[MIC_DECIMATED_MAX_SAMPLES];
+    calibration_result_t result = {0};
+
+    calibration_request(reference_db);
+    mic_start_continuous();
+    bool done = false;
+    for (uint n = 0; n < 100000 && !done; ++n) {
+        const uint16_t* adc_buffer = mic_wait_ready_buffer();
+        mic_block_stats_t block;
+        mic_block_stats(mic_channel_samples(adc_buffer, MIC_CHANNEL), SAMPLES, mic_channel_count(), &block);
+        mic_remove_dc(&block);
+        uint count = mic_decimate(adc_buffer, decimated);
+        done = calibration_feed(&block, decimated, count, to_ms_since_boot(get_absolute_time()), &result);
+    }
+    mic_stop_continuous();
+    CHECK(done);
+    return result;
+}
+
+// Aplica os fatores como apply_calibration() em main.c.
+static void apply(const calibration_result_t* result) {
+    if (result->status == CALIBRATION_OK)
+        mic_set_calibration(result->gain, result->offset);
+}
+
+// Uma medição: o ganho fica, o offset leva o tom à referência, e a frequência medida
+// pelas amostras decimadas é a do tom.
+static void test_one_point(void) {
+    const double amplitude = 150.0;
+    fake_adc_sine(MIC_CHANNEL, CALIBRATION_FREQUENCY_HZ, amplitude, ADC_MIDPOINT + 40);
+
+    calibration_result_t result = calibrate(CALIBRATION_REFERENCE_DB);
+    CHECK(result.status == CALIBRATION_OK);
+    CHECK(!result.two_point);
+    CHECK_NEAR(result.gain, MIC_DB_GAIN_DEFAULT, 1e-6);
+    CHECK_NEAR(result.offset, CALIBRATION_REFERENCE_DB - MIC_DB_GAIN_DEFAULT * volts_db(amplitude), 0.02);
+    CHECK_NEAR(result.measured_db, MIC_DB_GAIN_DEFAULT * volts_db(amplitude) + MIC_DB_OFFSET_DEFAULT, 0.02);
+    CHECK_NEAR(result.frequency_hz, CALIBRATION_FREQUENCY_HZ, 1.0);
+    CHECK(result.spread_db < 0.1f);
+    apply(&result);
+
+    // A frequência segue o tom, não a duração da medição em ms.
+    fake_adc_sine(MIC_CHANNEL, 1043.0, amplitude, ADC_MIDPOINT);
+    result = calibrate(CALIBRATION_REFERENCE_DB);
+    CHECK(result.status == CALIBRATION_OK);
+    CHECK_NEAR(result.frequency_hz, 1043.0, 1.0);
+    CHECK_NEAR(result.measured_db, CALIBRATION_REFERENCE_DB, 0.02);
+    apply(&result);
+}
+
+// Recusas: ADC saturado, nível que muda 2,3 dB no meio, tom fora de 1 kHz. Os fatores
+// devolvidos são os atuais.
+static void test_rejections(void) {
+    float gain, offset;
+    mic_get_calibration(&gain, &offset);
+
+    fake_adc_sine(MIC_CHANNEL, CALIBRATION_FREQUENCY_HZ, CALIBRATION_CLIP_COUNTS + 50.0, ADC_MIDPOINT);
+    calibration_result_t result = calibrate(CALIBRATION_REFERENCE_DB);
+    CHECK(result.status == CALIBRATION_CLIPPED);
+    CHECK(result.gain == gain && result.offset == offset);
+
+    // O degrau cai no meio dos 3 s medidos, depois dos 0,5 s de espera.
+    step_tone_t tone = {300.0, 390.0, time_us_64() / 1e6 + (CALIBRATION_SETTLE_MS + CALIBRATION_MEASURE_MS / 2) / 1e3};
+    fake_adc_set_source(MIC_CHANNEL, step_source, &tone);
+    result = calibrate(CALIBRATION_REFERENCE_DB);
+    CHECK(result.status == CALIBRATION_UNSTABLE);
+    CHECK_NEAR(result.spread_db, 20.0 * log10(390.0 / 300.0), 0.2);
+
+    fake_adc_sine(MIC_CHANNEL, 1500.0, 300.0, ADC_MIDPOINT);
+    result = calibrate(CALIBRATION_REFERENCE_DB);
+    CHECK(result.status == CALIBRATION_WRONG_FREQUENCY);
+    CHECK_NEAR(result.frequency_hz, 1500.0, 2.0);
+
+    mic_get_calibration(&gain, &offset);
+    CHECK(result.gain == gain && result.offset == offset);
+}
+
+// Duas medições a 20 dB de distância com o tom só 18 dB mais forte: o ganho é a
+// inclinação da reta pelos dois pontos, e as duas referências caem sobre ela. Depois, um
+// ganho fora de CALIBRATION_GAIN_MIN..MAX é recusado.
+static void test_two_point(void) {
+    const double low = 150.0, high = 1200.0;
+    const float low_db = CALIBRATION_REFERENCE_DB, high_db = CALIBRATION_REFERENCE_DB + 20.f;
+
+    fake_adc_sine(MIC_CHANNEL, CALIBRATION_FREQUENCY_HZ, low, ADC_MIDPOINT);
+    calibration_result_t result = calibrate(low_db);
+    CHECK(result.status == CALIBRATION_OK && !result.two_point);
+    apply(&result);
+
+    fake_adc_sine(MIC_CHANNEL, CALIBRATION_FREQUENCY_HZ, high, ADC_MIDPOINT);
+    result = calibrate(high_db);
+    CHECK(result.status == CALIBRATION_OK && result.two_point);
+    double slope = (high_db - low_db) / (volts_db(high) - volts_db(low));
+    CHECK_NEAR(result.gain, slope, 0.005);
+    CHECK_NEAR(result.gain * volts_db(low) + result.offset, low_db, 0.05);
+    CHECK_NEAR(result.gain * volts_db(high) + result.offset, high_db, 0.05);
+    apply(&result);
+    printf("calibration: dois pontos, ganho %.4f (esperado %.4f), offset %.3f\n", result.gain, slope, result.offset);
+
+    // 20 dB abaixo com o tom quase igual: inclinação muito acima de CALIBRATION_GAIN_MAX.
+    fake_adc_sine(MIC_CHANNEL, CALIBRATION_FREQUENCY_HZ, high * 0.9, ADC_MIDPOINT);
+    calibration_result_t bad = calibrate(low_db);
+    CHECK(bad.status == CALIBRATION_BAD_GAIN);
+    CHECK(bad.gain == result.gain && bad.offset == result.offset);
+}
+
+int main(void) {
+    mic_init();
+    test_one_point();
+    test_rejections();
+    test_two_point();
+    return check_report();
+}
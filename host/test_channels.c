@@ -0,0 +1,130 @@
+// Captura em rodízio (mic_set_channels()) com o ADC e o DMA do fake HAL: cada entrada
+// lida no bloco intercalado por mic_channel_samples() é só dela e contínua entre blocos, e
+// channels.c calcula o nível, a temperatura e a vazão de cada entrada sem copiar o bloco.
+
+#include <math.h>
+#include "fake_hal.h"
+#include "check.h"
+#include "channels.h"
+#include "mic.h"
+
+#define TAG_BITS 9 // Bits do contador de conversões; os de cima identificam a entrada
+
+#define MASK_FOUR ((1u << MIC_EXT_CHANNEL) | (1u << 1) | (1u << MIC_CHANNEL) | (1u << MIC_TEMP_CHANNEL))
+#define MASK_TWO ((1u << MIC_EXT_CHANNEL) | (1u << MIC_CHANNEL))
+
+// Cada conversão lê a própria entrada e o próprio número (módulo 2^TAG_BITS).
+static float tagged_source(uint input, double t_s, void* user) {
+    (void)user;
+    uint64_t n = (uint64_t)llround(t_s * fake_adc_rate());
+    return (float)((input << TAG_BITS) | (n & ((1u << TAG_BITS) - 1)));
+}
+
+static uint tag_input(uint16_t sample) {
+    return sample >> TAG_BITS;
+}
+
+static uint tag_count(uint16_t sample) {
+    return sample & ((1u << TAG_BITS) - 1);
+}
+
+// Blocos intercalados separados por entrada: só amostras da entrada, com o contador
+// avançando de mic_channel_count() em mic_channel_count() dentro e entre os blocos.
+static void check_deinterleave(uint mask) {
+    CHECK(mic_set_channels(mask));
+    CHECK(mic_get_channels() == mask);
+    const uint stride = mic_channel_count();
+    CHECK(stride == (uint)__builtin_popcount(mask));
+
+    for (uint input = 0; input < MIC_INPUTS; ++input)
+        fake_adc_set_source(input, tagged_source, NULL);
+    mic_start_continuous();
+
+    int last[MIC_INPUTS];
+    for (uint input = 0; input < MIC_INPUTS; ++input)
+        last[input] = -1;
+
+    bool own = true, continuous = true;
+    for (uint b = 0; b < 20; ++b) {
+        const uint16_t* block = mic_wait_ready_buffer();
+        for (uint input = 0; input < MIC_INPUTS; ++input) {
+            const uint16_t* samples = mic_channel_samples(block, input);
+            CHECK((samples != NULL) == ((mask >> input) & 1));
+            if (samples == NULL)
+                continue;
+            for (uint i = 0; i < SAMPLES; ++i) {
+                uint16_t sample = samples[i * stride];
+                own = own && tag_input(sample) == input;
+                if (last[input] >= 0)
+                    continuous = continuous && tag_count(sample) == ((uint)last[input] + stride) % (1u << TAG_BITS);
+                last[input] = tag_count(sample);
+            }
+        }
+    }
+    CHECK(own);
+    CHECK(continuous);
+    CHECK(mic_get_overruns() == 0);
+
+    // Com a captura rodando, a máscara não muda.
+    CHECK(!mic_set_channels(1u << MIC_CHANNEL));
+    mic_stop_continuous();
+}
+
+// Duas e quatro entradas, e as máscaras recusadas.
+static void test_deinterleave(void) {
+    check_deinterleave(MASK_TWO);
+    check_deinterleave(MASK_FOUR);
+
+    CHECK(!mic_set_channels(1u << MIC_EXT_CHANNEL)); // Sem o microfone da placa
+    CHECK(!mic_set_channels(MASK_TWO | (1u << MIC_TEMP_CHANNEL))); // Três entradas
+    CHECK(mic_get_channels() == MASK_FOUR);
+}
+
+// Um quadro com quatro entradas: o nível de cada microfone, a temperatura, a vazão por
+// entrada e a escolha do que vai para o display.
+static void test_levels(void) {
+    const double ext_amplitude = 400.0, mic_amplitude = 100.0, temp_counts = 876.0;
+
+    CHECK(mic_set_channels(MASK_FOUR));
+    fake_adc_sine(MIC_EXT_CHANNEL, 1000.0, ext_amplitude, ADC_MIDPOINT + 50);
+    fake_adc_sine(1, 1000.0, 0.0, ADC_MIDPOINT);
+    fake_adc_sine(MIC_CHANNEL, 700.0, mic_amplitude, ADC_MIDPOINT);
+    fake_adc_sine(MIC_TEMP_CHANNEL, 1.0, 0.0, temp_counts);
+
+    mic_start_continuous();
+    channels_init();
+    const uint blocks = 100;
+    for (uint b = 0; b < blocks; ++b) {
+        const uint16_t* block = mic_wait_ready_buffer();
+        mic_block_stats_t mic;
+        mic_block_stats(mic_channel_samples(block, MIC_CHANNEL), SAMPLES, mic_channel_count(), &mic);
+        channels_accumulate(block, &mic);
+    }
+    channels_levels_t levels;
+    channels_close_frame(&levels, time_us_32());
+    mic_stop_continuous();
+
+    float ext_db = mic_rms_to_db(ext_amplitude / sqrt(2.0) * ADC_VOLTS_PER_COUNT);
+    float mic_db = mic_rms_to_db(mic_amplitude / sqrt(2.0) * ADC_VOLTS_PER_COUNT);
+    CHECK_NEAR(levels.db[MIC_EXT_CHANNEL], ext_db, 0.1);
+    CHECK_NEAR(levels.db[MIC_CHANNEL], mic_db, 0.1);
+    CHECK(levels.db[1] < levels.db[MIC_CHANNEL] - 20.f); // Só o ruído de quantização
+    CHECK(levels.db[3] == 0.f);                         // Não capturada
+    CHECK_NEAR(levels.temperature_c, mic_temperature_c(temp_counts), 0.1);
+    CHECK_NEAR(levels.rate, mic_get_sample_rate(), mic_get_sample_rate() * 0.01);
+
+    CHECK(channels_display_db(&levels, CHANNELS_SOURCE_MIC, mic_db) == mic_db);
+    CHECK(channels_display_db(&levels, CHANNELS_SOURCE_EXTERNAL, mic_db) == levels.db[MIC_EXT_CHANNEL]);
+    CHECK(channels_display_db(&levels, CHANNELS_SOURCE_LOUDEST, mic_db) == levels.db[MIC_EXT_CHANNEL]);
+    CHECK(channels_display_db(&levels, CHANNELS_SOURCE_LOUDEST, ext_db + 5.f) == ext_db + 5.f);
+
+    printf("channels: %u amostras/s por entrada, externo %.1f dB, placa %.1f dB, %.1f °C\n", levels.rate,
+           levels.db[MIC_EXT_CHANNEL], levels.db[MIC_CHANNEL], levels.temperature_c);
+}
+
+int main(void) {
+    mic_init();
+    test_deinterleave();
+    test_levels();
+    return check_report();
+}
@@ -0,0 +1,152 @@
+// Rastreador de DC do microfone (mic_remove_dc()): o primeiro bloco inicia o nível, um
+// degrau na polarização é seguido com a constante de 2^MIC_DC_SHIFT blocos, uma deriva
+// lenta não vira nível falso, a saída de mic_decimate() fica sem DC e o custo por bloco
+// não depende do número de amostras.
+
+#include <math.h>
+#include "fake_hal.h"
+#include "check.h"
+#include "mic.h"
+
+#define AMPLITUDE 200.0 // Contagens do ADC
+#define PERIOD 32       // Amostras por período do seno: um número inteiro de períodos por bloco
+#define BENCH_BLOCKS 200000
+
+static const double PI = 3.14159265358979323846;
+static const double SINE_RMS = AMPLITUDE / 1.41421356237309505;
+
+// Bloco com o seno sobre o DC, que vai de dc ao início a dc + slope * SAMPLES no fim.
+static void make_block(uint16_t* block, double dc, double slope) {
+    for (uint i = 0; i < SAMPLES; ++i)
+        block[i] = (uint16_t)lround(ADC_MIDPOINT + dc + slope * i + AMPLITUDE * sin(2.0 * PI * i / PERIOD));
+}
+
+// RMS do bloco em torno do DC rastreado, como o laço principal calcula o nível.
+static double block_rms(const uint16_t* block) {
+    mic_block_stats_t stats;
+    mic_block_stats(block, SAMPLES, 1, &stats);
+    mic_remove_dc(&stats);
+    return sqrt((double)stats.sum_squared / stats.count);
+}
+
+static double db(double ratio) {
+    return 20.0 * log10(ratio);
+}
+
+// O primeiro bloco inicia o rastreador com a própria média: sem rampa desde o ponto médio.
+static void test_first_block(void) {
+    uint16_t block[SAMPLES];
+    make_block(block, 300.0, 0.0);
+    CHECK_NEAR(block_rms(block), SINE_RMS, 0.5);
+    CHECK_NEAR(mic_get_dc_offset(), 300.0, 0.5);
+}
+
+// Degrau de 200 contagens: depois de 2^MIC_DC_SHIFT blocos resta 1/e do degrau, depois de
+// cinco constantes o nível volta ao do seno, e com DC constante o nível é o mesmo em todo
+// bloco (o estado passa de um bloco ao outro sem transitório na borda).
+static void test_step(void) {
+    uint16_t block[SAMPLES];
+    const uint tau = 1u << MIC_DC_SHIFT;
+    const double step = 200.0;
+
+    make_block(block, 300.0 + step, 0.0);
+    double first = block_rms(block);
+    CHECK(first > sqrt(SINE_RMS * SINE_RMS + 0.9 * step * step));
+    for (uint n = 1; n < tau; ++n)
+        block_rms(block);
+    double remaining = (300.0 + step - mic_get_dc_offset()) / step;
+    CHECK_NEAR(remaining, exp(-1.0), 0.01);
+
+    for (uint n = tau; n < 5 * tau; ++n)
+        block_rms(block);
+    double settled = block_rms(block);
+    CHECK_NEAR(db(settled / SINE_RMS), 0.0, 0.05);
+
+    double low = settled, high = settled;
+    for (uint n = 0; n < 100; ++n) {
+        double rms = block_rms(block);
+        low = fmin(low, rms);
+        high = fmax(high, rms);
+    }
+    CHECK(high - low < 0.05);
+    printf("dc: degrau de %.0f contagens, primeiro bloco %+.2f dB, restante após %u blocos %.3f, "
+           "após %u blocos %+.3f dB\n",
+           step, db(first / SINE_RMS), tau, remaining, 5 * tau, db(settled / SINE_RMS));
+}
+
+// Deriva de 100 contagens em 2 s (~40 mV/s, bem acima da térmica): o rastreador fica
+// algumas contagens atrás e o nível erra menos de 0,05 dB; com o ponto médio fixo, o DC
+// inteiro viraria nível.
+static void test_drift(void) {
+    uint16_t block[SAMPLES];
+    const double blocks_per_s = mic_get_sample_rate() / SAMPLES;
+    const uint blocks = (uint)(2.0 * blocks_per_s);
+    const double slope = 100.0 / (blocks * (double)SAMPLES); // Contagens por amostra
+
+    double dc = 500.0, worst = 0.0;
+    for (uint n = 0; n < blocks; ++n, dc += slope * SAMPLES) {
+        make_block(block, dc, slope);
+        worst = fmax(worst, fabs(db(block_rms(block) / SINE_RMS)));
+    }
+    double fixed = db(sqrt(SINE_RMS * SINE_RMS + dc * dc) / SINE_RMS);
+    CHECK(worst < 0.05);
+    CHECK_NEAR(mic_get_dc_offset(), dc, 100.0 / blocks * (1u << MIC_DC_SHIFT) + 1.0);
+    printf("dc: deriva de 100 contagens em 2 s, pior erro %.3f dB (ponto médio fixo: %+.1f dB)\n", worst, fixed);
+}
+
+// mic_decimate() subtrai o mesmo nível: a média da saída fica perto de zero.
+static void test_decimate_mean(void) {
+    static uint16_t block[SAMPLES];
+    static int16_t out[MIC_DECIMATED_MAX_SAMPLES];
+
+    double sum = 0.0;
+    uint total = 0;
+    for (uint n = 0; n < 64; ++n) {
+        make_block(block, mic_get_dc_offset(), 0.0);
+        block_rms(block);
+        uint count = mic_decimate(block, out);
+        for (uint i = 0; n >= 4 && i < count; ++i, ++total)
+            sum += out[i];
+    }
+    CHECK_NEAR(sum / total / (1 << MIC_DECIMATED_FRAC_BITS), 0.0, 0.5);
+}
+
+// Tempo por bloco: as estatísticas (por amostra) contra a correção (uma vez por bloco).
+static void bench_remove_dc(void) {
+    static uint16_t blocks[8][SAMPLES];
+    for (uint b = 0; b < 8; ++b)
+        make_block(blocks[b], 300.0 + b, 0.0);
+
+    volatile uint64_t sink = 0;
+    mic_block_stats_t stats;
+    uint64_t start = check_now_ns();
+    for (uint n = 0; n < BENCH_BLOCKS; ++n) {
+        mic_block_stats(blocks[n & 7], SAMPLES, 1, &stats);
+        sink += stats.sum_squared;
+    }
+    uint64_t stats_ns = check_now_ns() - start;
+    check_bench("dc_block_stats", BENCH_BLOCKS, stats_ns);
+
+    mic_block_stats(blocks[0], SAMPLES, 1, &stats);
+    start = check_now_ns();
+    for (uint n = 0; n < BENCH_BLOCKS; ++n) {
+        mic_block_stats_t copy = stats;
+        mic_remove_dc(&copy);
+        sink += copy.sum_squared;
+    }
+    uint64_t remove_ns = check_now_ns() - start;
+    check_bench("dc_remove_dc", BENCH_BLOCKS, remove_ns);
+    (void)sink;
+
+    CHECK(remove_ns < stats_ns);
+}
+
+int main(void) {
+    mic_init();
+    test_first_block();
+    test_step();
+    test_drift();
+    test_decimate_mean();
+    bench_remove_dc();
+    return check_report();
+}
@@ -0,0 +1,197 @@
+// Confere o próprio fake HAL com os módulos do firmware: captura contínua pelo DMA,
+// replay de WAV, tráfego do display até a imagem PBM, alarmes, bordas do GPIO e a flash.
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "fake_hal.h"
+#include "check.h"
+#include "mic.h"
+#include "ssd1306.h"
+#include "flash_store.h"
+
+// Captura contínua: o intervalo entre blocos é o do ADC e nenhum bloco é perdido.
+static void test_continuous_capture(void) {
+    mic_init();
+    fake_adc_sine(MIC_CHANNEL, 1000.0, 500.0, ADC_MIDPOINT);
+    mic_start_continuous();
+
+    uint32_t start = time_us_32();
+    for (int i = 0; i < 100; ++i) {
+        const uint16_t* block = mic_wait_ready_buffer();
+        CHECK(block != NULL);
+    }
+    double block_us = (time_us_32() - start) / 100.0;
+    CHECK_NEAR(block_us, SAMPLES * 1e6 / mic_get_sample_rate(), 1.0);
+    CHECK(mic_get_overruns() == 0);
+
+    // Um bloco a mais sem consumir: overrun.
+    fake_advance_us(2.5 * block_us);
+    CHECK(mic_wait_ready_buffer() != NULL);
+    CHECK(mic_get_overruns() == 1);
+
+    // O bloco contém o seno: extremos perto de ±500 contagens.
+    mic_block_stats_t stats;
+    mic_block_stats(mic_wait_ready_buffer(), SAMPLES, 1, &stats);
+    CHECK(stats.max > 450 && stats.max <= 500);
+    CHECK(stats.min < -450 && stats.min >= -500);
+    mic_stop_continuous();
+}
+
+static void write_le(FILE* f, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i)
+        fputc((value >> (8 * i)) & 0xff, f);
+}
+
+// WAV de 16 bits com uma rampa: a leitura do ADC segue o arquivo com interpolação.
+static void test_wav_replay(void) {
+    const char* path = "test_host_ramp.wav";
+    FILE* f = fopen(path, "wb");
+    uint32_t samples = 8000, rate = 8000;
+    fputs("RIFF", f);
+    write_le(f, 36 + samples * 2, 4);
+    fputs("WAVEfmt ", f);
+    write_le(f, 16, 4);
+    write_le(f, 1, 2);
+    write_le(f, 1, 2);
+    write_le(f, rate, 4);
+    write_le(f, rate * 2, 4);
+    write_le(f, 2, 2);
+    write_le(f, 16, 2);
+    fputs("data", f);
+    write_le(f, samples * 2, 4);
+    for (uint32_t i = 0; i < samples; ++i)
+        write_le(f, (uint16_t)(int16_t)(i * 4), 2);
+    fclose(f);
+
+    CHECK_NEAR(fake_adc_play_file(MIC_CHANNEL, path, 0, 2048.0, 1000.0, false), 1.0, 1e-9);
+    adc_select_input(MIC_CHANNEL);
+    fake_advance_us(500000); // Metade do arquivo: amostra 4000, valor 16000/32768
+    CHECK_NEAR(adc_read(), 1000.0 + 2048.0 * 16000 / 32768, 1.0);
+    fake_advance_us(600000); // Depois do fim: só o nível DC
+    CHECK(adc_read() == 1000);
+    CHECK(fake_adc_play_file(MIC_CHANNEL, "nao_existe.wav", 0, 1.0, 0.0, false) < 0);
+    unlink(path);
+}
+
+// Texto no display: o que chega ao painel pelo DMA do I2C é o framebuffer.
+static void test_display(void) {
+    i2c_init(i2c1, 400 * 1000);
+    fake_i2c_clear();
+
+    ssd1306_t display;
+    ssd1306_init(&display, i2c1, 64, 128, FAKE_OLED_ADDR, false);
+    CHECK(fake_oled()->on);
+    CHECK(fake_oled()->contrast == 0xff);
+    CHECK(fake_i2c_transactions() >= 2); // Comandos de inicialização e o quadro apagado
+
+    ssd1306_draw_string(&display, "TESTE", 10, 10);
+    ssd1306_update(&display);
+    CHECK(memcmp(fake_oled()->ram, display.buffer, sizeof(fake_oled()->ram)) == 0);
+    CHECK(fake_oled_write_pbm("test_host_oled.pbm"));
+
+    // Cabeçalho P4 e 128 x 64 bits.
+    FILE* f = fopen("test_host_oled.pbm", "rb");
+    char header[16] = {0};
+    CHECK(fread(header, 1, 10, f) == 10 && !strcmp(header, "P4\n128 64\n"));
+    fseek(f, 0, SEEK_END);
+    CHECK(ftell(f) == 10 + 128 * 64 / 8);
+    fclose(f);
+    unlink("test_host_oled.pbm");
+    ssd1306_deinit(&display);
+}
+
+static int alarm_calls;
+
+static int64_t alarm_callback(alarm_id_t id, void* user_data) {
+    ++alarm_calls;
+    return alarm_calls < 3 ? 1000 : 0; // Repete duas vezes, 1 ms depois do prazo anterior
+}
+
+// Alarmes disparam no prazo e ficam pendentes com as interrupções desligadas.
+static void test_alarms(void) {
+    uint32_t start = time_us_32();
+    CHECK(add_alarm_in_us(500, alarm_callback, NULL, true) > 0);
+    fake_advance_us(499);
+    CHECK(alarm_calls == 0);
+    fake_advance_us(1);
+    CHECK(alarm_calls == 1);
+
+    uint32_t status = save_and_disable_interrupts();
+    fake_advance_us(5000);
+    CHECK(alarm_calls == 1);
+    restore_interrupts(status);
+    CHECK(alarm_calls == 3);
+    CHECK(fake_alarms_pending() == 0);
+    CHECK(time_us_32() - start == 5500);
+
+    fake_alarm_fail_next(1);
+    CHECK(add_alarm_in_us(10, alarm_callback, NULL, true) < 0);
+}
+
+static uint32_t gpio_events[4];
+static int gpio_calls;
+
+static void gpio_callback(uint gpio, uint32_t events) {
+    gpio_events[gpio_calls++ % 4] = events;
+}
+
+// Duas bordas com as interrupções desligadas chegam num só evento, como na placa.
+static void test_gpio(void) {
+    gpio_init(5);
+    gpio_pull_up(5);
+    gpio_set_irq_enabled_with_callback(5, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, gpio_callback);
+    CHECK(gpio_get(5));
+
+    fake_gpio_drive(5, false);
+    CHECK(gpio_calls == 1 && gpio_events[0] == GPIO_IRQ_EDGE_FALL);
+
+    uint32_t status = save_and_disable_interrupts();
+    fake_gpio_drive(5, true);
+    fake_gpio_drive(5, false);
+    CHECK(gpio_calls == 1);
+    restore_interrupts(status);
+    CHECK(gpio_calls == 2 && gpio_events[1] == (GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE));
+    CHECK(!gpio_get(5));
+}
+
+// Apagar e gravar param o núcleo pelo tempo da flash; uma queda de energia deixa a página pela metade.
+static void test_flash(void) {
+    uint32_t offset = FLASH_RECORDER_OFFSET;
+    uint8_t page[FLASH_PAGE_SIZE];
+    memset(page, 0x5a, sizeof(page));
+
+    uint32_t start = time_us_32();
+    CHECK(flash_store_erase(offset, FLASH_SECTOR_SIZE));
+    CHECK(time_us_32() - start == FAKE_FLASH_ERASE_US);
+    CHECK(flash_store_program(offset, page, sizeof(page)));
+    CHECK(memcmp(flash_store_ptr(offset), page, sizeof(page)) == 0);
+
+    fake_flash_fail_next(1);
+    CHECK(!flash_store_erase(offset, FLASH_SECTOR_SIZE));
+    CHECK(flash_store_ptr(offset)[0] == 0x5a);
+
+    pid_t child = fork();
+    if (child == 0) {
+        fake_flash_power_cut_after(1); // Apaga o setor e corta no meio da página
+        flash_store_erase(offset, FLASH_SECTOR_SIZE);
+        flash_store_program(offset, page, sizeof(page));
+        _exit(0);
+    }
+    int status;
+    waitpid(child, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == FAKE_POWER_CUT_EXIT);
+    CHECK(flash_store_ptr(offset)[0] == 0x5a);
+    CHECK(flash_store_ptr(offset)[FLASH_PAGE_SIZE - 1] == 0xff);
+}
+
+int main(void) {
+    test_continuous_capture();
+    test_wav_replay();
+    test_display();
+    test_alarms();
+    test_gpio();
+    test_flash();
+    return check_report();
+}
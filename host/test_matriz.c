@@ -0,0 +1,162 @@
+// Matriz de LEDs (MatrizLED.c) contra a PIO do fake HAL: quadros enviados por DMA,
+// quadro novo durante o envio, a falta de alarme para o reset, os bits na linha comparados
+// com o envio byte a byte original e a serpentina comparada com o diagrama.
+
+#include <string.h>
+#include "fake_hal.h"
+#include "check.h"
+#include "matrizLED.h"
+
+// Envio de um quadro mais o reset dos WS2812.
+#define NP_LATCH_US ((LED_COUNT * 24 * 5) / 4 + 100)
+
+extern npLED_t leds[LED_COUNT];
+void npInit(uint pin);
+
+// Diagrama de MatrizLED.c como impresso: linha 4 no alto, x = 0 na coluna da direita.
+static const uint8_t DIAGRAM[5][5] = {
+    {24, 23, 22, 21, 20},
+    {15, 16, 17, 18, 19},
+    {14, 13, 12, 11, 10},
+    { 5,  6,  7,  8,  9},
+    { 4,  3,  2,  1,  0},
+};
+
+// Números da versão original de setLEDnumber(), [número][y] com x da esquerda para a direita da string.
+static const char* ORIGINAL_DIGITS[10][5] = {
+    {"11111", "10001", "10001", "10001", "11111"}, {"01110", "00100", "00100", "00110", "00100"},
+    {"11111", "00001", "11111", "10000", "11111"}, {"11111", "10000", "11110", "10000", "11111"},
+    {"01000", "01000", "11111", "01001", "01001"}, {"11111", "10000", "11111", "00001", "11111"},
+    {"11111", "10001", "11111", "00001", "11111"}, {"00010", "00100", "01000", "10000", "11111"},
+    {"11111", "10001", "11111", "10001", "11111"}, {"11111", "10000", "11111", "10001", "11111"},
+};
+
+// getIndex() original: linhas pares seguem x, ímpares voltam.
+static int original_index(int x, int y) {
+    return y % 2 == 0 ? y * 5 + x : y * 5 + (4 - x);
+}
+
+// Bits na linha de dados, na ordem em que a PIO os envia: deslocamento para a direita,
+// bits_per_word bits de cada palavra.
+static size_t wire_bits(const uint32_t* words, size_t count, uint bits_per_word, uint8_t* bits) {
+    size_t n = 0;
+    for (size_t i = 0; i < count; ++i)
+        for (uint b = 0; b < bits_per_word; ++b)
+            bits[n++] = (words[i] >> b) & 1;
+    return n;
+}
+
+static size_t frame_words(void) {
+    size_t count;
+    fake_pio_words(pio0, 0, &count);
+    return count;
+}
+
+static uint32_t word_at(size_t index) {
+    size_t count;
+    return fake_pio_words(pio0, 0, &count)[index];
+}
+
+// Quadros escritos durante o envio esperam o reset, e só o último sai.
+static void test_pending_frame(void) {
+    fake_pio_clear();
+    npClear();
+    npSetLED(0, 1, 2, 3);
+    npWrite();
+    CHECK(frame_words() == LED_COUNT);
+    CHECK(fake_alarms_pending() == 1);
+
+    npSetLED(0, 4, 5, 6);
+    npWrite();
+    npSetLED(0, 7, 8, 9);
+    npWrite();
+    CHECK(frame_words() == LED_COUNT);
+
+    fake_advance_us(NP_LATCH_US);
+    CHECK(frame_words() == 2 * LED_COUNT);
+    CHECK(word_at(LED_COUNT) == (8 | 7 << 8 | 9 << 16));
+
+    fake_advance_us(NP_LATCH_US);
+    CHECK(fake_alarms_pending() == 0);
+}
+
+// Sem alarme livre, npWrite() espera o reset e a matriz continua aceitando quadros.
+static void test_alarm_failure(void) {
+    fake_pio_clear();
+    fake_alarm_fail_next(1);
+    uint32_t start = time_us_32();
+    npWrite();
+    CHECK(frame_words() == LED_COUNT);
+    CHECK(time_us_32() - start >= NP_LATCH_US);
+    CHECK(fake_alarms_pending() == 0);
+
+    npSetLED(24, 10, 20, 30);
+    npWrite();
+    CHECK(frame_words() == 2 * LED_COUNT);
+    CHECK(word_at(2 * LED_COUNT - 1) == (20 | 10 << 8 | 30 << 16));
+    fake_advance_us(NP_LATCH_US);
+}
+
+// A tabela da serpentina é o diagrama e a conta original.
+static void test_serpentine(void) {
+    for (int y = 0; y < 5; ++y) {
+        for (int x = 0; x < 5; ++x) {
+            CHECK(getIndex(x, y) == DIAGRAM[4 - y][4 - x]);
+            CHECK(getIndex(x, y) == original_index(x, y));
+
+            npClear();
+            setLEDxy(x, y, 1, 1, 1); // Coluna, linha
+            CHECK(leds[DIAGRAM[4 - y][4 - x]].R == 1);
+        }
+    }
+}
+
+// Cada quadro sai com os mesmos bits que três palavras de 8 bits por LED (G, R, B) produziam,
+// e os números acendem os mesmos LEDs que antes.
+static void test_packing_and_digits(void) {
+    static uint32_t original_words[3 * LED_COUNT];
+    static uint8_t bits[24 * LED_COUNT], original_bits[24 * LED_COUNT];
+
+    for (int number = 0; number < 10; ++number) {
+        fake_pio_clear();
+        setLEDnumber(number, 0x12, 0x34, 0x56);
+        fake_advance_us(NP_LATCH_US);
+
+        npLED_t expected[LED_COUNT];
+        memset(expected, 0, sizeof(expected));
+        for (int y = 0; y < 5; ++y)
+            for (int x = 0; x < 5; ++x)
+                if (ORIGINAL_DIGITS[number][y][x] == '1')
+                    expected[original_index(x, y)] = (npLED_t){.G = 0x34, .R = 0x12, .B = 0x56};
+        CHECK(memcmp(leds, expected, sizeof(expected)) == 0);
+
+        for (uint i = 0; i < LED_COUNT; ++i) {
+            original_words[3 * i] = expected[i].G;
+            original_words[3 * i + 1] = expected[i].R;
+            original_words[3 * i + 2] = expected[i].B;
+        }
+        size_t count;
+        const uint32_t* words = fake_pio_words(pio0, 0, &count);
+        CHECK(count == LED_COUNT);
+        CHECK(wire_bits(words, count, 24, bits) == sizeof(bits));
+        wire_bits(original_words, 3 * LED_COUNT, 8, original_bits);
+        CHECK(memcmp(bits, original_bits, sizeof(bits)) == 0);
+    }
+
+    // Fora de 0-9: nada muda e nada é enviado.
+    fake_pio_clear();
+    setLEDnumber(10, 1, 1, 1);
+    setLEDnumber(-1, 1, 1, 1);
+    size_t count;
+    fake_pio_words(pio0, 0, &count);
+    CHECK(count == 0);
+}
+
+int main(void) {
+    npInit(LED_PIN);
+    test_pending_frame();
+    test_alarm_failure();
+    test_serpentine();
+    test_packing_and_digits();
+    return check_report();
+}
@@ -0,0 +1,124 @@
+// Fila de medições entre os núcleos (pipeline.c): ordem, descarte com a fila cheia,
+// medições puladas pelo consumidor e, com duas threads, nenhuma medição lida pela metade.
+
+#include <pthread.h>
+#include <sched.h>
+#include "fake_hal.h"
+#include "check.h"
+#include "pipeline.h"
+
+#define STRESS_MEASUREMENTS 200000u
+
+// Todos os campos derivados do mesmo número: uma cópia rasgada não bate.
+static void fill(measurement_t* m, uint32_t n) {
+    m->timestamp_ms = n;
+    m->rms = (float)(n & 0xffff);
+    m->db = (float)(n & 0xff);
+    m->spl.laf = (float)(n & 0xfff);
+    m->sensitivity = n & 0x7f;
+    for (int b = 0; b < SPECTRUM_BANDS; ++b)
+        m->band_db[b] = (float)((n + b) & 0xffff);
+}
+
+static bool consistent(const measurement_t* m) {
+    uint32_t n = m->timestamp_ms;
+    bool ok = m->rms == (float)(n & 0xffff) && m->db == (float)(n & 0xff) && m->spl.laf == (float)(n & 0xfff) &&
+              m->sensitivity == (n & 0x7f);
+    for (int b = 0; b < SPECTRUM_BANDS; ++b)
+        ok = ok && m->band_db[b] == (float)((n + b) & 0xffff);
+    return ok;
+}
+
+// Um núcleo só: a mais recente é entregue, as anteriores contam como puladas e a fila cheia descarta.
+static void test_single_core(void) {
+    pipeline_init();
+    measurement_t m;
+    pipeline_stats_t stats;
+    CHECK(!pipeline_pop_latest(&m));
+
+    uint32_t sev = fake_sev_count();
+    for (uint32_t n = 0; n < 3; ++n) {
+        fill(&m, n);
+        CHECK(pipeline_push(&m));
+    }
+    CHECK(fake_sev_count() == sev + 3); // Cada medição acorda o núcleo 1
+    CHECK(pipeline_pop_latest(&m) && m.timestamp_ms == 2 && consistent(&m));
+    CHECK(!pipeline_pop_latest(&m));
+    pipeline_get_stats(&stats);
+    CHECK(stats.pushed == 3 && stats.skipped == 2 && stats.occupancy == 0 && stats.max_occupancy == 3);
+
+    // Consumidor parado: PIPELINE_QUEUE_SIZE cabem, as seguintes são descartadas.
+    for (uint32_t n = 10; n < 10 + PIPELINE_QUEUE_SIZE + 2; ++n) {
+        fill(&m, n);
+        CHECK(pipeline_push(&m) == (n < 10 + PIPELINE_QUEUE_SIZE));
+    }
+    pipeline_get_stats(&stats);
+    CHECK(stats.dropped == 2 && stats.occupancy == PIPELINE_QUEUE_SIZE && stats.max_occupancy == PIPELINE_QUEUE_SIZE);
+    CHECK(pipeline_pop_latest(&m) && m.timestamp_ms == 10 + PIPELINE_QUEUE_SIZE - 1);
+
+    // Os índices passam por várias voltas do buffer sem perder a posição.
+    for (uint32_t n = 100; n < 100 + 5 * PIPELINE_QUEUE_SIZE + 3; ++n) {
+        fill(&m, n);
+        CHECK(pipeline_push(&m));
+        CHECK(pipeline_pop_latest(&m) && m.timestamp_ms == n && consistent(&m));
+    }
+}
+
+static volatile bool producer_done;
+
+static void* producer(void* arg) {
+    measurement_t m;
+    for (uint32_t n = 1; n <= STRESS_MEASUREMENTS; ++n) {
+        fill(&m, n);
+        while (!pipeline_push(&m)) // Fila cheia: tenta de novo depois de ceder a vez ao consumidor
+            sched_yield();
+    }
+    __atomic_store_n(&producer_done, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// Produtor e consumidor em threads: toda medição lida está inteira, em ordem, e as contas fecham.
+// O produtor insiste quando a fila enche, para os dois lados se cruzarem o tempo todo.
+static void test_two_threads(void) {
+    pipeline_init();
+    producer_done = false;
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, producer, NULL);
+
+    uint32_t consumed = 0, last = 0, torn = 0, out_of_order = 0;
+    measurement_t m;
+    for (;;) {
+        bool done = __atomic_load_n(&producer_done, __ATOMIC_ACQUIRE);
+        if (pipeline_pop_latest(&m)) {
+            ++consumed;
+            if (!consistent(&m))
+                ++torn;
+            if (m.timestamp_ms <= last)
+                ++out_of_order;
+            last = m.timestamp_ms;
+        } else if (done) {
+            break;
+        } else {
+            sched_yield(); // Com uma CPU só, o produtor precisa rodar para a fila andar
+        }
+    }
+    pthread_join(thread, NULL);
+
+    CHECK(torn == 0);
+    CHECK(out_of_order == 0);
+    pipeline_stats_t stats;
+    pipeline_get_stats(&stats);
+    CHECK(stats.pushed == STRESS_MEASUREMENTS);
+    CHECK(last == STRESS_MEASUREMENTS);
+    CHECK(stats.pushed == consumed + stats.skipped);
+    CHECK(stats.occupancy == 0);
+    CHECK(stats.max_occupancy <= PIPELINE_QUEUE_SIZE);
+    printf("pipeline: %u consumidas, %u puladas, %u recusadas\n", consumed, stats.skipped, stats.dropped);
+}
+
+int main(void) {
+    test_single_core();
+    test_two_threads();
+    return check_report();
+}
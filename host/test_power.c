@@ -0,0 +1,135 @@
+// Estados de energia (power.c): a troca do clk_sys pedida pelo núcleo 0 só acontece com o
+// I2C e a PIO parados, e sai com o baud do I2C e o divisor da PIO recalculados; e uma
+// hora simulada de ruído e silêncio, com o tempo em cada estado impresso como relatório.
+
+#include <unistd.h>
+#include "fake_hal.h"
+#include "check.h"
+#include "init_GPIO.h"
+#include "matrizLED.h"
+#include "mic.h"
+#include "power.h"
+#include "ssd1306.h"
+
+#define MS 1000u
+#define BLOCK_MS 100u
+// Envio de um quadro da matriz mais o reset dos WS2812.
+#define NP_LATCH_US ((LED_COUNT * 24 * 5) / 4 + 100)
+
+extern ssd1306_t display;
+void i2c_setup(void);
+void npInit(uint pin);
+
+static uint32_t now_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+// O que o laço do núcleo 1 faz a cada volta.
+static void core1_step(void) {
+    if (power_clock_pending() && ssd1306_update_done(&display) && npIdle())
+        power_apply_clock();
+}
+
+// Divisor da PIO que mantém NP_BIT_FREQ com o clk_sys atual.
+static float expected_clkdiv(void) {
+    return clock_get_hz(clk_sys) / (10.f * NP_BIT_FREQ);
+}
+
+// Silêncio até IDLE com um envio ao display e um quadro da matriz em andamento: o clock
+// só muda quando os dois terminam, e o SCL e os bits dos WS2812 continuam na frequência certa.
+static void test_handshake(void) {
+    uint32_t active_hz = clock_get_hz(clk_sys);
+    uint32_t changes = fake_clock_changes();
+    uint32_t t = now_ms();
+
+    power_wake(t);
+    CHECK(power_update(false, t + POWER_IDLE_AFTER_MS) == POWER_IDLE);
+    CHECK(power_clock_pending());
+
+    ssd1306_draw_line(&display, 0, 0, 127, 63);
+    ssd1306_update_async(&display);
+    npSetLED(0, 1, 1, 1);
+    npWrite();
+    core1_step();
+    CHECK(clock_get_hz(clk_sys) == active_hz && fake_clock_changes() == changes);
+
+    ssd1306_wait_update(&display);
+    core1_step();
+    CHECK(power_clock_pending()); // A matriz ainda está no reset.
+
+    fake_advance_us(NP_LATCH_US);
+    core1_step();
+    CHECK(!power_clock_pending());
+    CHECK(clock_get_hz(clk_sys) == POWER_IDLE_SYS_HZ);
+    CHECK(fake_i2c_scl_hz(I2C_PORT) == I2C_BAUDRATE);
+    CHECK_NEAR(fake_pio_clkdiv(pio0, 0), expected_clkdiv(), 1e-3);
+
+    // Um botão acorda: o clock volta e os divisores acompanham.
+    power_wake(now_ms());
+    CHECK(power_clock_pending());
+    core1_step();
+    CHECK(clock_get_hz(clk_sys) == active_hz);
+    CHECK(fake_i2c_scl_hz(I2C_PORT) == I2C_BAUDRATE);
+    CHECK_NEAR(fake_pio_clkdiv(pio0, 0), expected_clkdiv(), 1e-3);
+    CHECK(fake_clock_changes() == changes + 2);
+}
+
+// Uma hora em blocos de 100 ms: 10 min de ruído, 20 de silêncio, 5 de ruído e 25 de
+// silêncio. Cada silêncio fica 30 s em ACTIVE, 90 s em QUIET e o resto em IDLE.
+static void test_simulated_hour(void) {
+    static const struct {
+        bool loud;
+        uint32_t minutes;
+    } schedule[] = {{true, 10}, {false, 20}, {true, 5}, {false, 25}};
+
+    uint32_t before[POWER_STATES], after[POWER_STATES];
+    uint32_t clock_changes = fake_clock_changes();
+    power_wake(now_ms());
+    power_get_residency(before);
+
+    uint32_t quiet_runs = 0;
+    for (uint i = 0; i < count_of(schedule); ++i) {
+        for (uint32_t ms = 0; ms < schedule[i].minutes * 60000; ms += BLOCK_MS) {
+            fake_advance_us(BLOCK_MS * MS);
+            power_update(schedule[i].loud, now_ms());
+            core1_step();
+        }
+        quiet_runs += !schedule[i].loud;
+    }
+    power_get_residency(after);
+
+    uint32_t active = after[POWER_ACTIVE] - before[POWER_ACTIVE];
+    uint32_t quiet = after[POWER_QUIET] - before[POWER_QUIET];
+    uint32_t idle = after[POWER_IDLE] - before[POWER_IDLE];
+    uint32_t quiet_span = POWER_IDLE_AFTER_MS - POWER_QUIET_AFTER_MS;
+    CHECK_NEAR(active, (10 + 5) * 60000 + quiet_runs * POWER_QUIET_AFTER_MS, 2 * BLOCK_MS);
+    CHECK_NEAR(quiet, quiet_runs * quiet_span, 2 * BLOCK_MS);
+    CHECK_NEAR(idle, (20 + 25) * 60000 - quiet_runs * POWER_IDLE_AFTER_MS, 2 * BLOCK_MS);
+    CHECK(active + quiet + idle == 60 * 60000);
+
+    // Um IDLE no meio (entra e sai) e outro no fim (só entra).
+    CHECK(fake_clock_changes() - clock_changes == 3);
+    CHECK(clock_get_hz(clk_sys) == POWER_IDLE_SYS_HZ);
+
+    printf("POWER_HOST,%u,%u,%u\n", active, quiet, idle);
+    power_print_residency();
+}
+
+int main(void) {
+    // Mensagens de inicialização do firmware vão para stderr.
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+    power_init();
+    i2c_setup();
+    ssd1306_init(&display, I2C_PORT, 64, 128, FAKE_OLED_ADDR, false);
+    npInit(LED_PIN);
+    mic_init();
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    test_handshake();
+    test_simulated_hour();
+    return check_report();
+}
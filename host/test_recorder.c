@@ -0,0 +1,289 @@
+// Gravador de eventos (recorder.c) com a flash do fake HAL: o trecho gravado com o
+// cabeçalho por último, o CRC das amostras conferido no envio, a volta pelas posições com o
+// índice refeito no boot, a queda de energia no meio da gravação e os blocos do ADC
+// perdidos enquanto um apagamento deixa o núcleo 0 parado.
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "fake_hal.h"
+#include "check.h"
+#include "crc.h"
+#include "flash_store.h"
+#include "mic.h"
+#include "recorder.h"
+
+#define CAPTURE_PATH "test_recorder_out.txt"
+#define POST_SAMPLES (RECORDER_SNIPPET_SAMPLES - RECORDER_PRE_SAMPLES)
+#define SLOT_SECTORS (RECORDER_SLOT_SIZE / FLASH_SECTOR_SIZE)
+
+// Layout do cabeçalho gravado por recorder.c na primeira página de cada posição.
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t timestamp_ms;
+    float peak_db;
+    uint32_t sample_rate;
+    uint32_t samples;
+    uint32_t pre_samples;
+    uint32_t data_crc;
+    uint32_t header_crc;
+} event_header_t;
+
+static float rate;
+static uint32_t next_sample; // Número da próxima amostra entregue ao gravador
+static uint32_t now_ms;
+
+static uint32_t slot_offset(uint slot) {
+    return FLASH_RECORDER_OFFSET + slot * RECORDER_SLOT_SIZE;
+}
+
+static const event_header_t* slot_header(uint slot) {
+    return (const event_header_t*)flash_store_ptr(slot_offset(slot));
+}
+
+static const int16_t* slot_samples(uint slot) {
+    return (const int16_t*)flash_store_ptr(slot_offset(slot) + FLASH_PAGE_SIZE);
+}
+
+// Entrega count amostras numeradas em blocos de MIC_DECIMATED_SAMPLES.
+static void feed(uint count) {
+    int16_t block[MIC_DECIMATED_SAMPLES];
+    for (uint done = 0; done < count; done += MIC_DECIMATED_SAMPLES) {
+        for (uint i = 0; i < MIC_DECIMATED_SAMPLES; ++i)
+            block[i] = (int16_t)(next_sample + i);
+        next_sample += MIC_DECIMATED_SAMPLES;
+        recorder_feed(block, MIC_DECIMATED_SAMPLES);
+    }
+}
+
+static recorder_stats_t stats(void) {
+    recorder_stats_t s;
+    recorder_get_stats(&s);
+    return s;
+}
+
+// Um disparo e o trecho inteiro; em silêncio o núcleo 1 grava. Devolve o número da
+// primeira amostra do trecho.
+static uint32_t record_event(float peak_db) {
+    uint32_t first = next_sample - RECORDER_PRE_SAMPLES;
+    uint32_t stored = stats().stored;
+
+    now_ms += 1000;
+    recorder_update(peak_db, 80.f, now_ms);
+    feed(POST_SAMPLES);
+    recorder_update(50.f, 80.f, now_ms);
+
+    recorder_set_quiet(true);
+    for (uint step = 0; step < 100 && stats().stored == stored; ++step)
+        recorder_task(now_ms);
+    CHECK(stats().stored == stored + 1);
+    return first;
+}
+
+// Amostras da posição iguais ao trecho numerado a partir de first.
+static bool slot_matches(uint slot, uint32_t first) {
+    const int16_t* samples = slot_samples(slot);
+    for (uint i = 0; i < RECORDER_SNIPPET_SAMPLES; ++i) {
+        if (samples[i] != (int16_t)(first + i))
+            return false;
+    }
+    return true;
+}
+
+// Executa fn com o stdout num arquivo e devolve o texto até o primeiro byte 0 (o início
+// dos quadros de telemetria).
+static void capture(void (*fn)(void*), void* arg, char* out, size_t size) {
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    FILE* file = fopen(CAPTURE_PATH, "w+");
+    dup2(fileno(file), STDOUT_FILENO);
+
+    fn(arg);
+
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+    fseek(file, 0, SEEK_SET);
+    size_t length = fread(out, 1, size - 1, file);
+    out[length] = '\0';
+    fclose(file);
+    unlink(CAPTURE_PATH);
+}
+
+// recorder_dump() e os passos de recorder_task() até o fim do envio.
+static void dump_all(void* arg) {
+    if (!recorder_dump(*(uint32_t*)arg))
+        return;
+    recorder_set_quiet(false); // Sem apagamentos durante o envio
+    while (recorder_task(now_ms))
+        ;
+}
+
+static void print_index(void* arg) {
+    (void)arg;
+    recorder_print_index();
+}
+
+// Mensagens do firmware (LOG_INFO) vão para stderr.
+static void reinit(void) {
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+    recorder_init(rate);
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+}
+
+// Um evento: cabeçalho com os campos e os CRCs, janela anterior em ordem cronológica
+// seguida do resto do trecho, e a próxima posição já apagada no silêncio.
+static void test_commit(void) {
+    uint32_t first = record_event(92.5f);
+
+    const event_header_t* header = slot_header(0);
+    CHECK(header->seq == 1);
+    CHECK(header->samples == RECORDER_SNIPPET_SAMPLES && header->pre_samples == RECORDER_PRE_SAMPLES);
+    CHECK(header->sample_rate == (uint32_t)(rate + 0.5f));
+    CHECK_NEAR(header->peak_db, 92.5, 1e-3);
+    CHECK(header->header_crc == crc32_update(0, (const uint8_t*)header, offsetof(event_header_t, header_crc)));
+    CHECK(header->data_crc ==
+          crc32_update(0, (const uint8_t*)slot_samples(0), RECORDER_SNIPPET_SAMPLES * sizeof(int16_t)));
+    CHECK(slot_matches(0, first));
+    CHECK(stats().events == 1 && stats().flash_errors == 0);
+
+    // Em silêncio, a posição seguinte é apagada antes do próximo disparo.
+    uint32_t ops = fake_flash_ops();
+    for (uint step = 0; step < 20; ++step)
+        recorder_task(now_ms);
+    CHECK(fake_flash_ops() - ops == SLOT_SECTORS);
+    CHECK(slot_header(1)->magic == 0xFFFFFFFF);
+
+    char out[256];
+    uint32_t seq = 1;
+    capture(dump_all, &seq, out, sizeof(out));
+    CHECK(strncmp(out, "EVENT,1,", 8) == 0 && strstr(out, ",ok\n") != NULL);
+}
+
+// Um bit trocado nas amostras: o envio continua, marcado com ",crc". Um cabeçalho
+// corrompido tira o evento do índice no próximo boot.
+static void test_crc(void) {
+    uint8_t* data = fake_flash_memory() + slot_offset(0) + FLASH_PAGE_SIZE + 1000;
+    *data ^= 0x01;
+
+    char out[256];
+    uint32_t seq = 1;
+    capture(dump_all, &seq, out, sizeof(out));
+    CHECK(strncmp(out, "EVENT,1,", 8) == 0 && strstr(out, ",crc\n") != NULL);
+    *data ^= 0x01;
+
+    uint8_t* peak = fake_flash_memory() + slot_offset(0) + offsetof(event_header_t, peak_db);
+    *peak ^= 0x10;
+    reinit();
+    CHECK(stats().events == 0);
+    CHECK(!recorder_dump(1));
+    *peak ^= 0x10;
+    reinit();
+    CHECK(stats().events == 1);
+}
+
+// Mais eventos que posições: ficam os RECORDER_SLOTS - 1 mais recentes (a próxima
+// posição é apagada no silêncio), o índice sai do mais antigo ao mais recente e o boot
+// continua a sequência e a posição.
+static void test_wraparound(void) {
+    const uint events = 2 * RECORDER_SLOTS + 3;
+    uint32_t first = 0;
+    for (uint e = 0; e < events; ++e) {
+        first = record_event(85.f + e % 10);
+        for (uint step = 0; step < 20; ++step)
+            recorder_task(now_ms);
+    }
+    uint32_t last_seq = 1 + events;
+    CHECK(stats().events == RECORDER_SLOTS - 1);
+    CHECK(stats().flash_errors == 0);
+
+    char out[4096];
+    capture(print_index, NULL, out, sizeof(out));
+    uint32_t expected = last_seq - (RECORDER_SLOTS - 2);
+    bool in_order = true;
+    uint lines = 0;
+    for (const char* line = out; (line = strstr(line, "EVENT,")) != NULL; ++line, ++lines, ++expected)
+        in_order = in_order && strtoul(line + 6, NULL, 10) == expected;
+    CHECK(in_order && lines == RECORDER_SLOTS - 1);
+
+    uint last_slot = (last_seq - 1) % RECORDER_SLOTS;
+    CHECK(slot_header(last_slot)->seq == last_seq);
+    CHECK(slot_matches(last_slot, first));
+
+    reinit();
+    CHECK(stats().events == RECORDER_SLOTS - 1);
+    record_event(90.f);
+    CHECK(slot_header((last_slot + 1) % RECORDER_SLOTS)->seq == last_seq + 1);
+}
+
+// Queda de energia no meio das amostras: sem cabeçalho, a posição é ignorada no boot e o
+// evento anterior continua o mais recente.
+static void test_power_cut(void) {
+    for (uint step = 0; step < 20; ++step)
+        recorder_task(now_ms); // A posição seguinte perde o evento antigo aqui, não no filho
+    recorder_stats_t before = stats();
+
+    pid_t child = fork();
+    if (child == 0) {
+        fake_flash_power_cut_after(5);
+        record_event(95.f);
+        _exit(0);
+    }
+    int status;
+    waitpid(child, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == FAKE_POWER_CUT_EXIT);
+
+    reinit();
+    CHECK(stats().events == before.events);
+    uint32_t seq = stats().stored; // O último evento gravado (a sequência começou em 1)
+    char out[256];
+    capture(dump_all, &seq, out, sizeof(out));
+    CHECK(strstr(out, ",ok\n") != NULL);
+}
+
+// Um setor apagado com a captura contínua rodando: os blocos que terminaram durante os
+// ~45 ms parados entram em mic_get_overruns().
+static void test_erase_overruns(void) {
+    fake_adc_sine(MIC_CHANNEL, 1000.0, 500.0, ADC_MIDPOINT);
+    mic_start_continuous();
+    for (uint i = 0; i < 4; ++i)
+        mic_wait_ready_buffer();
+
+    float block_us = SAMPLES * 1e6f / mic_get_sample_rate();
+    uint32_t before = mic_get_overruns();
+    CHECK(flash_store_erase(slot_offset(RECORDER_SLOTS - 1), FLASH_SECTOR_SIZE));
+    mic_wait_ready_buffer();
+    uint32_t lost = mic_get_overruns() - before;
+    mic_stop_continuous();
+
+    CHECK_NEAR(lost, FAKE_FLASH_ERASE_US / block_us, 2.0);
+    printf("recorder: apagamento de %u us, %u blocos de %.0f us perdidos\n", FAKE_FLASH_ERASE_US, lost, block_us);
+}
+
+int main(void) {
+    fake_flash_erase_all();
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+    mic_init();
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    rate = mic_get_decimated_rate();
+    reinit();
+    feed(RECORDER_PRE_SAMPLES);
+
+    test_commit();
+    test_crc();
+    test_wraparound();
+    test_power_cut();
+    test_erase_overruns();
+    return check_report();
+}
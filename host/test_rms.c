@@ -0,0 +1,118 @@
+// Núcleo inteiro do RMS (mic_block_stats) contra o laço em float/double da versão
+// original de mic_power(): mesmo resultado e tempo por bloco de cada um.
+
+#include <stdlib.h>
+#include "fake_hal.h"
+#include "check.h"
+#include "mic.h"
+
+#define BENCH_BLOCKS 20000
+
+// mic_power() original, sem os printf de depuração.
+static float baseline_mic_power(const uint16_t* adc_buffer) {
+    double sum_squared = 0.0;
+    float max_voltage = -INFINITY;
+    float min_voltage = INFINITY;
+
+    for (uint i = 0; i < SAMPLES; ++i) {
+        float voltage = ADC_ADJUST(adc_buffer[i]);
+        sum_squared += voltage * voltage;
+        max_voltage = fmaxf(max_voltage, voltage);
+        min_voltage = fminf(min_voltage, voltage);
+    }
+    return sqrt(sum_squared / SAMPLES);
+}
+
+// RMS em torno do ponto médio fixo, como a versão original, a partir das somas inteiras.
+static float integer_rms(const uint16_t* adc_buffer) {
+    mic_block_stats_t stats;
+    mic_block_stats(adc_buffer, SAMPLES, 1, &stats);
+    return sqrtf((float)stats.sum_squared / stats.count) * ADC_VOLTS_PER_COUNT;
+}
+
+// Blocos aleatórios de amplitudes diferentes, até o fundo de escala do ADC.
+static void fill_random(uint16_t* buffer, int amplitude) {
+    for (uint i = 0; i < SAMPLES; ++i) {
+        int value = ADC_MIDPOINT + rand() % (2 * amplitude + 1) - amplitude;
+        buffer[i] = value < 0 ? 0 : value > 4095 ? 4095 : value;
+    }
+}
+
+// As somas inteiras dão o mesmo RMS que o laço em float (até o arredondamento do float).
+static void test_equivalence(void) {
+    uint16_t buffer[SAMPLES];
+    const int amplitudes[] = {1, 10, 100, 1000, 2048};
+    for (uint a = 0; a < sizeof(amplitudes) / sizeof(amplitudes[0]); ++a) {
+        for (int n = 0; n < 20; ++n) {
+            fill_random(buffer, amplitudes[a]);
+            float expected = baseline_mic_power(buffer);
+            CHECK_NEAR(integer_rms(buffer), expected, 1e-5 * expected + 1e-6);
+        }
+    }
+
+    // Extremos: fundo de escala e silêncio.
+    for (uint i = 0; i < SAMPLES; ++i)
+        buffer[i] = i & 1 ? 4095 : 0;
+    CHECK_NEAR(integer_rms(buffer), baseline_mic_power(buffer), 1e-5);
+    for (uint i = 0; i < SAMPLES; ++i)
+        buffer[i] = ADC_MIDPOINT;
+    CHECK(integer_rms(buffer) == 0.0f);
+    CHECK_NEAR(baseline_mic_power(buffer), 0.0, 1e-6);
+}
+
+// mic_power() coincide com a original também com DC no bloco: as duas medem em torno do
+// ponto médio, então o deslocamento entra no RMS.
+static void test_power_matches_baseline(void) {
+    uint16_t buffer[SAMPLES];
+    const int offsets[] = {0, 300, -700, 1500};
+    for (uint o = 0; o < sizeof(offsets) / sizeof(offsets[0]); ++o) {
+        for (int n = 0; n < 20; ++n) {
+            for (uint i = 0; i < SAMPLES; ++i) {
+                int value = ADC_MIDPOINT + offsets[o] + rand() % 801 - 400;
+                buffer[i] = value < 0 ? 0 : value > 4095 ? 4095 : value;
+            }
+            float expected = baseline_mic_power(buffer);
+            CHECK_NEAR(mic_power(buffer), expected, 1e-5 * expected + 1e-6);
+        }
+    }
+
+    // Bloco constante fora do ponto médio: o RMS é o próprio deslocamento.
+    for (uint i = 0; i < SAMPLES; ++i)
+        buffer[i] = ADC_MIDPOINT + 500;
+    CHECK_NEAR(mic_power(buffer), 500 * ADC_VOLTS_PER_COUNT, 1e-6);
+}
+
+// Tempo por bloco de SAMPLES amostras: laço em float contra o núcleo inteiro.
+static void bench_rms(void) {
+    static uint16_t buffers[8][SAMPLES];
+    for (int b = 0; b < 8; ++b)
+        fill_random(buffers[b], 1000);
+
+    volatile float sink = 0;
+    uint64_t start = check_now_ns();
+    for (int n = 0; n < BENCH_BLOCKS; ++n)
+        sink += baseline_mic_power(buffers[n & 7]);
+    check_bench("rms_float_baseline", BENCH_BLOCKS, check_now_ns() - start);
+
+    start = check_now_ns();
+    for (int n = 0; n < BENCH_BLOCKS; ++n) {
+        mic_block_stats_t stats;
+        mic_block_stats(buffers[n & 7], SAMPLES, 1, &stats);
+        sink += (float)stats.sum_squared;
+    }
+    check_bench("rms_block_stats", BENCH_BLOCKS, check_now_ns() - start);
+
+    start = check_now_ns();
+    for (int n = 0; n < BENCH_BLOCKS; ++n)
+        sink += mic_power(buffers[n & 7]);
+    check_bench("rms_mic_power", BENCH_BLOCKS, check_now_ns() - start);
+    (void)sink;
+}
+
+int main(void) {
+    srand(2);
+    test_equivalence();
+    test_power_matches_baseline();
+    bench_rms();
+    return check_report();
+}
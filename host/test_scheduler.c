@@ -0,0 +1,122 @@
+// Escalonador por prazos (scheduler.c) com os timers repetitivos do fake HAL: um prazo por
+// período, prazos perdidos contados como overrun sem desalinhar o período seguinte, o
+// atraso máximo e, com duas threads, o contador do timer lido por outro "núcleo".
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include "fake_hal.h"
+#include "check.h"
+#include "scheduler.h"
+
+#define MS 1000u
+#define STRESS_SECONDS 20u
+
+static scheduler_stats_t stats(scheduler_task_t task) {
+    scheduler_stats_t s;
+    scheduler_get_stats(task, &s);
+    return s;
+}
+
+// Primeiros prazos: o quadro vence uma vez em 200 ms; a matriz venceu quatro vezes e roda
+// uma, com três overruns.
+static void test_first_deadlines(void) {
+    CHECK(fake_alarms_pending() == SCHEDULER_TASKS);
+    CHECK(!scheduler_due(SCHEDULER_FRAME) && !scheduler_due(SCHEDULER_LED));
+
+    fake_advance_us(SCHEDULER_FRAME_PERIOD_MS * MS - 1);
+    CHECK(!scheduler_due(SCHEDULER_FRAME));
+    fake_advance_us(1);
+    CHECK(scheduler_due(SCHEDULER_FRAME));
+    CHECK(!scheduler_due(SCHEDULER_FRAME));
+
+    CHECK(scheduler_due(SCHEDULER_LED));
+    CHECK(!scheduler_due(SCHEDULER_LED));
+    CHECK(stats(SCHEDULER_LED).runs == 1);
+    CHECK(stats(SCHEDULER_LED).overruns == SCHEDULER_FRAME_PERIOD_MS / SCHEDULER_LED_PERIOD_MS - 1);
+    CHECK(stats(SCHEDULER_FRAME).overruns == 0);
+}
+
+// O atraso entre o prazo e o consumo entra em max_latency_us.
+static void test_latency(void) {
+    fake_advance_us(SCHEDULER_FRAME_PERIOD_MS * MS + 7 * MS);
+    CHECK(scheduler_due(SCHEDULER_FRAME));
+    CHECK(stats(SCHEDULER_FRAME).max_latency_us == 7 * MS);
+
+    // Volta ao alinhamento do timer para o próximo teste.
+    fake_advance_us(SCHEDULER_FRAME_PERIOD_MS * MS - 7 * MS);
+    CHECK(scheduler_due(SCHEDULER_FRAME));
+}
+
+// Laço com trabalho de duração variável, às vezes maior que o período: cada período vira
+// uma execução ou um overrun, e as execuções continuam no ritmo do timer.
+static void test_stable_period(void) {
+    scheduler_stats_t before = stats(SCHEDULER_FRAME);
+    uint64_t start = time_us_64();
+    uint32_t long_frames = 0;
+    srand(17);
+
+    const uint frames = 200;
+    for (uint n = 0; n < frames; ++n) {
+        // Trabalho: 20 a 180 ms; um quadro em cada 10 passa de 400 ms e perde um prazo.
+        uint32_t work_ms = n % 10 == 9 ? 400 + rand() % 80 : 20 + rand() % 160;
+        long_frames += work_ms >= 2 * SCHEDULER_FRAME_PERIOD_MS;
+        fake_advance_us(work_ms * MS);
+        while (!scheduler_due(SCHEDULER_FRAME))
+            fake_advance_us(MS); // __wfi() até o próximo prazo
+    }
+
+    scheduler_stats_t after = stats(SCHEDULER_FRAME);
+    // O último quadro pode ter rodado atrasado, mas antes do prazo seguinte.
+    uint32_t periods = (time_us_64() - start) / (SCHEDULER_FRAME_PERIOD_MS * MS);
+    CHECK(after.runs - before.runs == frames);
+    CHECK(after.runs - before.runs + after.overruns - before.overruns == periods);
+    CHECK(after.overruns - before.overruns == long_frames);
+    printf("scheduler: %u quadros em %u períodos, %u overruns\n", frames, periods,
+           after.overruns - before.overruns);
+}
+
+static volatile bool stress_done;
+
+// Produtor: o "núcleo 0" que atende os alarmes do timer.
+static void* timer_core(void* arg) {
+    (void)arg;
+    for (uint32_t ms = 0; ms < STRESS_SECONDS * 1000; ++ms) {
+        fake_advance_us(MS);
+        if (ms % 16 == 0)
+            sched_yield();
+    }
+    __atomic_store_n(&stress_done, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// O timer avança numa thread e a matriz é consumida em outra: nenhum prazo some nem é
+// contado duas vezes.
+static void test_two_threads(void) {
+    while (scheduler_due(SCHEDULER_LED))
+        ;
+    scheduler_stats_t before = stats(SCHEDULER_LED);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, timer_core, NULL);
+    while (!__atomic_load_n(&stress_done, __ATOMIC_ACQUIRE)) {
+        if (!scheduler_due(SCHEDULER_LED))
+            sched_yield();
+    }
+    pthread_join(thread, NULL);
+    scheduler_due(SCHEDULER_LED);
+
+    scheduler_stats_t after = stats(SCHEDULER_LED);
+    uint32_t consumed = after.runs - before.runs + after.overruns - before.overruns;
+    CHECK(consumed == STRESS_SECONDS * 1000 / SCHEDULER_LED_PERIOD_MS);
+    CHECK(after.runs > before.runs);
+}
+
+int main(void) {
+    scheduler_init();
+    test_first_deadlines();
+    test_latency();
+    test_stable_period();
+    test_two_threads();
+    return check_report();
+}
@@ -0,0 +1,263 @@
+// Configurações na flash (settings.c) com a imagem da flash num arquivo: a gravação espera
+// as alterações pararem e o silêncio, o boot (este mesmo programa, num processo novo com a
+// imagem) lê o último valor de cada chave, uma gravação recusada é refeita na mesma posição,
+// a compactação troca de setor sem perder nada e uma queda de energia em qualquer operação
+// deixa cada chave com o valor antigo ou o novo.
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "fake_hal.h"
+#include "check.h"
+#include "flash_store.h"
+#include "settings.h"
+
+#define IMAGE_PATH "test_settings_flash.bin"
+#define SNAPSHOT_PATH "test_settings_snapshot.bin"
+#define MS 1000u
+// Mais cortes que as operações de uma troca de valores (registros e uma compactação).
+#define MAX_OPS 8
+
+static const char* self;
+
+static uint32_t now_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+static uint32_t flash_ops_since(uint32_t start) {
+    return fake_flash_ops() - start;
+}
+
+// Roda settings_task() em silêncio, 10 ms por volta, até não haver mais nada a gravar.
+static void flush(void) {
+    settings_set_quiet(true);
+    fake_advance_us(SETTINGS_WRITE_DELAY_MS * MS);
+    for (uint step = 0; step < 100; ++step) {
+        fake_advance_us(10 * MS);
+        if (!settings_task(now_ms()))
+            break;
+    }
+}
+
+/**
+ * Boot com a flash atual: grava a imagem, roda "self boot imagem" e lê o valor de cada
+ * chave nas linhas SETTING. Uma chave ausente fica com "-".
+ */
+static void boot(char values[SETTINGS_KEYS][32]) {
+    static const char* const NAMES[SETTINGS_KEYS] = {"sensitivity", "view", "source", "cal_gain", "cal_offset"};
+    for (uint key = 0; key < SETTINGS_KEYS; ++key)
+        strcpy(values[key], "-");
+
+    CHECK(fake_flash_save(IMAGE_PATH));
+    char command[512];
+    snprintf(command, sizeof(command), "%s boot %s 2>/dev/null", self, IMAGE_PATH);
+    FILE* out = popen(command, "r");
+    char line[128];
+    while (out && fgets(line, sizeof(line), out)) {
+        char name[32], value[32];
+        if (sscanf(line, "SETTING,%31[^,],%31[^,],", name, value) != 2)
+            continue;
+        for (uint key = 0; key < SETTINGS_KEYS; ++key) {
+            if (strcmp(name, NAMES[key]) == 0)
+                strcpy(values[key], value);
+        }
+    }
+    CHECK(out && pclose(out) == 0);
+    unlink(IMAGE_PATH);
+}
+
+// Processo de boot: carrega a imagem e escreve as configurações.
+static int boot_main(const char* image) {
+    if (!fake_flash_load(image))
+        return 1;
+    settings_init();
+    settings_print();
+    return 0;
+}
+
+// Alterações seguidas viram uma gravação depois de SETTINGS_WRITE_DELAY_MS; fora do
+// silêncio, só depois de SETTINGS_FORCE_WRITE_MS; e cada settings_task() faz no máximo uma
+// operação na flash.
+static void test_write_behind(void) {
+    char values[SETTINGS_KEYS][32];
+    uint32_t ops = fake_flash_ops();
+
+    settings_init();
+    boot(values);
+    CHECK(strcmp(values[SETTINGS_SENSITIVITY], "-") == 0);
+
+    settings_set_quiet(false);
+    for (uint32_t level = 1; level <= 5; ++level) {
+        settings_set(SETTINGS_SENSITIVITY, level);
+        fake_advance_us(300 * MS);
+        CHECK(!settings_task(now_ms()));
+    }
+    settings_set_float(SETTINGS_CAL_GAIN, 0.75f);
+    fake_advance_us(SETTINGS_WRITE_DELAY_MS * MS);
+    CHECK(!settings_task(now_ms())); // Sem silêncio ainda
+    CHECK(flash_ops_since(ops) == 0);
+
+    fake_advance_us(SETTINGS_FORCE_WRITE_MS * MS);
+    uint steps = 0;
+    while (settings_task(now_ms())) {
+        CHECK(flash_ops_since(ops) == ++steps);
+        fake_advance_us(10 * MS);
+    }
+    // Formatação (apagar, copiar as chaves, cabeçalho): os dois valores já vão na cópia.
+    CHECK(steps == 3);
+
+    boot(values);
+    CHECK(strcmp(values[SETTINGS_SENSITIVITY], "5") == 0);
+    CHECK(strcmp(values[SETTINGS_CAL_GAIN], "0.7500") == 0);
+
+    // Uma chave alterada depois: um registro no fim do log.
+    ops = fake_flash_ops();
+    settings_set(SETTINGS_VIEW, 1);
+    flush();
+    CHECK(flash_ops_since(ops) == 1);
+    boot(values);
+    CHECK(strcmp(values[SETTINGS_VIEW], "1") == 0);
+
+    // Cada chave guarda o instante da própria alteração: a mais recente segura a gravação.
+    ops = fake_flash_ops();
+    settings_set(SETTINGS_SENSITIVITY, 3);
+    fake_advance_us(4000 * MS);
+    settings_set(SETTINGS_SOURCE, 1);
+    fake_advance_us(SETTINGS_WRITE_DELAY_MS * MS - 1000 * MS);
+    CHECK(!settings_task(now_ms()));
+    fake_advance_us(1000 * MS);
+    CHECK(settings_task(now_ms()) && settings_task(now_ms()));
+    CHECK(flash_ops_since(ops) == 2);
+}
+
+// O núcleo 0 não para a tempo na primeira gravação: a flash fica intacta, a mesma posição é
+// gravada na volta seguinte e o boot encontra todas as chaves (um buraco em branco no meio
+// do log esconderia as que vêm depois).
+static void test_lockout_retry(void) {
+    char values[SETTINGS_KEYS][32];
+
+    settings_set(SETTINGS_SENSITIVITY, 2);
+    settings_set(SETTINGS_VIEW, 0);
+    settings_set(SETTINGS_SOURCE, 2);
+    fake_flash_fail_next(1);
+    flush();
+
+    boot(values);
+    CHECK(strcmp(values[SETTINGS_SENSITIVITY], "2") == 0);
+    CHECK(strcmp(values[SETTINGS_VIEW], "0") == 0);
+    CHECK(strcmp(values[SETTINGS_SOURCE], "2") == 0);
+
+    settings_set(SETTINGS_VIEW, 1);
+    flush();
+}
+
+// Setor cheio: a compactação passa para o outro setor uma cópia de cada chave, o boot
+// escolhe a geração mais nova mesmo com o setor antigo ainda válido, e o log continua.
+static void test_compaction(void) {
+    char values[SETTINGS_KEYS][32], expected[32];
+    const uint records = FLASH_SECTOR_SIZE / 8;
+
+    for (uint32_t n = 0; n < records; ++n) {
+        settings_set(SETTINGS_SOURCE, n % 3);
+        settings_set(SETTINGS_SENSITIVITY, 1 + n % 5);
+        flush();
+    }
+    settings_set_float(SETTINGS_CAL_OFFSET, -1.5f);
+    flush();
+
+    boot(values);
+    snprintf(expected, sizeof(expected), "%u", (records - 1) % 3);
+    CHECK(strcmp(values[SETTINGS_SOURCE], expected) == 0);
+    snprintf(expected, sizeof(expected), "%u", 1 + (records - 1) % 5);
+    CHECK(strcmp(values[SETTINGS_SENSITIVITY], expected) == 0);
+    CHECK(strcmp(values[SETTINGS_VIEW], "1") == 0);
+    CHECK(strcmp(values[SETTINGS_CAL_GAIN], "0.7500") == 0);
+    CHECK(strcmp(values[SETTINGS_CAL_OFFSET], "-1.5000") == 0);
+
+    // Os dois setores têm cabeçalho: o antigo ainda não foi reaproveitado.
+    CHECK(*(const uint32_t*)flash_store_ptr(FLASH_SETTINGS_OFFSET) ==
+          *(const uint32_t*)flash_store_ptr(FLASH_SETTINGS_OFFSET + FLASH_SECTOR_SIZE));
+}
+
+// Uma troca de valores cortada em cada uma das operações, com o setor quase cheio para a
+// compactação entrar no meio: no boot seguinte, cada chave tem o valor antigo ou o novo.
+static uint test_power_loss(void) {
+    char before[SETTINGS_KEYS][32], values[SETTINGS_KEYS][32];
+
+    // Compacta e enche o setor novo até restarem três posições: três das quatro chaves
+    // alteradas cabem e a quarta provoca a compactação.
+    for (uint n = 0; n < 2 * FLASH_SECTOR_SIZE / 8; ++n) {
+        uint32_t ops = fake_flash_ops();
+        settings_set(SETTINGS_SOURCE, n % 2);
+        flush();
+        if (flash_ops_since(ops) > 1)
+            break; // Compactou: o setor novo tem o cabeçalho e as cópias
+    }
+    for (uint n = 0; n < FLASH_SECTOR_SIZE / 8 - 1 - SETTINGS_KEYS - 3; ++n) {
+        settings_set(SETTINGS_SOURCE, 2 + n % 2);
+        flush();
+    }
+    boot(before);
+    CHECK(fake_flash_save(SNAPSHOT_PATH));
+
+    uint cuts = 0;
+    for (int cut = 0; cut < MAX_OPS; ++cut) {
+        pid_t child = fork();
+        if (child == 0) {
+            fake_flash_power_cut_after(cut);
+            settings_set(SETTINGS_SENSITIVITY, 4);
+            settings_set(SETTINGS_VIEW, 0);
+            settings_set_float(SETTINGS_CAL_GAIN, 1.25f);
+            settings_set(SETTINGS_SOURCE, 0);
+            flush();
+            _exit(0);
+        }
+        int status;
+        waitpid(child, &status, 0);
+        CHECK(WIFEXITED(status));
+        if (WEXITSTATUS(status) != FAKE_POWER_CUT_EXIT)
+            break; // Todas as operações terminaram antes do corte
+        ++cuts;
+
+        boot(values);
+        const char* after[SETTINGS_KEYS] = {
+            [SETTINGS_SENSITIVITY] = "4",
+            [SETTINGS_VIEW] = "0",
+            [SETTINGS_SOURCE] = "0",
+            [SETTINGS_CAL_GAIN] = "1.2500",
+            [SETTINGS_CAL_OFFSET] = before[SETTINGS_CAL_OFFSET],
+        };
+        for (uint key = 0; key < SETTINGS_KEYS; ++key)
+            CHECK(strcmp(values[key], before[key]) == 0 || strcmp(values[key], after[key]) == 0);
+
+        CHECK(fake_flash_load(SNAPSHOT_PATH));
+    }
+    unlink(SNAPSHOT_PATH);
+
+    // Três registros e a compactação (apagar, copiar e o cabeçalho): seis pontos de corte.
+    CHECK(cuts == 6);
+    return cuts;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 3 && strcmp(argv[1], "boot") == 0)
+        return boot_main(argv[2]);
+    self = argv[0];
+
+    // Mensagens do firmware vão para stderr; o stdout fica com o relatório do teste.
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+    fake_flash_erase_all();
+    test_write_behind();
+    test_lockout_retry();
+    test_compaction();
+    uint cuts = test_power_loss();
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    printf("settings: %u quedas de energia simuladas, nenhuma chave perdida\n", cuts);
+    return check_report();
+}
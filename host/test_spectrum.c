@@ -0,0 +1,106 @@
+// Espectro por bandas de oitava (spectrum.c): um seno no centro de cada banda aparece só
+// nela, no nível RMS esperado, a tela de espectro da matriz usa a faixa da sensibilidade e
+// o tempo de uma FFT com as bandas.
+
+#include <string.h>
+#include "fake_hal.h"
+#include "check.h"
+#include "matrizLED.h"
+#include "mic.h"
+#include "spectrum.h"
+
+#define BENCH_WINDOWS 5000
+
+static const float centers[SPECTRUM_BANDS] = SPECTRUM_BAND_CENTERS;
+
+extern npLED_t leds[LED_COUNT];
+void update_led_spectrum(const float band_db[SPECTRUM_BANDS], uint8_t sensitivity);
+
+// Janela de seno no formato de mic_decimate(): contagens com MIC_DECIMATED_FRAC_BITS bits fracionários.
+static void feed_sine(float rate, float freq, float amplitude_counts, float phase) {
+    int16_t samples[SPECTRUM_N];
+    for (uint i = 0; i < SPECTRUM_N; ++i)
+        samples[i] = (int16_t)lroundf(amplitude_counts * (1 << MIC_DECIMATED_FRAC_BITS) *
+                                      sinf(6.28318531f * freq * i / rate + phase));
+    // Em pedaços, como o laço entrega.
+    for (uint i = 0; i < SPECTRUM_N; i += MIC_DECIMATED_SAMPLES)
+        CHECK(spectrum_feed(&samples[i], MIC_DECIMATED_SAMPLES) == (i + MIC_DECIMATED_SAMPLES == SPECTRUM_N));
+}
+
+// Cada tom no centro de uma banda: nível do seno nela e, com amplitude alta (acima do ruído
+// de arredondamento da FFT), pelo menos 25 dB abaixo nas outras.
+static void test_known_sine(void) {
+    float rate = mic_get_decimated_rate();
+    spectrum_init(rate);
+
+    const float amplitudes[] = {1500.f, 200.f};
+    for (uint a = 0; a < 2; ++a) {
+        float expected_db = mic_rms_to_db(amplitudes[a] / sqrtf(2.f) * ADC_VOLTS_PER_COUNT);
+        for (uint b = 0; b < SPECTRUM_BANDS; ++b) {
+            float band_db[SPECTRUM_BANDS];
+            feed_sine(rate, centers[b], amplitudes[a], 0.3f * b);
+            spectrum_compute(band_db);
+
+            CHECK_NEAR(band_db[b], expected_db, 0.5);
+            for (uint other = 0; other < SPECTRUM_BANDS && a == 0; ++other)
+                if (other != b)
+                    CHECK(band_db[other] < expected_db - 25.f);
+        }
+    }
+
+    // Depois do cálculo a janela recomeça do início.
+    int16_t sample = 0;
+    CHECK(!spectrum_feed(&sample, 1));
+}
+
+// Matriz na tela de espectro: na sensibilidade 5 (a mais alta) as colunas usam a última
+// faixa da tabela, 20 a 50 dB, como a 4; a 1 acende menos com os mesmos níveis.
+static void test_led_spectrum(void) {
+    const float band_db[SPECTRUM_BANDS] = {25.f, 32.f, 38.f, 44.f, 49.f};
+    npLED_t level4[LED_COUNT];
+
+    npClear();
+    update_led_spectrum(band_db, 4);
+    memcpy(level4, leds, sizeof(level4));
+    uint lit = 0;
+    for (uint i = 0; i < LED_COUNT; ++i)
+        lit += level4[i].R || level4[i].G || level4[i].B;
+    CHECK(lit == 0 + 2 + 3 + 4 + 4);
+
+    npClear();
+    update_led_spectrum(band_db, 5);
+    CHECK(memcmp(leds, level4, sizeof(level4)) == 0);
+
+    npClear();
+    update_led_spectrum(band_db, 1);
+    CHECK(memcmp(leds, level4, sizeof(level4)) != 0);
+}
+
+// Tempo de spectrum_compute() (janela de Hann, FFT de SPECTRUM_N pontos e bandas).
+static void bench_fft(void) {
+    float rate = mic_get_decimated_rate();
+    spectrum_init(rate);
+
+    int16_t samples[SPECTRUM_N];
+    for (uint i = 0; i < SPECTRUM_N; ++i)
+        samples[i] = (int16_t)lroundf(8000.f * sinf(6.28318531f * 1000.f * i / rate));
+
+    float band_db[SPECTRUM_BANDS];
+    volatile float sink = 0;
+    uint64_t start = check_now_ns();
+    for (int n = 0; n < BENCH_WINDOWS; ++n) {
+        spectrum_feed(samples, SPECTRUM_N);
+        spectrum_compute(band_db);
+        sink += band_db[2];
+    }
+    check_bench("fft_q15_bands", BENCH_WINDOWS, check_now_ns() - start);
+    (void)sink;
+}
+
+int main(void) {
+    mic_init();
+    test_known_sine();
+    test_led_spectrum();
+    bench_fft();
+    return check_report();
+}
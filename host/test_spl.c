@@ -0,0 +1,113 @@
+// Medidor de nível (spl.c): seno de 1 kHz no nível esperado, linearidade até o fundo de
+// escala (sem estouro nos filtros em ponto fixo), LAFmin sem a subida inicial e o tempo
+// de spl_process() por bloco.
+
+#include "fake_hal.h"
+#include "check.h"
+#include "mic.h"
+#include "spl.h"
+
+#define BENCH_BLOCKS 50000
+
+static float rate;
+
+// Blocos de seno ou onda quadrada no formato de mic_decimate().
+static void feed(float freq, float amplitude, bool square, float seconds) {
+    static uint64_t n;
+    int16_t block[MIC_DECIMATED_SAMPLES];
+    uint blocks = (uint)(seconds * rate / MIC_DECIMATED_SAMPLES);
+    for (uint b = 0; b < blocks; ++b) {
+        for (uint i = 0; i < MIC_DECIMATED_SAMPLES; ++i, ++n) {
+            float s = sinf(6.28318531f * freq * (float)(n % 1000000) / rate);
+            if (square)
+                s = s >= 0 ? 1.f : -1.f;
+            block[i] = (int16_t)lroundf(amplitude * s);
+        }
+        spl_process(block, MIC_DECIMATED_SAMPLES);
+    }
+}
+
+// Nível em dB de um seno de amplitude dada em unidades decimadas.
+static float sine_db(float amplitude) {
+    return mic_rms_to_db(amplitude / sqrtf(2.f) / (1 << MIC_DECIMATED_FRAC_BITS) * ADC_VOLTS_PER_COUNT);
+}
+
+// Seno de 1 kHz: A e C valem 0 dB, então LAF, LAS, LCF e LAeq dão o nível do seno.
+static void test_1khz_sine(void) {
+    spl_init(rate);
+    feed(1000.f, 8000.f, false, 3.f);
+    spl_levels_t levels;
+    spl_get_levels(&levels);
+    float expected = sine_db(8000.f);
+    CHECK_NEAR(levels.laf, expected, 0.2);
+    CHECK_NEAR(levels.las, expected, 0.2);
+    CHECK_NEAR(levels.lcf, expected, 0.2);
+    CHECK_NEAR(levels.laeq, expected, 0.5);
+}
+
+// Onda quadrada até o limite de 16 bits: os degraus levam x - y1 a 2^20 nos passa-baixas.
+// O nível deve subir exatamente com a amplitude, sem estouro.
+static void test_full_scale_linearity(void) {
+    const float amplitudes[] = {1000.f, 8000.f, 32767.f};
+    float lcf[3], laf[3];
+    for (uint i = 0; i < 3; ++i) {
+        spl_init(rate);
+        feed(1000.f, amplitudes[i], true, 2.f);
+        spl_levels_t levels;
+        spl_get_levels(&levels);
+        lcf[i] = levels.lcf;
+        laf[i] = levels.laf;
+    }
+    float gain, offset;
+    mic_get_calibration(&gain, &offset);
+    for (uint i = 1; i < 3; ++i) {
+        float expected = gain * 20.f * log10f(amplitudes[i] / amplitudes[0]);
+        CHECK_NEAR(lcf[i] - lcf[0], expected, 0.1);
+        CHECK_NEAR(laf[i] - laf[0], expected, 0.1);
+    }
+}
+
+// A média Fast começa em zero; o mínimo só é contado depois que ela se estabiliza.
+static void test_min_skips_ramp_up(void) {
+    spl_init(rate);
+    feed(1000.f, 4000.f, false, 2.f);
+    spl_levels_t levels;
+    spl_get_levels(&levels);
+    CHECK_NEAR(levels.lafmin, sine_db(4000.f), 0.3);
+    CHECK_NEAR(levels.lafmax, sine_db(4000.f), 0.3);
+
+    // Um trecho mais baixo depois disso vira o mínimo.
+    feed(1000.f, 1000.f, false, 1.f);
+    spl_get_levels(&levels);
+    CHECK_NEAR(levels.lafmin, sine_db(1000.f), 0.3);
+
+    // spl_reset() no meio da medição não espera de novo: o filtro já está estável e o
+    // primeiro bloco já conta.
+    spl_reset();
+    feed(1000.f, 2000.f, false, 0.01f);
+    spl_get_levels(&levels);
+    CHECK(levels.lafmin > sine_db(1000.f) - 0.3f && levels.lafmin < sine_db(2000.f));
+}
+
+// Tempo de spl_process() por bloco de MIC_DECIMATED_SAMPLES amostras.
+static void bench_spl(void) {
+    int16_t block[MIC_DECIMATED_SAMPLES];
+    for (uint i = 0; i < MIC_DECIMATED_SAMPLES; ++i)
+        block[i] = (int16_t)lroundf(8000.f * sinf(6.28318531f * 1000.f * i / rate));
+
+    spl_init(rate);
+    uint64_t start = check_now_ns();
+    for (int n = 0; n < BENCH_BLOCKS; ++n)
+        spl_process(block, MIC_DECIMATED_SAMPLES);
+    check_bench("spl_process_block", BENCH_BLOCKS, check_now_ns() - start);
+}
+
+int main(void) {
+    mic_init();
+    rate = mic_get_decimated_rate();
+    test_1khz_sine();
+    test_full_scale_linearity();
+    test_min_skips_ramp_up();
+    bench_spl();
+    return check_report();
+}
@@ -0,0 +1,223 @@
+// Driver do SSD1306 contra o modelo do display do fake HAL: só as regiões alteradas
+// vão para o barramento, a GDDRAM continua igual ao framebuffer e as sequências de
+// comandos saem numa transação cada. Os atalhos por página do desenho são comparados com o
+// desenho pixel a pixel e cronometrados.
+
+#include <stdlib.h>
+#include <string.h>
+#include "fake_hal.h"
+#include "check.h"
+#include "ssd1306.h"
+#include "spectrum.h"
+
+// Janela COL/PAGE (7 palavras com o byte de controle) e o byte de controle dos dados.
+#define WINDOW_OVERHEAD 8
+// Quadro inteiro: uma janela de 128 x 8 páginas.
+#define FULL_FRAME_WORDS (WINDOW_OVERHEAD + DISPLAY_WIDTH * DISPLAY_PAGES)
+#define BENCH_FRAMES 20000
+
+static ssd1306_t display;
+
+extern const uint8_t font_8x5[];
+void update_full_display(ssd1306_t* display, float db_value, uint8_t sensitivity);
+void update_spectrum_display(ssd1306_t* display, const float band_db[SPECTRUM_BANDS], uint8_t sensitivity);
+
+static bool ram_matches(void) {
+    return memcmp(fake_oled()->ram, display.buffer, DISPLAY_WIDTH * DISPLAY_PAGES) == 0;
+}
+
+// Confere as palavras DATA_CMD gravadas a partir de first: endereço, bytes e STOP só na última.
+static bool stream_is(size_t first, const uint16_t* expected, size_t count) {
+    size_t total;
+    const uint32_t* words = fake_i2c_words(&total);
+    if (total - first < count)
+        return false;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t stop = i == count - 1 ? I2C_IC_DATA_CMD_STOP_BITS : 0;
+        if (words[first + i] != ((uint32_t)FAKE_OLED_ADDR << 16 | expected[i] | stop))
+            return false;
+    }
+    return true;
+}
+
+// Envia as mudanças e confere que bytes_sent é o que passou pelo barramento.
+static uint32_t update(void) {
+    size_t before, after;
+    fake_i2c_words(&before);
+    ssd1306_update(&display);
+    fake_i2c_words(&after);
+    CHECK(display.bytes_sent == after - before);
+    CHECK(ram_matches());
+    return display.bytes_sent;
+}
+
+// A inicialização inteira é uma transação de comandos seguida do quadro apagado.
+static void test_init_stream(void) {
+    const uint16_t init[] = {
+        0x00, SET_DISP, SET_DISP_CLK_DIV, 0x80, SET_MUX_RATIO, 63, SET_DISP_OFFSET, 0x00,
+        SET_DISP_START_LINE, SET_CHARGE_PUMP, 0x14, SET_SEG_REMAP | 0x01, SET_COM_OUT_DIR | 0x08,
+        SET_COM_PIN_CFG, 0x12, SET_CONTRAST, 0xff, SET_PRECHARGE, 0xF1, SET_VCOM_DESEL, 0x30,
+        SET_ENTIRE_ON, SET_NORM_INV, SET_DISP | 0x01, SET_MEM_ADDR, 0x00,
+    };
+    const size_t init_words = sizeof(init) / sizeof(init[0]);
+
+    fake_i2c_clear();
+    ssd1306_init(&display, i2c1, 64, 128, FAKE_OLED_ADDR, false);
+    CHECK(stream_is(0, init, init_words));
+    CHECK(fake_i2c_transactions() == 3); // Comandos, janela e dados do quadro apagado
+
+    size_t count;
+    fake_i2c_words(&count);
+    CHECK(count == init_words + FULL_FRAME_WORDS);
+    CHECK(fake_oled()->on && fake_oled()->contrast == 0xff);
+}
+
+// Cada chamada com argumentos vira uma transação só; a janela de atualização também.
+static void test_command_transactions(void) {
+    fake_i2c_clear();
+    ssd1306_set_contrast(&display, 0x40);
+    CHECK(stream_is(0, (const uint16_t[]){0x00, SET_CONTRAST, 0x40}, 3));
+    CHECK(fake_i2c_transactions() == 1 && fake_oled()->contrast == 0x40);
+
+    fake_i2c_clear();
+    ssd1306_invert_display(&display, true);
+    ssd1306_power_off(&display);
+    CHECK(stream_is(0, (const uint16_t[]){0x00, SET_NORM_INV | 0x01}, 2));
+    CHECK(stream_is(2, (const uint16_t[]){0x00, SET_DISP}, 2));
+    CHECK(fake_i2c_transactions() == 2 && !fake_oled()->on);
+    ssd1306_power_on(&display);
+    ssd1306_invert_display(&display, false);
+
+    // Um pixel na página 3, coluna 77: janela e dados, duas transações.
+    fake_i2c_clear();
+    ssd1306_draw_pixel(&display, 77, 26, true);
+    ssd1306_update(&display);
+    CHECK(stream_is(0, (const uint16_t[]){0x00, SET_COL_ADDR, 77, 77, SET_PAGE_ADDR, 3, 3}, 7));
+    CHECK(stream_is(7, (const uint16_t[]){0x40, 1 << 2}, 2));
+    CHECK(fake_i2c_transactions() == 2);
+    ssd1306_draw_pixel(&display, 77, 26, false);
+    ssd1306_update(&display);
+}
+
+// Retângulos sujos: nada, um pixel, um trecho de página, várias páginas e o quadro inteiro.
+static void test_dirty_bytes(void) {
+    CHECK(update() == 0);
+
+    ssd1306_draw_pixel(&display, 40, 9, true);
+    CHECK(update() == WINDOW_OVERHEAD + 1);
+
+    // Redesenhar o mesmo pixel não suja nada.
+    ssd1306_draw_pixel(&display, 40, 9, true);
+    CHECK(update() == 0);
+
+    // Colunas 10-30 da página 2 e 100 da página 5: uma janela por página.
+    ssd1306_draw_line(&display, 10, 17, 30, 17);
+    ssd1306_draw_pixel(&display, 100, 44, true);
+    CHECK(update() == (WINDOW_OVERHEAD + 21) + (WINDOW_OVERHEAD + 1));
+
+    // Todas as páginas na mesma faixa de colunas ainda vão página a página.
+    ssd1306_draw_line(&display, 60, 0, 60, 63);
+    CHECK(update() == DISPLAY_PAGES * (WINDOW_OVERHEAD + 1));
+
+    // Todas as páginas de ponta a ponta: uma única janela.
+    ssd1306_draw_line(&display, 0, 0, 127, 63);
+    CHECK(update() == FULL_FRAME_WORDS);
+}
+
+// Quadro típico da tela de nível: só as áreas apagadas e redesenhadas (valor, texto e barra)
+// voltam ao barramento, bem menos que o quadro inteiro.
+static void test_level_frame(void) {
+    ssd1306_clear_display(&display);
+    update_full_display(&display, 63.4f, 1);
+    CHECK(update() == FULL_FRAME_WORDS);
+
+    update_full_display(&display, 65.1f, 1);
+    uint32_t bytes = update();
+    CHECK(bytes > 0 && bytes < FULL_FRAME_WORDS / 2);
+    printf("ssd1306: quadro inteiro %u bytes, quadro de nível %u bytes\n", FULL_FRAME_WORDS, bytes);
+}
+
+// Framebuffer sem display, desenhado só com ssd1306_draw_pixel().
+static ssd1306_t reference_display(void) {
+    ssd1306_t ref = {.height = 64, .width = 128};
+    ref.buffer = calloc(DISPLAY_WIDTH * DISPLAY_PAGES, 1);
+    return ref;
+}
+
+static void reference_fill(ssd1306_t* ref, int x0, int y0, int x1, int y1, bool on) {
+    for (int y = y0; y < y1; ++y)
+        for (int x = x0; x < x1; ++x)
+            ssd1306_draw_pixel(ref, x, y, on);
+}
+
+static void reference_char(ssd1306_t* ref, char c, int x, int y) {
+    const uint8_t* glyph = &font_8x5[5 + (c - 32) * font_8x5[1]];
+    for (int col = 0; col < font_8x5[1]; ++col)
+        for (int row = 0; row < 8; ++row)
+            ssd1306_draw_pixel(ref, x + col, y + row, glyph[col] & (1 << row));
+}
+
+// Retângulos, linhas retas e letras em posições fora do alinhamento das páginas:
+// mesmo framebuffer que pixel a pixel.
+static void test_fast_paths_match_pixels(void) {
+    ssd1306_t ref = reference_display();
+    ssd1306_clear_display(&display);
+    memset(display.buffer, 0xa5, DISPLAY_WIDTH * DISPLAY_PAGES); // Fundo com bits dos dois valores
+    memset(ref.buffer, 0xa5, DISPLAY_WIDTH * DISPLAY_PAGES);
+
+    ssd1306_draw_filled_rectangle(&display, 3, 5, 70, 29);
+    reference_fill(&ref, 3, 5, 70, 29, true);
+    ssd1306_clear_rectangle(&display, 20, 9, 100, 14);
+    reference_fill(&ref, 20, 9, 100, 14, false);
+    ssd1306_draw_line(&display, 90, 33, 10, 33);
+    reference_fill(&ref, 10, 33, 91, 34, true);
+    ssd1306_draw_line(&display, 111, 62, 111, 1);
+    reference_fill(&ref, 111, 1, 112, 63, true);
+    ssd1306_draw_filled_rectangle(&display, 120, 60, 200, 90); // Cortado na borda
+    reference_fill(&ref, 120, 60, 128, 64, true);
+
+    for (int shift = 0; shift < 8; ++shift) {
+        ssd1306_draw_string(&display, "Ab9%", 6 + 24 * (shift % 4), 36 + shift);
+        for (int i = 0; i < 4; ++i)
+            reference_char(&ref, "Ab9%"[i], 6 + 24 * (shift % 4) + 6 * i, 36 + shift);
+    }
+    CHECK(memcmp(display.buffer, ref.buffer, DISPLAY_WIDTH * DISPLAY_PAGES) == 0);
+    free(ref.buffer);
+}
+
+// Tempo de desenho (sem o envio) das duas telas, por quadro.
+static void bench_render(void) {
+    float band_db[SPECTRUM_BANDS];
+    volatile uint8_t sink = 0;
+
+    uint64_t start = check_now_ns();
+    for (int n = 0; n < BENCH_FRAMES; ++n) {
+        update_full_display(&display, 40.0f + (n % 400) * 0.1f, 1);
+        sink += display.dirty_pages;
+        display.dirty_pages = 0;
+    }
+    check_bench("render_level_frame", BENCH_FRAMES, check_now_ns() - start);
+
+    start = check_now_ns();
+    for (int n = 0; n < BENCH_FRAMES; ++n) {
+        for (int b = 0; b < SPECTRUM_BANDS; ++b)
+            band_db[b] = 40.0f + ((n + 7 * b) % 400) * 0.1f;
+        update_spectrum_display(&display, band_db, 1);
+        sink += display.dirty_pages;
+        display.dirty_pages = 0;
+    }
+    check_bench("render_spectrum_frame", BENCH_FRAMES, check_now_ns() - start);
+    (void)sink;
+}
+
+int main(void) {
+    i2c_init(i2c1, 400 * 1000);
+    test_init_stream();
+    test_command_transactions();
+    test_dirty_bytes();
+    test_level_frame();
+    test_fast_paths_match_pixels();
+    bench_render();
+    ssd1306_deinit(&display);
+    return check_report();
+}
@@ -0,0 +1,126 @@
+// Telemetria binária (telemetry.c): cada registro sai num quadro COBS com CRC-16 entre
+// dois 0x00, no máximo TELEMETRY_DRAIN_MAX por chamada, e a fila cheia conta os descartes.
+
+#include <string.h>
+#include "fake_hal.h"
+#include "check.h"
+#include "telemetry.h"
+
+// Mesmo CRC-16/CCITT do firmware e do decodificador.
+static uint16_t crc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+// Decodifica um quadro COBS (sem os delimitadores).
+// @return Quantidade de bytes decodificados, ou 0 se o quadro está malformado
+static size_t cobs_decode(const uint8_t* in, size_t len, uint8_t* out) {
+    size_t i = 0, o = 0;
+    while (i < len) {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > len)
+            return 0;
+        for (uint8_t k = 1; k < code; ++k)
+            out[o++] = in[i++];
+        if (code != 0xFF && i < len)
+            out[o++] = 0;
+    }
+    return o;
+}
+
+// Separa os quadros da saída e confere delimitadores, CRC e tamanho de cada um.
+static uint parse_frames(telemetry_record_t* records, uint max) {
+    size_t len;
+    const uint8_t* out = fake_stdout(&len);
+    uint count = 0;
+    size_t start = 0;
+    while (start < len) {
+        CHECK(out[start] == 0x00);
+        size_t end = start + 1;
+        while (end < len && out[end] != 0x00)
+            ++end;
+        CHECK(end < len);
+
+        uint8_t payload[sizeof(telemetry_record_t) + 8];
+        size_t n = cobs_decode(&out[start + 1], end - start - 1, payload);
+        CHECK(n == sizeof(telemetry_record_t) + 2);
+        uint16_t crc = payload[n - 2] | payload[n - 1] << 8;
+        CHECK(crc == crc16(payload, n - 2));
+        if (count < max)
+            memcpy(&records[count], payload, sizeof(telemetry_record_t));
+        ++count;
+        start = end + 1;
+    }
+    fake_stdout_clear();
+    return count;
+}
+
+static void fill(telemetry_record_t* r, uint32_t n) {
+    memset(r, 0, sizeof(*r));
+    r->type = TELEMETRY_RECORD_FRAME;
+    r->sensitivity = 3;
+    r->timestamp_ms = n * 200;
+    r->rms = 0.01f * n;
+    r->laf = 40.f + n;
+    r->adc_min = -(int16_t)n;
+    r->adc_max = 0; // Zeros no meio do registro exercitam o COBS
+    r->mic_overruns = n;
+}
+
+// Os registros chegam inteiros e em ordem, TELEMETRY_DRAIN_MAX por chamada.
+static void test_round_trip(void) {
+    telemetry_init();
+    fake_stdout_clear();
+    telemetry_record_t r, decoded[4];
+    for (uint32_t n = 1; n <= 3; ++n) {
+        fill(&r, n);
+        CHECK(telemetry_push(&r));
+    }
+
+    CHECK(telemetry_drain() == TELEMETRY_DRAIN_MAX);
+    CHECK(parse_frames(decoded, 4) == TELEMETRY_DRAIN_MAX);
+    CHECK(telemetry_drain() == 1);
+    CHECK(parse_frames(&decoded[2], 2) == 1);
+    CHECK(telemetry_drain() == 0);
+
+    for (uint32_t n = 1; n <= 3; ++n) {
+        fill(&r, n);
+        CHECK(memcmp(&decoded[n - 1], &r, sizeof(r)) == 0);
+    }
+}
+
+// Fila cheia: o registro é descartado e o próximo aceito leva a contagem.
+static void test_queue_full(void) {
+    telemetry_init();
+    fake_stdout_clear();
+    telemetry_record_t r;
+    for (uint32_t n = 0; n < TELEMETRY_QUEUE_SIZE; ++n) {
+        fill(&r, n);
+        CHECK(telemetry_push(&r));
+    }
+    CHECK(!telemetry_push(&r));
+    CHECK(!telemetry_push(&r));
+
+    while (telemetry_drain() > 0)
+        ;
+    static telemetry_record_t decoded[TELEMETRY_QUEUE_SIZE];
+    CHECK(parse_frames(decoded, TELEMETRY_QUEUE_SIZE) == TELEMETRY_QUEUE_SIZE);
+    CHECK(decoded[TELEMETRY_QUEUE_SIZE - 1].telemetry_dropped == 0);
+
+    fill(&r, 99);
+    CHECK(telemetry_push(&r));
+    CHECK(telemetry_drain() == 1);
+    CHECK(parse_frames(decoded, 1) == 1);
+    CHECK(decoded[0].telemetry_dropped == 2 && decoded[0].timestamp_ms == 99 * 200);
+}
+
+int main(void) {
+    test_round_trip();
+    test_queue_full();
+    return check_report();
+}
@@ -0,0 +1,132 @@
+// Gatilho por nível (trigger.c): o histórico guarda as amostras mais recentes e informa
+// quantas descartou, e o LAeq com o roteamento do laço principal (histórico, spl_skip() e
+// spl_process()) conta cada amostra uma vez, igual ao medidor processando tudo.
+
+#include "fake_hal.h"
+#include "check.h"
+#include "mic.h"
+#include "spl.h"
+#include "trigger.h"
+
+#define BLOCK MIC_DECIMATED_MAX_SAMPLES
+
+static float rate;
+
+// Bloco com amostras numeradas a partir de first.
+static void numbered(int16_t* block, uint count, uint32_t first) {
+    for (uint i = 0; i < count; ++i)
+        block[i] = (int16_t)(first + i);
+}
+
+// Rodando, o histórico cheio descarta e conta overflow; armado, descarta sem contar. Em
+// ambos trigger_push() devolve os descartes, e o disparo entrega as mais recentes em ordem.
+static void test_history(void) {
+    static int16_t samples[TRIGGER_HISTORY_SAMPLES];
+    trigger_stats_t stats;
+
+    numbered(samples, TRIGGER_HISTORY_SAMPLES, 0);
+    CHECK(trigger_update(true, 0) == TRIGGER_RUNNING);
+    CHECK(trigger_push(samples, TRIGGER_HISTORY_SAMPLES) == 0);
+    CHECK(trigger_push(samples, BLOCK) == BLOCK);
+    trigger_get_stats(&stats);
+    CHECK(stats.overflows == BLOCK);
+    while (trigger_pop() != NULL)
+        ;
+
+    // Sem som por TRIGGER_HOLD_MS e histórico vazio: armado.
+    CHECK(trigger_update(false, TRIGGER_HOLD_MS) == TRIGGER_ARMED);
+    uint32_t n = 0;
+    uint dropped = 0;
+    for (uint b = 0; b < TRIGGER_HISTORY_SAMPLES / BLOCK + 3; ++b, n += BLOCK) {
+        int16_t block[BLOCK];
+        numbered(block, BLOCK, n);
+        dropped += trigger_push(block, BLOCK);
+    }
+    CHECK(dropped == 3 * BLOCK);
+    trigger_get_stats(&stats);
+    CHECK(stats.overflows == BLOCK);
+
+    CHECK(trigger_update(true, TRIGGER_HOLD_MS + 1) == TRIGGER_FIRED);
+    const int16_t* chunk;
+    uint32_t expected = 3 * BLOCK;
+    bool in_order = true;
+    while ((chunk = trigger_pop()) != NULL) {
+        for (uint i = 0; i < MIC_DECIMATED_SAMPLES; ++i, ++expected)
+            in_order = in_order && chunk[i] == (int16_t)expected;
+    }
+    CHECK(in_order && expected == n);
+}
+
+// Um bloco do ADC pelo caminho do laço principal, com um bloco de recuperação por vez.
+static trigger_state_t route_block(const int16_t* block, bool loud, uint32_t now_ms) {
+    trigger_state_t state = trigger_update(loud, now_ms);
+    spl_skip(trigger_push(block, BLOCK));
+    if (state == TRIGGER_ARMED)
+        return state;
+
+    const int16_t* chunk;
+    for (uint n = 0; n < BLOCK / MIC_DECIMATED_SAMPLES + 1 && (chunk = trigger_pop()) != NULL; ++n)
+        spl_process(chunk, MIC_DECIMATED_SAMPLES);
+    return state;
+}
+
+// Blocos de um seno de 1 kHz (som) ou zeros (silêncio).
+static void make_block(int16_t* block, bool loud, uint64_t first) {
+    for (uint i = 0; i < BLOCK; ++i)
+        block[i] = loud ? (int16_t)lroundf(8000.f * sinf(6.28318531f * 1000.f * (float)((first + i) % 1000000) / rate)) : 0;
+}
+
+// 0,5 s de som, 2,5 s de silêncio (armado nos últimos ~0,5 s) e 0,5 s de som: o LAeq pelo
+// gatilho é o do medidor processando tudo. Contar o histórico duas vezes (o descarte
+// armado mais o replay no disparo) somaria 2048 amostras de silêncio, uns 0,05 dB a menos.
+static void test_laeq_counts_once(void) {
+    const float phases[][2] = {{1.f, 0.5f}, {0.f, 2.5f}, {1.f, 0.5f}};
+    spl_levels_t routed, reference;
+
+    for (int pass = 0; pass < 2; ++pass) {
+        spl_init(rate);
+        trigger_update(true, 0);
+        while (trigger_pop() != NULL)
+            ;
+
+        uint64_t n = 0;
+        uint armed_blocks = 0;
+        for (uint p = 0; p < 3; ++p) {
+            bool loud = phases[p][0] > 0.f;
+            uint blocks = (uint)(phases[p][1] * rate / BLOCK);
+            for (uint b = 0; b < blocks; ++b, n += BLOCK) {
+                int16_t block[BLOCK];
+                make_block(block, loud, n);
+                if (pass == 0) {
+                    armed_blocks += route_block(block, loud, (uint32_t)(n * 1000 / rate)) == TRIGGER_ARMED;
+                } else {
+                    for (uint i = 0; i < BLOCK; i += MIC_DECIMATED_SAMPLES)
+                        spl_process(&block[i], MIC_DECIMATED_SAMPLES);
+                }
+            }
+        }
+
+        // O que sobrou no histórico é processado, como nos blocos seguintes.
+        const int16_t* chunk;
+        while (pass == 0 && (chunk = trigger_pop()) != NULL)
+            spl_process(chunk, MIC_DECIMATED_SAMPLES);
+
+        if (pass == 0) {
+            CHECK(armed_blocks * BLOCK > TRIGGER_HISTORY_SAMPLES); // O histórico encheu armado.
+            spl_get_levels(&routed);
+        } else {
+            spl_get_levels(&reference);
+        }
+    }
+
+    CHECK_NEAR(routed.laeq, reference.laeq, 0.02);
+    printf("trigger: LAeq pelo gatilho %.3f dB, processando tudo %.3f dB\n", routed.laeq, reference.laeq);
+}
+
+int main(void) {
+    mic_init();
+    rate = mic_get_decimated_rate();
+    test_history();
+    test_laeq_counts_once();
+    return check_report();
+}
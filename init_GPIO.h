@@ -1,10 +1,10 @@
 #ifndef INIT_GPIO_H
 #define INIT_GPIO_H
 
-#define DEBOUNCE_TIME 200
 #define I2C_PORT i2c1
 #define I2C_SDA 14
 #define I2C_SCL 15
+#define I2C_BAUDRATE (400 * 1000)
 #define BOTAO_A 5
 #define BOTAO_B 6
 
@@ -1,4 +1,6 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
 #include "ssd1306.h"
@@ -11,6 +13,22 @@
 #include "mic.h"
 #include "math.h"
 #include "init_GPIO.h"
+#include "pipeline.h"
+#include "pico/multicore.h"
+#include "spectrum.h"
+#include "spl.h"
+#include "bench.h"
+#include "telemetry.h"
+#include "scheduler.h"
+#include "power.h"
+#include "trigger.h"
+#include "channels.h"
+#include "recorder.h"
+#include "console.h"
+#include "flash_store.h"
+#include "settings.h"
+#include "calibration.h"
+#include "log.h"
 
 ssd1306_t display;
 
@@ -19,10 +37,33 @@ void i2c_setup(void);
 void npInit(uint pin);
 void update_full_display(ssd1306_t *display, float db_value, uint8_t sensitivity);
 void draw_progress_bar(ssd1306_t *display, uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t progress);
-void update_led_matrix(float db);
+void update_led_matrix(float db, uint8_t sensitivity);
+void update_spectrum_display(ssd1306_t *display, const float band_db[SPECTRUM_BANDS], uint8_t sensitivity);
+void update_led_spectrum(const float band_db[SPECTRUM_BANDS], uint8_t sensitivity);
+void core1_render_loop(void);
+static void handle_button(uint8_t pino, botao_evento_t evento);
+static uint8_t spectrum_bar_height(float db, uint8_t sensitivity);
+static void apply_power_state(power_state_t state, power_state_t previous);
+static uint sensitivity_range(uint8_t sensitivity);
+static float quiet_level_db(uint8_t sensitivity);
+static float loud_level_db(uint8_t sensitivity);
+static void register_commands(void);
+static void load_settings(void);
+static void apply_calibration(const calibration_result_t* result);
+
+// Telas disponíveis no display e na matriz de LEDs
+typedef enum {
+    VIEW_LEVEL,    // Nível geral em dB e barra de progresso
+    VIEW_SPECTRUM  // Nível por banda de oitava
+} view_mode_t;
 
 // Variáveis globais
 uint8_t sensitivity_level = 1; // Nível de sensibilidade (1 a 5)
+view_mode_t view_mode = VIEW_LEVEL; // Tela exibida
+float threshold = 0.5f;             // Limiar associado ao nível de sensibilidade
+
+// Fonte do nível exibido. Escrita pelo comando C no núcleo 1 e lida pelo núcleo 0 ao fechar o quadro.
+volatile channels_source_t display_source = CHANNELS_SOURCE_MIC;
 
 // Faixas de dB e cores para cada nível
 const struct {
@@ -38,12 +79,13 @@ const struct {
 };
 
 int main() {
+    power_init(); // Antes da UART e do I2C: fixa o clock dos periféricos.
     stdio_init_all();
 
     // Inicializações
-    botao_init(BOTAO_A);
-    botao_init(BOTAO_B);
-    uint dma_channel = mic_init();
+    botao_init(BOTAO_A, true);
+    botao_init(BOTAO_B, false);
+    mic_init();
     
     // Configura LEDs
     npInit(LED_PIN);
@@ -60,43 +102,526 @@ int main() {
     sleep_ms(1000);
     ssd1306_clear_display(&display);
 
-    // Buffer de amostras
-    uint16_t adc_buffer[SAMPLES];
-    mic_sample(adc_buffer, dma_channel);
+    // A partir daqui o display e a matriz de LEDs pertencem ao núcleo 1.
+    pipeline_init();
+    telemetry_init();
+    scheduler_init();
+    recorder_init(mic_get_decimated_rate());
+    settings_init();
+    load_settings();
+    register_commands();
+    multicore_launch_core1(core1_render_loop);
+    flash_store_core_init(); // O núcleo 1 grava os eventos na flash pausando este núcleo.
+
+    // Captura contínua: todos os blocos do ADC entram na medição, inclusive
+    // os que chegam enquanto o display e os LEDs são atualizados.
+    spectrum_init(mic_get_decimated_rate());
+    spl_init(mic_get_decimated_rate());
+    trigger_set_level(quiet_level_db(sensitivity_level));
+    channels_init();
+    mic_start_continuous();
+    bench_init_core();
+
+    uint64_t frame_sum_squared = 0;
+    uint32_t frame_count = 0;
+    int32_t frame_min = INT32_MAX, frame_max = INT32_MIN;
+    float band_db[SPECTRUM_BANDS] = {0};
+    int16_t decimated[MIC_DECIMATED_MAX_SAMPLES];
 
     while (true) {
-        mic_sample(adc_buffer, dma_channel);
-        float rms = mic_power(adc_buffer);
-        float rms_voltage = fabs(rms);
-        float db = mic_rms_to_db(rms_voltage);
-        
-        printf("dB: %.1f, Sens: %d\n", db, sensitivity_level);
-        
-        update_full_display(&display, db, sensitivity_level);
-        
-        npClear();
-        update_led_matrix(db);
-        npWrite();
-        
-        sleep_ms(200);
+        uint32_t t = bench_start();
+        const uint16_t* adc_buffer = mic_wait_ready_buffer();
+        bench_stop(BENCH_MIC_WAIT, t);
+
+        // Potência e extremos do bloco em inteiros; a conversão para Volts fica para o fim do quadro.
+        t = bench_start();
+        // Com várias entradas o bloco é intercalado; cada uma é lida no lugar, sem cópia.
+        mic_block_stats_t block;
+        mic_block_stats(mic_channel_samples(adc_buffer, MIC_CHANNEL), SAMPLES, mic_channel_count(), &block);
+        mic_remove_dc(&block); // O ponto médio real deriva com a polarização do microfone.
+        channels_accumulate(adc_buffer, &block);
+        bench_stop(BENCH_MIC_POWER, t);
+        frame_sum_squared += block.sum_squared;
+        frame_count += block.count;
+        if (block.min < frame_min) frame_min = block.min;
+        if (block.max > frame_max) frame_max = block.max;
+
+        // Primeiro estágio, em inteiros: pico e energia do bloco contra o limiar da sensibilidade.
+        // Ao sair de IDLE o ADC volta ao normal aqui e o núcleo 1 devolve o clock em seguida.
+        bool loud = trigger_block_is_loud(&block);
+        uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+        power_state_t power = power_update(loud, now_ms);
+        trigger_state_t trigger = trigger_update(loud, now_ms);
+
+        // Medidor (ponderações A/C e Fast/Slow/Leq) e espectro usam o fluxo decimado,
+        // que passa sempre pelo histórico do gatilho.
+        t = bench_start();
+        uint count = mic_decimate(adc_buffer, decimated);
+        uint dropped = trigger_push(decimated, count);
+        bench_stop(BENCH_MIC_DECIMATE, t);
+
+        // Calibração pedida pelo console (comando K): mede o mesmo bloco, sem desviar o fluxo.
+        calibration_result_t calibration;
+        if (calibration_feed(&block, decimated, count, now_ms, &calibration))
+            apply_calibration(&calibration);
+
+        // O gravador recebe o fluxo decimado sempre, inclusive armado: a janela anterior
+        // ao disparo é o que antecedeu o evento.
+        recorder_feed(decimated, count);
+        recorder_set_quiet(trigger == TRIGGER_ARMED);
+        settings_set_quiet(trigger == TRIGGER_ARMED);
+
+        // O LAeq conta cada amostra uma vez: as que saíram do histórico sem processamento
+        // entram com o último nível Fast; as que continuam nele, quando forem processadas.
+        spl_skip(dropped);
+
+        // Armado (silêncio), filtros e FFT ficam parados; o histórico guarda o início do próximo evento.
+        if (trigger != TRIGGER_ARMED) {
+            // Processa primeiro o histórico (o que antecedeu o disparo) e depois o bloco atual.
+            // Pelo menos o equivalente ao bloco atual é processado; o atraso acumulado só avança
+            // enquanto o próximo bloco do ADC não chegou, para o catch-up não causar overruns.
+            // As constantes Fast/Slow do medidor valem por bloco de MIC_DECIMATED_SAMPLES,
+            // então tudo é processado nesse tamanho.
+            const int16_t* chunk;
+            uint min_chunks = count / MIC_DECIMATED_SAMPLES;
+            for (uint n = 0; (n < min_chunks || !mic_block_ready()) && (chunk = trigger_pop()) != NULL; ++n) {
+                t = bench_start();
+                spl_process(chunk, MIC_DECIMATED_SAMPLES);
+                bench_stop(BENCH_SPL, t);
+
+                // Em IDLE o display está desligado e o espectro não é calculado.
+                t = bench_start();
+                if (power != POWER_IDLE && spectrum_feed(chunk, MIC_DECIMATED_SAMPLES))
+                    spectrum_compute(band_db);
+                bench_stop(BENCH_SPECTRUM, t);
+            }
+        }
+
+        // Botões tratados aqui, no mesmo contexto que lê sensitivity_level e view_mode.
+        uint8_t pino;
+        botao_evento_t evento;
+        while (botao_proximo_evento(&pino, &evento))
+            handle_button(pino, evento);
+
+        // O quadro fecha no prazo do timer, não depois de um sleep: o período não
+        // depende de quanto tempo a captura, o I2C ou a PIO levaram.
+        if (!scheduler_due(SCHEDULER_FRAME))
+            continue;
+
+        // RMS do quadro inteiro a partir da soma dos quadrados de todos os blocos.
+        float rms_voltage = sqrtf((float)frame_sum_squared / frame_count) * ADC_VOLTS_PER_COUNT;
+        int32_t adc_min = frame_min, adc_max = frame_max;
+        frame_sum_squared = 0;
+        frame_count = 0;
+        frame_min = INT32_MAX;
+        frame_max = INT32_MIN;
+
+        spl_levels_t levels;
+        spl_get_levels(&levels);
+
+        // Nível exibido: microfone da placa, externo ou o maior deles.
+        channels_levels_t channel_levels;
+        channels_close_frame(&channel_levels, time_us_32());
+        channels_source_t source = display_source;
+        float db = channels_display_db(&channel_levels, source, levels.laf);
+
+        // Acima da faixa da sensibilidade, além de piscar a matriz, o trecho do microfone
+        // da placa vai para a flash.
+        recorder_update(levels.laf, loud_level_db(sensitivity_level), to_ms_since_boot(get_absolute_time()));
+
+        measurement_t m = {
+            .timestamp_ms = to_ms_since_boot(get_absolute_time()),
+            .rms = rms_voltage,
+            .db = db,
+            .spl = levels,
+            .sensitivity = sensitivity_level,
+            .view = view_mode,
+            .power = power,
+        };
+        memcpy(m.band_db, band_db, sizeof(band_db));
+
+        pipeline_stats_t stats;
+        pipeline_get_stats(&stats);
+        scheduler_stats_t frame_stats, led_stats;
+        scheduler_get_stats(SCHEDULER_FRAME, &frame_stats);
+        scheduler_get_stats(SCHEDULER_LED, &led_stats);
+        trigger_stats_t trigger_stats;
+        trigger_get_stats(&trigger_stats);
+
+        // Registro binário enviado pelo núcleo 1; nada é formatado no laço de medição.
+        telemetry_record_t record = {
+            .type = TELEMETRY_RECORD_FRAME,
+            .sensitivity = sensitivity_level,
+            .view = view_mode,
+            .power = power,
+            .timestamp_ms = m.timestamp_ms,
+            .rms = rms_voltage,
+            .laf = levels.laf,
+            .las = levels.las,
+            .lcf = levels.lcf,
+            .laeq = levels.laeq,
+            .lafmax = levels.lafmax,
+            .lafmin = levels.lafmin,
+            .adc_min = (int16_t)adc_min,
+            .adc_max = (int16_t)adc_max,
+            .mic_overruns = mic_get_overruns(),
+            .pipeline_dropped = stats.dropped,
+            .frame_overruns = frame_stats.overruns,
+            .led_overruns = led_stats.overruns,
+            .trigger_fired = trigger_stats.fired,
+            .armed_blocks = trigger_stats.armed_blocks,
+            .spl_load = (uint16_t)(spl_get_load() * 1000.0f),
+            .temperature_c = channel_levels.temperature_c,
+            .channel_rate = channel_levels.rate,
+            .channel_mask = (uint8_t)mic_get_channels(),
+            .source = source,
+            .dc_offset = mic_get_dc_offset(),
+        };
+        memcpy(record.input_db, channel_levels.db, sizeof(record.input_db));
+        for (int stage = 0; stage < BENCH_STAGES; stage++)
+            record.stage_us[stage] = bench_last_us(stage);
+        telemetry_push(&record);
+
+        // Publica por último: o __sev() da fila acorda o núcleo 1 para desenhar e enviar a telemetria.
+        pipeline_push(&m);
+
+        LOG_DEBUG("dB: %.1f, Sens: %d, LAS: %.1f, LCF: %.1f, LAeq: %.1f, LAFmax: %.1f, LAFmin: %.1f, Carga SPL: %.1f%%, "
+                  "Fila: %lu, Perdidos: %lu, Pulados: %lu, Overruns: %lu, Quadros atrasados: %lu (máx %lu us)\n",
+                  db, sensitivity_level, levels.las, levels.lcf, levels.laeq, levels.lafmax, levels.lafmin,
+                  spl_get_load() * 100.0f, (unsigned long)stats.occupancy, (unsigned long)stats.dropped,
+                  (unsigned long)stats.skipped, (unsigned long)mic_get_overruns(),
+                  (unsigned long)frame_stats.overruns, (unsigned long)frame_stats.max_latency_us);
+    }
+}
+
+/**
+ * Ações dos botões. A: clique muda a sensibilidade, clique longo troca a tela e
+ * clique duplo reinicia LAeq/LAFmax/LAFmin. B: entra no modo bootsel.
+ */
+static void handle_button(uint8_t pino, botao_evento_t evento) {
+    // Qualquer botão acorda o dispositivo; o clique também executa a ação normal.
+    power_wake(to_ms_since_boot(get_absolute_time()));
+
+    if (pino == BOTAO_B) {
+        LOG_INFO("Botão B pressionado\n");
+        reset_usb_boot(0, 0); // Entra no modo bootsel
+        return;
+    }
+
+    switch (evento) {
+        case BOTAO_CLIQUE:
+            sensitivity_level = (sensitivity_level % 5) + 1; // Cicla entre 1 e 5.
+            threshold = sensitivity_level * 0.1f;            // Ajusta o limiar com base no nível.
+            trigger_set_level(quiet_level_db(sensitivity_level));
+            settings_set(SETTINGS_SENSITIVITY, sensitivity_level);
+            LOG_INFO("Sensibilidade ajustada: %d, Limiar: %.2f\n", sensitivity_level, threshold);
+            break;
+        case BOTAO_LONGO:
+            view_mode = view_mode == VIEW_LEVEL ? VIEW_SPECTRUM : VIEW_LEVEL;
+            settings_set(SETTINGS_VIEW, view_mode);
+            break;
+        case BOTAO_CLIQUE_DUPLO:
+            spl_reset();
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Índice em SENSITIVITY_RANGES para um nível de sensibilidade. O nível vai de 1 a 5 e a
+ * tabela tem 5 entradas, então o nível 5 usa a última.
+ */
+static uint sensitivity_range(uint8_t sensitivity) {
+    return sensitivity < 5 ? sensitivity : 4;
+}
+
+/**
+ * Nível abaixo do qual a sala é considerada silenciosa: o início da faixa exibida
+ * na sensibilidade atual (abaixo dele nenhum LED acende).
+ */
+static float quiet_level_db(uint8_t sensitivity) {
+    return SENSITIVITY_RANGES[sensitivity_range(sensitivity)].min_db;
+}
+
+/**
+ * Nível acima do qual a matriz de LEDs pisca e o evento é gravado: o fim da faixa
+ * exibida na sensibilidade atual.
+ */
+static float loud_level_db(uint8_t sensitivity) {
+    return SENSITIVITY_RANGES[sensitivity_range(sensitivity)].max_db;
+}
+
+static void command_list_events(const char* args) {
+    (void)args;
+    recorder_print_index();
+}
+
+static void command_dump_event(const char* args) {
+    if (!recorder_dump(strtoul(args, NULL, 10)))
+        LOG_ERROR("Evento %s não encontrado\n", args);
+}
+
+static void command_select_source(const char* args) {
+    unsigned long source = strtoul(args, NULL, 10);
+    if (source >= CHANNELS_SOURCES) {
+        LOG_ERROR("Fonte %s inválida (0 placa, 1 externo, 2 maior)\n", args);
+        return;
+    }
+    display_source = (channels_source_t)source;
+    settings_set(SETTINGS_SOURCE, source);
+}
+
+static void command_calibrate(const char* args) {
+    char* end;
+    float reference_db = strtof(args, &end);
+    if (end == args)
+        reference_db = CALIBRATION_REFERENCE_DB;
+    if (reference_db < 40.f || reference_db > 130.f) {
+        LOG_ERROR("Nível de referência %s inválido\n", args);
+        return;
+    }
+
+    LOG_INFO("Calibrando com %.1f dB em %.0f Hz...\n", reference_db, CALIBRATION_FREQUENCY_HZ);
+    calibration_request(reference_db);
+}
+
+static void command_print_settings(const char* args) {
+    (void)args;
+    settings_print();
+}
+
+static void command_power_report(const char* args) {
+    (void)args;
+    power_print_residency();
+}
+
+/**
+ * Comandos de texto recebidos pelo USB/UART, executados no núcleo 1:
+ * L lista os eventos gravados, D <seq> envia um deles, C <n> escolhe a fonte do nível
+ * exibido (0 microfone da placa, 1 externo, 2 o maior), K [dB] calibra com o tom do
+ * calibrador (94 dB se omitido), S mostra as configurações e P o tempo em cada estado
+ * de energia.
+ */
+static void register_commands(void) {
+    console_register("L", command_list_events);
+    console_register("D", command_dump_event);
+    console_register("C", command_select_source);
+    console_register("K", command_calibrate);
+    console_register("S", command_print_settings);
+    console_register("P", command_power_report);
+}
+
+/**
+ * Aplica e grava o resultado de uma calibração aceita. Núcleo 0, dono dos fatores de
+ * mic_rms_to_db() e das chaves de calibração.
+ */
+static void apply_calibration(const calibration_result_t* result) {
+    static const char* const STATUS[] = {"ok", "saturado", "instavel", "frequencia", "ganho"};
+
+    LOG_INFO("CALIBRATION,%s,%.1f,%.2f,%.2f,%.0f,%.4f,%.3f,%d\n", STATUS[result->status], result->reference_db,
+             result->measured_db, result->spread_db, result->frequency_hz, result->gain, result->offset,
+             result->two_point);
+    if (result->status != CALIBRATION_OK)
+        return;
+
+    mic_set_calibration(result->gain, result->offset);
+    trigger_set_level(quiet_level_db(sensitivity_level)); // O limiar em contagens depende dos fatores.
+    settings_set_float(SETTINGS_CAL_GAIN, result->gain);
+    settings_set_float(SETTINGS_CAL_OFFSET, result->offset);
+}
+
+/**
+ * Restaura a sensibilidade, a tela, a fonte e a calibração gravadas. Valores fora da faixa (chave
+ * gravada por outra versão do firmware) são ignorados.
+ */
+static void load_settings(void) {
+    uint32_t sensitivity = settings_get(SETTINGS_SENSITIVITY, sensitivity_level);
+    if (sensitivity >= 1 && sensitivity <= 5 && sensitivity != sensitivity_level) {
+        sensitivity_level = sensitivity;
+        threshold = sensitivity_level * 0.1f;
+    }
+
+    uint32_t view = settings_get(SETTINGS_VIEW, view_mode);
+    if (view <= VIEW_SPECTRUM)
+        view_mode = (view_mode_t)view;
+
+    uint32_t source = settings_get(SETTINGS_SOURCE, display_source);
+    if (source < CHANNELS_SOURCES)
+        display_source = (channels_source_t)source;
+
+    float gain = settings_get_float(SETTINGS_CAL_GAIN, MIC_DB_GAIN_DEFAULT);
+    float offset = settings_get_float(SETTINGS_CAL_OFFSET, MIC_DB_OFFSET_DEFAULT);
+    if (gain >= CALIBRATION_GAIN_MIN && gain <= CALIBRATION_GAIN_MAX && isfinite(offset))
+        mic_set_calibration(gain, offset);
+}
+
+/**
+ * Aplica ao display e à matriz de LEDs o estado de energia publicado pelo núcleo 0.
+ * O ADC já foi ajustado por power_update(); o clock é trocado no laço do núcleo 1.
+ */
+static void apply_power_state(power_state_t state, power_state_t previous) {
+    if (previous == POWER_IDLE)
+        ssd1306_power_on(&display);
+
+    switch (state) {
+        case POWER_ACTIVE:
+            ssd1306_set_contrast(&display, 0xFF);
+            break;
+        case POWER_QUIET:
+            ssd1306_set_contrast(&display, POWER_QUIET_CONTRAST);
+            break;
+        case POWER_IDLE:
+            npClear();
+            npWrite();
+            ssd1306_power_off(&display);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Diz se a medição nova muda algo visível no display em relação à que está desenhada.
+ */
+static bool display_needs_redraw(const measurement_t* m, const measurement_t* shown) {
+    if (m->view != shown->view || m->sensitivity != shown->sensitivity)
+        return true;
+
+    if (m->view == VIEW_SPECTRUM) {
+        for (int band = 0; band < SPECTRUM_BANDS; band++) {
+            if (spectrum_bar_height(m->band_db[band], m->sensitivity) !=
+                spectrum_bar_height(shown->band_db[band], shown->sensitivity))
+                return true;
+        }
+        return false;
+    }
+
+    // O valor é exibido com uma casa decimal; a barra e a classificação derivam dele.
+    return lroundf(m->db * 10.0f) != lroundf(shown->db * 10.0f);
+}
+
+/**
+ * Laço do núcleo 1: desenha no display e na matriz de LEDs a medição mais recente.
+ * Uma transferência I2C lenta atrasa só o desenho, nunca a captura no núcleo 0.
+ * O display só é redesenhado quando o valor exibido muda; a matriz segue o próprio
+ * período (SCHEDULER_LED_PERIOD_MS) para o efeito de piscar.
+ */
+void core1_render_loop(void) {
+    measurement_t m;
+    measurement_t shown = {0}; // Só comparado depois de has_shown
+    bool has_measurement = false;
+    bool has_shown = false;
+    power_state_t power = POWER_ACTIVE;
+    uint led_ticks = 0;
+
+    bench_init_core();
+
+    while (true) {
+        bool idle = telemetry_drain() == 0;
+        if (console_poll())
+            idle = false;
+        uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+        if (recorder_task(now_ms))
+            idle = false;
+        if (settings_task(now_ms))
+            idle = false;
+
+        if (pipeline_pop_latest(&m)) {
+            has_measurement = true;
+            idle = false;
+
+            if (m.power != power) {
+                apply_power_state(m.power, power);
+                power = m.power;
+            }
+
+            // Em IDLE o display está desligado; o conteúdo é atualizado ao acordar.
+            if (power != POWER_IDLE && (!has_shown || display_needs_redraw(&m, &shown))) {
+                // Ao trocar de tela o display é apagado por inteiro uma vez.
+                if (has_shown && m.view != shown.view)
+                    ssd1306_clear_display(&display);
+
+                uint32_t t = bench_start();
+                if (m.view == VIEW_SPECTRUM)
+                    update_spectrum_display(&display, m.band_db, m.sensitivity);
+                else
+                    update_full_display(&display, m.db, m.sensitivity);
+                bench_stop(BENCH_DISPLAY_DRAW, t);
+
+                // Envia por DMA e volta logo; o próximo quadro pode ser desenhado durante a transferência
+                t = bench_start();
+                ssd1306_update_async(&display);
+                bench_stop(BENCH_SSD1306_UPDATE, t);
+
+                shown = m;
+                has_shown = true;
+            }
+        }
+
+        // Em QUIET a matriz é atualizada só a cada POWER_QUIET_LED_DIVIDER prazos; em IDLE fica apagada.
+        bool led_due = scheduler_due(SCHEDULER_LED) &&
+                       (power == POWER_ACTIVE || (power == POWER_QUIET && ++led_ticks % POWER_QUIET_LED_DIVIDER == 0));
+        if (led_due && has_measurement) {
+            idle = false;
+
+            uint32_t t = bench_start();
+            npClear();
+            if (m.view == VIEW_SPECTRUM)
+                update_led_spectrum(m.band_db, m.sensitivity);
+            else
+                update_led_matrix(m.db, m.sensitivity);
+            bench_stop(BENCH_LED_MATRIX, t);
+
+            t = bench_start();
+            npWrite();
+            bench_stop(BENCH_NP_WRITE, t);
+        }
+
+        // Troca do clk_sys pedida pelo núcleo 0: só com o I2C e a PIO parados, para nenhum
+        // byte ou bit sair com o divisor do clock antigo. Até lá o laço não dorme.
+        if (power_clock_pending()) {
+            idle = false;
+            if (ssd1306_update_done(&display) && npIdle())
+                power_apply_clock();
+        }
+
+        // Dorme até o núcleo 0 publicar uma medição ou o timer da matriz vencer (ambos dão __sev()).
+        if (idle)
+            __wfe();
+    }
+}
+
+/**
+ * Cor de uma linha da matriz de LEDs de acordo com a altura.
+ */
+static void level_row_color(int y, uint8_t *red, uint8_t *green, uint8_t *blue) {
+    if (y == 0) {           // Primeira linha - verde
+        *red = 0; *green = 30; *blue = 0;
+    } 
+    else if (y <= 2) {      // Linhas 2 e 3 - amarelo
+        *red = 50; *green = 50; *blue = 0;
+    } 
+    else {                  // Linhas 4 e 5 - vermelho
+        *red = 80; *green = 0; *blue = 0;
     }
 }
 
-void update_led_matrix(float db) {
+void update_led_matrix(float db, uint8_t sensitivity) {
     if (db < 0) return;
 
     // O nível de sensibilidade não deve alterar o valor do dB, apenas a exibição dos LEDs.
     // Ajuste especial para o nível 5 (sensibilidade máxima)
-    float min_db = SENSITIVITY_RANGES[sensitivity_level].min_db;
-    float max_db = SENSITIVITY_RANGES[sensitivity_level].max_db;
+    float min_db = SENSITIVITY_RANGES[sensitivity_range(sensitivity)].min_db;
+    float max_db = SENSITIVITY_RANGES[sensitivity_range(sensitivity)].max_db;
     
     // Se for nível 5 e estiver abaixo do mínimo, mostra pelo menos 1 LED
-    if (sensitivity_level == 5 && db < min_db) {
+    if (sensitivity == 5 && db < min_db) {
         db = min_db;
     }
     
     // Atualiza indicador de sensibilidade (colunas 3 e 4)
-    for (int y = 0; y < sensitivity_level; y++) {
+    for (int y = 0; y < sensitivity; y++) {
         setLEDxy(3, y, 0, 30, 70); // Azul claro
         setLEDxy(4, y, 0, 30, 70);
     }
@@ -112,16 +637,8 @@ void update_led_matrix(float db) {
     for (int y = 0; y < rows_to_light; y++) {
         uint8_t red, green, blue;
         
-        // Cores baseadas na altura:
-        if (y == 0) {           // Primeira linha - verde
-            red = 0; green = 30; blue = 0;
-        } 
-        else if (y <= 2) {      // Linhas 2 e 3 - amarelo
-            red = 50; green = 50; blue = 0;
-        } 
-        else {                  // Linhas 4 e 5 - vermelho
-            red = 80; green = 0; blue = 0;
-        }
+        // Cores baseadas na altura
+        level_row_color(y, &red, &green, &blue);
         
         // Efeito de alerta se exceder o máximo
         if (db > max_db) {
@@ -138,10 +655,71 @@ void update_led_matrix(float db) {
 }
 
 
+/**
+ * Mostra o nível de cada banda de oitava em uma coluna da matriz de LEDs,
+ * com as frequências graves à esquerda.
+ */
+void update_led_spectrum(const float band_db[SPECTRUM_BANDS], uint8_t sensitivity) {
+    float min_db = SENSITIVITY_RANGES[sensitivity_range(sensitivity)].min_db;
+    float max_db = SENSITIVITY_RANGES[sensitivity_range(sensitivity)].max_db;
+
+    for (int band = 0; band < SPECTRUM_BANDS; band++) {
+        float position = (band_db[band] - min_db) / (max_db - min_db);
+        position = position < 0 ? 0 : (position > 1 ? 1 : position);
+        uint8_t rows_to_light = (uint8_t)(position * 5.0f);
+
+        for (int y = 0; y < rows_to_light; y++) {
+            uint8_t red, green, blue;
+            level_row_color(y, &red, &green, &blue);
+            setLEDxy(4 - band, y, red, green, blue); // x = 0 é a coluna da direita
+        }
+    }
+}
+
+// Área das barras do espectro no display.
+#define SPECTRUM_BAR_TOP 16
+#define SPECTRUM_BAR_BOTTOM 54
+
+/**
+ * Altura em pixels da barra de uma banda no display.
+ */
+static uint8_t spectrum_bar_height(float db, uint8_t sensitivity) {
+    float display_max_db = SENSITIVITY_RANGES[sensitivity_range(sensitivity)].max_db * 1.2f;
+    float fraction = db / display_max_db;
+    fraction = fraction < 0 ? 0 : (fraction > 1 ? 1 : fraction);
+    return (uint8_t)(fraction * (SPECTRUM_BAR_BOTTOM - SPECTRUM_BAR_TOP));
+}
+
+/**
+ * Desenha no display um gráfico de barras com o nível de cada banda de oitava.
+ */
+void update_spectrum_display(ssd1306_t *display, const float band_db[SPECTRUM_BANDS], uint8_t sensitivity) {
+    static const char *labels[SPECTRUM_BANDS] = {"250", "500", "1k", "2k", "4k"};
+    const uint8_t bar_top = SPECTRUM_BAR_TOP, bar_bottom = SPECTRUM_BAR_BOTTOM, bar_width = 20;
+
+    // Cabeçalho
+    ssd1306_draw_string(display, "ESPECTRO", 40, 2);
+    ssd1306_draw_line(display, 0, 12, 127, 12);
+
+    for (uint8_t band = 0; band < SPECTRUM_BANDS; band++) {
+        uint8_t x = 4 + band * 25;
+        uint8_t height = spectrum_bar_height(band_db[band], sensitivity);
+
+        ssd1306_clear_rectangle(display, x, bar_top, x + bar_width, bar_bottom);
+        ssd1306_draw_filled_rectangle(display, x, bar_bottom - height, x + bar_width, bar_bottom);
+
+        uint8_t label_x = x + (bar_width - strlen(labels[band]) * 6) / 2;
+        ssd1306_draw_string(display, labels[band], label_x, 56);
+    }
+}
+
 void update_full_display(ssd1306_t *display, float db_value, uint8_t sensitivity) {
-    float display_max_db = SENSITIVITY_RANGES[sensitivity].max_db * 1.2f;
+    float display_max_db = SENSITIVITY_RANGES[sensitivity_range(sensitivity)].max_db * 1.2f;
     
-    ssd1306_clear_display(display);
+    // Só as áreas que mudam entre quadros são apagadas, assim o ssd1306_update()
+    // envia apenas as páginas e colunas alteradas.
+    ssd1306_clear_rectangle(display, 0, 20, display->width, 28);
+    ssd1306_clear_rectangle(display, 0, 46, display->width, 54);
     
     // Cabeçalho
     ssd1306_draw_string(display, "NIVEL DE RUIDO", 15, 2);
@@ -172,13 +750,14 @@ void update_full_display(ssd1306_t *display, float db_value, uint8_t sensitivity
     for(uint8_t i = 0; i < 5; i++) {
         ssd1306_draw_char(display, i < sensitivity ? 0xFF : '-', 50 + i*10, 56);
     }
-    
-    ssd1306_update(display);
 }
 
 void draw_progress_bar(ssd1306_t *display, uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t progress) {
     // Borda
     ssd1306_draw_empty_rectangle(display, x, y, x+width, y+height);
+
+    // Apaga o interior antes de desenhar o novo preenchimento
+    ssd1306_clear_rectangle(display, x+1, y+1, x+width, y+height);
     
     // Preenchimento
     uint8_t fill_width = (progress * (width-4)) / 100;
@@ -186,7 +765,7 @@ void draw_progress_bar(ssd1306_t *display, uint8_t x, uint8_t y, uint8_t width,
 }
 
 void i2c_setup(void) {
-    i2c_init(I2C_PORT, 400 * 1000);
+    i2c_init(I2C_PORT, I2C_BAUDRATE);
     gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
     gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
     gpio_pull_up(I2C_SDA);
@@ -203,6 +782,6 @@ void npInit(uint pin) {
         sm = pio_claim_unused_sm(np_pio, true);
     }
     
-    ws2818b_program_init(np_pio, sm, offset, pin, 800000.f);
+    ws2818b_program_init(np_pio, sm, offset, pin, NP_BIT_FREQ);
     npMatrizInit(np_pio, sm);
 }
\ No newline at end of file
@@ -10,6 +10,9 @@
 #define LED_COUNT 25
 #define LED_PIN 7
 
+// Frequência dos bits enviados aos WS2812 (cada bit leva 10 ciclos da PIO).
+#define NP_BIT_FREQ 800000.f
+
 // Definição da estrutura para representar um pixel em formato GRB (Green, Red, Blue).
 struct pixel_t {
     uint8_t G, R, B; // Cada valor de 8 bits representa a intensidade da cor (G, R, B) do pixel.
@@ -25,15 +28,21 @@ static uint sm; // Máquina de estados para controle do PIO.
 // Função para inicializar a matriz de LEDs, configurando o PIO e a máquina de estados.
 void npMatrizInit(const PIO pio_info, const uint sm_info);
 
+// Função para recalcular o divisor de clock da PIO depois de uma mudança no clk_sys.
+void npUpdateClock(void);
+
 // Função para atribuir uma cor RGB a um LED específico na matriz, dado o índice.
 void npSetLED(const uint index, const uint8_t r, const uint8_t g, const uint8_t b);
 
 // Função para limpar o buffer de LEDs, ou seja, desligar todos os LEDs da matriz.
 void npClear();
 
-// Função para escrever os dados do buffer (cor de cada LED) na matriz de LEDs.
+// Função para escrever os dados do buffer (cor de cada LED) na matriz de LEDs, por DMA e sem bloquear.
 void npWrite();
 
+// Função que diz se não há quadro nem reset em andamento (a PIO pode ser reprogramada).
+bool npIdle(void);
+
 // Função para calcular o índice linear de um LED, dado as coordenadas (x, y) na matriz 5x5.
 int getIndex(int x, int y);
 
@@ -43,6 +52,12 @@ void setLEDxy(const uint y, const uint x, const uint8_t r, const uint8_t g, cons
 // Função para mostrar um número (de 0 a 9) na matriz de LEDs, com a cor especificada para os LEDs acesos.
 void setLEDnumber(const int number, const uint8_t r, const uint8_t g, const uint8_t b);
 
+// Função para escrever um quadro monocromático inteiro, com um byte por linha (bit x = LED aceso na coluna x).
+void npBlitMask(const uint8_t rows[5], const uint8_t r, const uint8_t g, const uint8_t b);
+
+// Função para escrever uma imagem colorida 5x5 inteira, indexada por [y][x].
+void npBlitImage(const npLED_t image[5][5]);
+
 // Função para atribuir uma cor RGB a uma linha na matriz de LED.
 void setLEDline(const int line, const uint8_t r, const uint8_t g, const uint8_t b);
 
@@ -1,9 +1,66 @@
 #include <stdio.h>
 #include <math.h>
+#include <stdint.h>
 #include "mic.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "log.h"
 
-// Configuração do DMA
-static dma_channel_config dma_cfg;
+// Buffers da captura contínua. O alinhamento permite que o DMA volte ao início
+// de cada buffer sozinho (ring de escrita), sem depender da interrupção.
+static uint16_t mic_buffers[2][SAMPLES * MIC_CHANNELS_MAX] __attribute__((aligned(SAMPLES * MIC_CHANNELS_MAX * sizeof(uint16_t))));
+static int mic_dma_channels[2] = {-1, -1};
+static volatile int8_t mic_ready_index = -1;
+static volatile uint32_t mic_overruns;
+
+// Duração de um bloco e instante da última interrupção do DMA, para contar os blocos que
+// passaram com o núcleo 0 parado (gravação na flash): a interrupção só vê o último.
+static volatile float mic_block_us;
+static uint32_t mic_last_irq_us;
+static bool mic_last_irq_valid;
+
+/**
+ * Parâmetros de cada modo de aquisição. As decimações são potências de 2 entre
+ * MIC_DECIMATION_MIN e MIC_DECIMATION_MAX.
+ */
+static const struct {
+    float adc_clock_div; // Ciclos de 48 MHz por conversão, menos 1
+    uint decimation;     // Amostras do ADC por amostra decimada
+} MIC_MODE_CONFIG[MIC_MODES] = {
+    [MIC_MODE_STANDARD] = {96.f, 16},
+    [MIC_MODE_WIDEBAND] = {96.f, 8},
+    [MIC_MODE_LOW_RATE] = {193.f, 16},
+};
+
+static mic_mode_t mic_mode = MIC_MODE_STANDARD;
+static uint mic_rate_divider = 1;
+static uint mic_decimation = 16;
+
+// Entradas em rodízio: o ADC começa pela de menor número e segue em ordem crescente,
+// então a posição de uma entrada no bloco é o número de entradas abaixo dela na máscara.
+static uint mic_channel_mask = 1u << MIC_CHANNEL;
+static uint mic_channels = 1;
+static uint mic_ring_bits = MIC_BUFFER_RING_BITS;
+
+// Estado do CIC (aritmética módulo 2^32: os integradores podem dar a volta, a diferença
+// dos pentes não) e do compensador. cic_shift divide pelo ganho decimação^ordem.
+static uint32_t cic_integrator[MIC_CIC_ORDER];
+static uint32_t cic_comb[MIC_CIC_ORDER];
+static uint cic_shift;
+static int32_t comp_x1, comp_x2;
+
+// Nível DC do microfone relativo a ADC_MIDPOINT, em contagens com 16 bits fracionários.
+static int32_t dc_q16;
+static bool dc_valid;
+
+_Static_assert(MIC_CHANNELS_MAX == 4, "O ring do DMA só aceita blocos em potência de 2");
+_Static_assert((1u << MIC_BUFFER_RING_BITS) == SAMPLES * sizeof(uint16_t),
+               "MIC_BUFFER_RING_BITS deve ser log2 do tamanho do buffer em bytes");
+_Static_assert(SAMPLES % MIC_DECIMATION_MAX == 0, "SAMPLES deve ser múltiplo de MIC_DECIMATION_MAX");
+_Static_assert(MIC_DECIMATION_MAX / MIC_DECIMATION_MIN >= MIC_RATE_DIVIDER_MAX,
+               "MIC_RATE_DIVIDER_MAX não cabe entre as decimações mínima e máxima");
+_Static_assert(MIC_CIC_ORDER == 3, "mic_decimate() tem os três integradores escritos à mão");
+_Static_assert(MIC_CIC_ORDER * 4 + 13 < 32, "Ganho do CIC (16^ordem) vezes a amostra não cabe em 32 bits");
 
 // In mic.c
 float var_real;  // Define the variable here
@@ -17,54 +74,121 @@ const float CALIBRATION_FACTORS[5] = {
     0.9f    // Nível 4 (Mais sensível)
 };
 
+// Fatores de mic_rms_to_db(); o ganho fica multiplicado por 20 para poupar uma multiplicação.
+static float db_gain = MIC_DB_GAIN_DEFAULT;
+static float db_scale = 20.0f * MIC_DB_GAIN_DEFAULT;
+static float db_offset = MIC_DB_OFFSET_DEFAULT;
+
 float mic_rms_to_db(float rms_voltage) {
     if (rms_voltage <= 0.0001f) return 0.0f;
-    
-    // Calcula a pressão sonora (sem considerar a sensibilidade)
-    float sound_pressure = rms_voltage / MIC_SENSITIVITY;
-    
-    // Converte para dB usando a fórmula padrão
-    float db = 20.0f * log10f(sound_pressure / REF_SOUND_PRESSURE);
-    
+
+    float db = db_scale * log10f(rms_voltage) + db_offset;
+
     // Garantir que o valor de dB não seja negativo
-    return fmaxf(0.0f, db * 0.60);
+    return fmaxf(0.0f, db);
+}
+
+float mic_db_to_rms(float db) {
+    return powf(10.0f, (db - db_offset) / db_scale);
+}
+
+void mic_set_calibration(float gain, float offset) {
+    db_gain = gain;
+    db_scale = 20.0f * gain;
+    db_offset = offset;
+}
+
+void mic_get_calibration(float* gain, float* offset) {
+    *gain = db_gain;
+    *offset = db_offset;
+}
+
+/**
+ * Calcula as estatísticas de um bloco usando apenas aritmética inteira.
+ * O M0+ não tem FPU, então o laço por amostra fica todo em inteiros e a
+ * conversão para Volts é feita uma única vez pelo chamador.
+ */
+void mic_block_stats(const uint16_t* adc_buffer, uint count, uint stride, mic_block_stats_t* stats) {
+    uint64_t sum_squared = 0;
+    int32_t sum = 0;
+    int32_t max_sample = INT32_MIN;
+    int32_t min_sample = INT32_MAX;
+
+    for (uint i = 0; i < count; ++i, adc_buffer += stride) {
+        // Remove o ponto médio (1.65 V) e acumula o quadrado.
+        int32_t sample = (int32_t)*adc_buffer - ADC_MIDPOINT;
+        sum_squared += (uint32_t)(sample * sample);
+        sum += sample;
+
+        if (sample > max_sample) max_sample = sample;
+        if (sample < min_sample) min_sample = sample;
+    }
+
+    stats->sum_squared = sum_squared;
+    stats->sum = sum;
+    stats->min = min_sample;
+    stats->max = max_sample;
+    stats->count = count;
+}
+
+void mic_remove_dc(mic_block_stats_t* stats) {
+    if (stats->count == 0)
+        return;
+
+    // Média exponencial das médias dos blocos; o primeiro bloco inicializa o rastreador
+    // para que o nível não comece do ponto médio teórico.
+    int32_t mean_q16 = (int32_t)(((int64_t)stats->sum << 16) / (int32_t)stats->count);
+    if (!dc_valid) {
+        dc_q16 = mean_q16;
+        dc_valid = true;
+    } else {
+        dc_q16 += (mean_q16 - dc_q16) >> MIC_DC_SHIFT;
+    }
+
+    // Σ(x - d)² = Σx² - 2dΣx + nd², com d em 8 bits fracionários para caber em 64 bits.
+    int64_t d_q8 = dc_q16 >> 8;
+    int64_t sum_squared_q16 = ((int64_t)stats->sum_squared << 16) - 2 * d_q8 * ((int64_t)stats->sum << 8) +
+                              (int64_t)stats->count * d_q8 * d_q8;
+    stats->sum_squared = sum_squared_q16 > 0 ? (uint64_t)sum_squared_q16 >> 16 : 0;
+
+    int32_t d = (dc_q16 + (1 << 15)) >> 16;
+    stats->sum -= (int32_t)stats->count * d;
+    stats->min -= d;
+    stats->max -= d;
+}
+
+float mic_get_dc_offset(void) {
+    return dc_q16 / 65536.f;
 }
 
 /**
  * Calcula a potência média das leituras do ADC. (Valor RMS)
+ * O RMS é tomado em torno do ponto médio fixo (ADC_MIDPOINT), como na versão original,
+ * sem passar pelo rastreador de DC: a função não altera estado e pode ser chamada sobre
+ * qualquer buffer.
  */
 float mic_power(const uint16_t* adc_buffer) {
-    double sum_squared = 0.0;
-    float max_voltage = -INFINITY;
-    float min_voltage = INFINITY;
-    
-    // Calculate sum of squares with proper ADC conversion
-    for (uint i = 0; i < SAMPLES; ++i) {
-        // Convert ADC value to voltage and square it
-        float voltage = ADC_ADJUST(adc_buffer[i]);
-        sum_squared += voltage * voltage;
-        
-        // Track max and min voltages for debugging
-        max_voltage = fmaxf(max_voltage, voltage);
-        min_voltage = fminf(min_voltage, voltage);
-    }
-    
-    // Calculate RMS (Root Mean Square)
-    float rms = sqrt(sum_squared / SAMPLES);
-    
-    // Debug prints
-    printf("Debug mic_power - Max Voltage: %.6f | Min Voltage: %.6f | RMS: %.6f\n", 
-           max_voltage, min_voltage, rms);
-    
+    mic_block_stats_t stats;
+    mic_block_stats(adc_buffer, SAMPLES, 1, &stats);
+
+    // Calculate RMS (Root Mean Square), convertendo para Volts só no final
+    float rms = sqrtf((float)stats.sum_squared / stats.count) * ADC_VOLTS_PER_COUNT;
+
+#ifdef MIC_DEBUG
+    LOG_DEBUG("Debug mic_power - Max Voltage: %.6f | Min Voltage: %.6f | RMS: %.6f\n", 
+           stats.max * ADC_VOLTS_PER_COUNT, stats.min * ADC_VOLTS_PER_COUNT, rms);
+#endif
+
     return rms;
 }
 
 
 /**
- * Inicializa o módulo de microfone, configurando ADC e DMA.
+ * Inicializa o módulo de microfone, configurando o ADC. Os canais DMA são tomados
+ * por mic_start_continuous().
  */
-uint mic_init() {
-    printf("Preparando ADC...\n");
+void mic_init(void) {
+    LOG_INFO("Preparando ADC...\n");
 
     // Inicializa o pino do microfone como entrada analógica
     adc_gpio_init(MIC_PIN);
@@ -79,55 +203,311 @@ uint mic_init() {
         false   // Não fazer downscale das amostras para 8-bits, manter 12-bits.
     );
 
-    adc_set_clkdiv(ADC_CLOCK_DIV);
+    mic_set_mode(MIC_MODE);
+    if (!mic_set_channels(MIC_CHANNEL_MASK))
+        LOG_ERROR("Máscara de entradas 0x%x não aceita, usando só o microfone\n", MIC_CHANNEL_MASK);
+    LOG_INFO("Modo %d: ADC a %.0f Hz, %.0f Hz decimado\n", MIC_MODE, mic_get_sample_rate(), mic_get_decimated_rate());
 
-    printf("ADC Configurado!\n\n");
+    LOG_INFO("ADC Configurado!\n\n");
+}
 
-    printf("Preparando DMA...");
 
-    // Tomando posse de canal do DMA.
-    uint dma_channel = dma_claim_unused_channel(true);
+/**
+ * Interrupção do DMA: marca o buffer que acabou de ser preenchido como pronto.
+ */
+static void mic_dma_irq_handler(void) {
+    uint32_t now_us = time_us_32();
+    uint completed = 0;
 
-    // Configurações do DMA.
-    dma_cfg = dma_channel_get_default_config(dma_channel);
+    for (uint i = 0; i < 2; ++i) {
+        if (!dma_channel_get_irq0_status(mic_dma_channels[i]))
+            continue;
 
-    // Tamanho da transferência é 16-bits (usamos uint16_t para armazenar valores do ADC)
-    channel_config_set_transfer_data_size(&dma_cfg, DMA_SIZE_16);
+        dma_channel_acknowledge_irq0(mic_dma_channels[i]);
+        ++completed;
 
-    // Desabilita incremento do ponteiro de leitura (lemos de um único registrador)
-    channel_config_set_read_increment(&dma_cfg, false);
+        // O bloco anterior ainda não foi consumido: ele será sobrescrito.
+        if (mic_ready_index >= 0)
+            ++mic_overruns;
 
-    // Habilita incremento do ponteiro de escrita (escrevemos em um array/buffer)
-    channel_config_set_write_increment(&dma_cfg, true);
-    
-    // Usamos a requisição de dados do ADC
-    channel_config_set_dreq(&dma_cfg, DREQ_ADC);
+        mic_ready_index = i;
+    }
 
-    printf("DMA configurado!\n");
-    
-    return dma_channel;
+    // Com as interrupções desligadas por mais de um bloco, o DMA continua pelo ring e os
+    // blocos do meio são sobrescritos sem nenhuma interrupção: contados pelo intervalo.
+    if (mic_last_irq_valid) {
+        uint32_t blocks = (uint32_t)((now_us - mic_last_irq_us) / mic_block_us + 0.5f);
+        if (blocks > completed)
+            mic_overruns += blocks - completed;
+    }
+    mic_last_irq_us = now_us;
+    mic_last_irq_valid = true;
 }
 
 /**
- * Realiza as leituras do ADC e armazena os valores no buffer.
+ * Inicia a captura contínua do ADC em modo ping-pong.
  */
-void mic_sample(uint16_t* adc_buffer, uint dma_channel) {
-    adc_fifo_drain(); // Limpa o FIFO do ADC.
-    adc_run(false);   // Desliga o ADC (se estiver ligado) para configurar o DMA.
+void mic_start_continuous(void) {
+    adc_run(false);
+    adc_fifo_drain();
 
-    dma_channel_configure(dma_channel, &dma_cfg,
-        adc_buffer,     // Escreve no buffer.
-        &(adc_hw->fifo), // Lê do ADC.
-        SAMPLES,         // Faz "SAMPLES" amostras.
-        true             // Liga o DMA.
-    );
+    // O rodízio começa pela entrada de menor número (a primeira do bloco).
+    adc_select_input(__builtin_ctz(mic_channel_mask));
+    adc_set_round_robin(mic_channels > 1 ? mic_channel_mask : 0);
+
+    for (uint i = 0; i < 2; ++i)
+        mic_dma_channels[i] = dma_claim_unused_channel(true);
 
-    // Liga o ADC e espera acabar a leitura.
+    for (uint i = 0; i < 2; ++i) {
+        dma_channel_config cfg = dma_channel_get_default_config(mic_dma_channels[i]);
+        channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);
+        channel_config_set_read_increment(&cfg, false);
+        channel_config_set_write_increment(&cfg, true);
+        channel_config_set_ring(&cfg, true, mic_ring_bits); // Volta ao início do buffer ao terminar.
+        channel_config_set_dreq(&cfg, DREQ_ADC);
+        channel_config_set_chain_to(&cfg, mic_dma_channels[i ^ 1]); // Ao terminar, dispara o outro canal.
+
+        dma_channel_configure(mic_dma_channels[i], &cfg,
+            mic_buffers[i],   // Escreve no buffer deste canal.
+            &(adc_hw->fifo),  // Lê do ADC.
+            SAMPLES * mic_channels, // Faz "SAMPLES" amostras de cada entrada por bloco.
+            false             // Só o primeiro canal é ligado abaixo.
+        );
+        dma_channel_set_irq0_enabled(mic_dma_channels[i], true);
+    }
+
+    mic_ready_index = -1;
+    mic_overruns = 0;
+    mic_last_irq_valid = false;
+
+    irq_set_exclusive_handler(DMA_IRQ_0, mic_dma_irq_handler);
+    irq_set_enabled(DMA_IRQ_0, true);
+
+    dma_channel_start(mic_dma_channels[0]);
     adc_run(true);
-    dma_channel_wait_for_finish_blocking(dma_channel);
-    
-    // Acabou a leitura, desliga o ADC de novo.
+}
+
+/**
+ * Interrompe a captura contínua e libera os canais DMA.
+ */
+void mic_stop_continuous(void) {
+    if (mic_dma_channels[0] < 0)
+        return;
+
     adc_run(false);
+    irq_set_enabled(DMA_IRQ_0, false);
+
+    // Aborta os dois canais de uma vez para que um não seja disparado pelo encadeamento do outro.
+    dma_hw->abort = (1u << mic_dma_channels[0]) | (1u << mic_dma_channels[1]);
+    while (dma_hw->abort)
+        tight_loop_contents();
+
+    for (uint i = 0; i < 2; ++i) {
+        dma_channel_set_irq0_enabled(mic_dma_channels[i], false);
+        dma_channel_acknowledge_irq0(mic_dma_channels[i]);
+        dma_channel_unclaim(mic_dma_channels[i]);
+        mic_dma_channels[i] = -1;
+    }
+
+    adc_fifo_drain();
+    adc_set_round_robin(0);
+    adc_select_input(MIC_CHANNEL);
+    mic_ready_index = -1;
+}
+
+/**
+ * Retorna o último buffer completo da captura contínua, sem bloquear.
+ */
+const uint16_t* mic_get_ready_buffer(void) {
+    uint32_t status = save_and_disable_interrupts();
+    int8_t index = mic_ready_index;
+    mic_ready_index = -1;
+    restore_interrupts(status);
+
+    return index < 0 ? NULL : mic_buffers[index];
+}
+
+/**
+ * Diz se um bloco completo está esperando, sem consumi-lo.
+ */
+bool mic_block_ready(void) {
+    return mic_ready_index >= 0;
+}
+
+/**
+ * Espera o próximo buffer completo da captura contínua, dormindo em __wfi().
+ */
+const uint16_t* mic_wait_ready_buffer(void) {
+    while (true) {
+        // Testa e dorme com as interrupções desligadas: uma interrupção que chegue entre o
+        // teste e o __wfi() fica pendente e acorda o núcleo em vez de ser perdida.
+        uint32_t status = save_and_disable_interrupts();
+        int8_t index = mic_ready_index;
+        if (index >= 0) {
+            mic_ready_index = -1;
+            restore_interrupts(status);
+            return mic_buffers[index];
+        }
+        __wfi();
+        restore_interrupts(status);
+    }
+}
+
+/**
+ * Número de blocos que ficaram prontos sem serem consumidos antes do próximo.
+ */
+uint32_t mic_get_overruns(void) {
+    return mic_overruns;
+}
+
+
+/**
+ * Taxa de amostragem do ADC.
+ */
+float mic_get_sample_rate(void) {
+    return ADC_BASE_CLOCK_HZ / ((1.f + MIC_MODE_CONFIG[mic_mode].adc_clock_div) * mic_rate_divider * mic_channels);
+}
+
+/**
+ * Aplica o modo, o divisor e o número de entradas ao ADC e ao decimador.
+ */
+static void mic_apply_rate(void) {
+    // Cada conversão leva (1 + div) ciclos; o registrador pode ser alterado com o ADC rodando.
+    // Com várias entradas em rodízio, cada uma recebe 1/mic_channels das conversões.
+    adc_set_clkdiv((1.f + MIC_MODE_CONFIG[mic_mode].adc_clock_div) * mic_rate_divider - 1.f);
+    mic_block_us = SAMPLES * 1e6f / mic_get_sample_rate();
+    mic_last_irq_valid = false; // O bloco em andamento mistura as duas taxas.
+    mic_decimation = MIC_MODE_CONFIG[mic_mode].decimation / (mic_rate_divider * mic_channels);
+
+    // Ganho do CIC: decimação^ordem, uma potência de 2.
+    uint log2_decimation = 0;
+    while ((1u << log2_decimation) < mic_decimation)
+        ++log2_decimation;
+    cic_shift = MIC_CIC_ORDER * log2_decimation - MIC_DECIMATED_FRAC_BITS;
+}
+
+bool mic_set_mode(mic_mode_t mode) {
+    if (mode >= MIC_MODES || MIC_MODE_CONFIG[mode].decimation / mic_channels < MIC_DECIMATION_MIN)
+        return false;
+
+    mic_mode = mode;
+    mic_rate_divider = 1;
+    mic_apply_rate();
+    return true;
+}
+
+mic_mode_t mic_get_mode(void) {
+    return mic_mode;
+}
+
+bool mic_set_channels(uint mask) {
+    uint count = __builtin_popcount(mask);
+
+    if (mic_dma_channels[0] >= 0 || !(mask & (1u << MIC_CHANNEL)) || mask >> MIC_INPUTS ||
+        (count != 1 && count != 2 && count != 4) ||
+        MIC_MODE_CONFIG[mic_mode].decimation / count < MIC_DECIMATION_MIN)
+        return false;
+
+    for (uint channel = 0; channel < MIC_TEMP_CHANNEL; ++channel) {
+        if (mask & (1u << channel))
+            adc_gpio_init(26 + channel);
+    }
+    adc_set_temp_sensor_enabled(mask & (1u << MIC_TEMP_CHANNEL));
+
+    mic_channel_mask = mask;
+    mic_channels = count;
+    mic_ring_bits = MIC_BUFFER_RING_BITS + __builtin_ctz(count);
+    mic_rate_divider = 1;
+    mic_apply_rate();
+    return true;
+}
+
+uint mic_get_channels(void) {
+    return mic_channel_mask;
+}
+
+uint mic_channel_count(void) {
+    return mic_channels;
+}
+
+const uint16_t* mic_channel_samples(const uint16_t* block, uint channel) {
+    if (channel >= MIC_INPUTS || !(mic_channel_mask & (1u << channel)))
+        return NULL;
+    return block + __builtin_popcount(mic_channel_mask & ((1u << channel) - 1));
+}
+
+float mic_temperature_c(float counts) {
+    // Fórmula do datasheet do RP2040: 0,706 V a 27 °C, -1,721 mV/°C.
+    return 27.f - (counts * ADC_VOLTS_PER_COUNT - 0.706f) / 0.001721f;
+}
+
+/**
+ * Divide a taxa do ADC mantendo a taxa decimada.
+ */
+void mic_set_rate_divider(uint factor) {
+    if (factor < 1 || factor > MIC_RATE_DIVIDER_MAX || (factor & (factor - 1)))
+        return;
+
+    // Nos modos com decimação menor, ou com várias entradas, o divisor é limitado para não
+    // passar de MIC_DECIMATED_MAX_SAMPLES.
+    while (MIC_MODE_CONFIG[mic_mode].decimation / (factor * mic_channels) < MIC_DECIMATION_MIN)
+        factor /= 2;
+
+    mic_rate_divider = factor;
+    mic_apply_rate();
+}
+
+/**
+ * Taxa das amostras entregues por mic_decimate().
+ */
+float mic_get_decimated_rate(void) {
+    return mic_get_sample_rate() / mic_decimation;
+}
+
+/**
+ * Decima com um CIC de ordem 3: os integradores rodam na taxa do ADC (só somas) e os
+ * pentes na taxa decimada. Comparado à média simples (um CIC de ordem 1), a rejeição
+ * do que dobraria sobre a banda passante sobe de ~30 para mais de 70 dB, e o ruído de
+ * quantização fora da banda não volta para ela. O compensador (-1, 10, -1)/8 corrige
+ * a queda do CIC: -0,7 dB em 4 kHz viram -0,06 dB no modo padrão. Por fim, o nível DC
+ * rastreado por mic_remove_dc() é subtraído da saída.
+ */
+uint mic_decimate(const uint16_t* adc_buffer, int16_t* out) {
+    const uint decimation = mic_decimation;
+    const uint count = SAMPLES / decimation;
+    const uint stride = mic_channels;
+    const int32_t dc = (dc_q16 << MIC_DECIMATED_FRAC_BITS) >> 16; // Nível DC na escala da saída
+    adc_buffer = mic_channel_samples(adc_buffer, MIC_CHANNEL);
+    uint32_t i0 = cic_integrator[0], i1 = cic_integrator[1], i2 = cic_integrator[2];
+
+    for (uint i = 0; i < count; ++i) {
+        for (uint j = 0; j < decimation; ++j) {
+            i0 += (uint32_t)((int32_t)*adc_buffer - ADC_MIDPOINT);
+            adc_buffer += stride;
+            i1 += i0;
+            i2 += i1;
+        }
+
+        uint32_t value = i2;
+        for (uint stage = 0; stage < MIC_CIC_ORDER; ++stage) {
+            uint32_t delayed = cic_comb[stage];
+            cic_comb[stage] = value;
+            value -= delayed;
+        }
+
+        // Divide pelo ganho do CIC mantendo MIC_DECIMATED_FRAC_BITS bits fracionários.
+        int32_t x = (int32_t)value >> cic_shift;
+        int32_t y = ((10 * comp_x1 - x - comp_x2) >> 3) - dc;
+        comp_x2 = comp_x1;
+        comp_x1 = x;
+
+        out[i] = (int16_t)(y > INT16_MAX ? INT16_MAX : (y < INT16_MIN ? INT16_MIN : y));
+    }
+
+    cic_integrator[0] = i0;
+    cic_integrator[1] = i1;
+    cic_integrator[2] = i2;
+    return count;
 }
 
 
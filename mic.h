@@ -6,21 +6,81 @@
 #include "hardware/adc.h"
 #include "hardware/dma.h"
 
-#define DB_OFFSET -15.0f  // Ajuste este valor baseado nos seus testes
-
 extern float var_real;  // Declare as extern
 
 // Pino e canal do microfone no ADC.
 #define MIC_CHANNEL 2
 #define MIC_PIN (26 + MIC_CHANNEL)
 
+// Outras entradas que podem ser capturadas junto com o microfone (mic_set_channels()).
+#define MIC_EXT_CHANNEL 0   // Microfone externo no GPIO26
+#define MIC_TEMP_CHANNEL 4  // Sensor de temperatura interno
+#define MIC_INPUTS 5        // Entradas do ADC (0 a 3 nos GPIO26 a 29, 4 é o sensor de temperatura)
+
+// O ADC converte as entradas da máscara em rodízio e o DMA grava as amostras intercaladas.
+// A máscara precisa ter 1, 2 ou 4 entradas: o bloco continua sendo uma potência de 2 e o
+// DMA volta ao início do buffer sozinho, mesmo com as interrupções do núcleo 0 paradas.
+#define MIC_CHANNELS_MAX 4
+
+// Máscara usada no boot; definida pelo CMake (-DMIC_CHANNEL_MASK=n).
+#ifndef MIC_CHANNEL_MASK
+#define MIC_CHANNEL_MASK (1u << MIC_CHANNEL)
+#endif
+
 // Parâmetros e macros do ADC.
-#define ADC_CLOCK_DIV 96.f
-#define SAMPLES 300 // Número de amostras que serão feitas do ADC.
-#define ADC_ADJUST(x) (x * 3.3f / (1 << 12u) - 1.65f) // Ajuste do valor do ADC para Volts.
+#define SAMPLES 256 // Número de amostras que serão feitas do ADC (potência de 2, ver MIC_BUFFER_RING_BITS).
+#define ADC_ADJUST(x) (x * 3.3f / (1 << 12u) - 1.65f) // Ajuste do valor do ADC para Volts (ponto médio fixo).
 #define ADC_MAX 3.3f
+#define ADC_MIDPOINT 2048 // Leitura correspondente a 1.65 V, o ponto médio do sinal do microfone.
+#define ADC_VOLTS_PER_COUNT (3.3f / (1 << 12u)) // Tensão de um passo do ADC.
 #define ADC_STEP (3.3f/5.f) // Intervalos de volume do microfone.
 
+// Frequência do clock do ADC (48 MHz do PLL USB); cada conversão leva (1 + divisor) ciclos.
+#define ADC_BASE_CLOCK_HZ 48000000.f
+
+// Decimação do fluxo do ADC para o processamento de áudio: filtro CIC de ordem MIC_CIC_ORDER
+// seguido de um FIR de 3 coeficientes que compensa a queda do CIC na banda passante.
+// As amostras decimadas são contagens do ADC sem o ponto médio, com MIC_DECIMATED_FRAC_BITS bits fracionários.
+#define MIC_CIC_ORDER 3
+#define MIC_DECIMATED_FRAC_BITS 3
+
+// Medidor, espectro e gatilho processam blocos de MIC_DECIMATED_SAMPLES amostras decimadas.
+// A decimação efetiva (modo e mic_set_rate_divider()) fica entre MIC_DECIMATION_MIN e
+// MIC_DECIMATION_MAX, então um bloco do ADC rende de 1 a 4 desses blocos.
+#define MIC_DECIMATION_MAX 16
+#define MIC_DECIMATION_MIN 4
+#define MIC_DECIMATED_SAMPLES (SAMPLES / MIC_DECIMATION_MAX)
+#define MIC_DECIMATED_MAX_SAMPLES (SAMPLES / MIC_DECIMATION_MIN)
+
+// Rastreador do nível DC do microfone: média exponencial das médias dos blocos, com peso
+// 1/2^MIC_DC_SHIFT por bloco (~130 ms de constante de tempo, corte em ~1,2 Hz no modo padrão).
+#define MIC_DC_SHIFT 8
+
+// Maior redução da taxa do ADC aceita por mic_set_rate_divider(), limitada também pela
+// decimação do modo (MIC_DECIMATION_MIN).
+#define MIC_RATE_DIVIDER_MAX 4
+
+/**
+ * Modos de aquisição: taxa do ADC e decimação. A taxa decimada é a entregue ao
+ * medidor, ao espectro e ao gravador.
+ */
+typedef enum {
+    MIC_MODE_STANDARD, // ADC a ~495 kHz, decimação 16: ~30,9 kHz
+    MIC_MODE_WIDEBAND, // ADC a ~495 kHz, decimação 8: ~61,9 kHz (ponderação A até 20 kHz, o dobro de carga)
+    MIC_MODE_LOW_RATE, // ADC a ~247 kHz, decimação 16: ~15,5 kHz (bandas até 4 kHz, metade da carga)
+    MIC_MODES
+} mic_mode_t;
+
+// Modo usado no boot; definido pelo CMake (-DMIC_MODE=n).
+#ifndef MIC_MODE
+#define MIC_MODE MIC_MODE_STANDARD
+#endif
+
+// Captura contínua: cada canal DMA escreve sempre no mesmo buffer usando o "ring" de escrita,
+// que exige buffers alinhados e com tamanho em potência de 2 (log2(SAMPLES * sizeof(uint16_t))
+// com uma entrada; um bit a mais para cada dobro de entradas).
+#define MIC_BUFFER_RING_BITS 9
+
 #define abs(x) ((x < 0) ? (-x) : (x))
 
 // More realistic reference values
@@ -33,33 +93,214 @@ extern float var_real;  // Declare as extern
 // #define MIC_SENSITIVITY_DB   -46.0f  // Sensibilidade do microfone (ex.: -46dB)
 // #define REF_PRESSURE_DB      94.0f   // Nível de referência para 0dB (94dB = 1 Pascal)
 
+// Calibração de fábrica de mic_rms_to_db(): dB = ganho · 20·log10(V) + offset. O offset vem de
+// MIC_SENSITIVITY e REF_SOUND_PRESSURE: -0,60 · 20·log10(0,02 · 20e-6). Substituída pela
+// calibração de cada placa (calibration.h), gravada nas configurações.
+#define MIC_DB_GAIN_DEFAULT 0.60f
+#define MIC_DB_OFFSET_DEFAULT 76.775f
+
 /**
- * Converte a tensão RMS do microfone para decibéis (dB SPL).
+ * Converte a tensão RMS do microfone para decibéis (dB SPL) com a calibração atual.
  * @param rms_voltage Tensão RMS ajustada (em Volts)
  * @return Nível de pressão sonora em dB
  */
 float mic_rms_to_db(float rms_voltage);
 
 /**
- * Inicializa o módulo de microfone, configurando ADC e DMA.
- * @return Canal DMA utilizado para leitura do microfone
+ * Inverso de mic_rms_to_db(): tensão RMS que corresponde a um nível em dB.
+ * @param db Nível sonoro (dB, mesma escala de mic_rms_to_db())
+ * @return Tensão RMS (em Volts)
+ */
+float mic_db_to_rms(float db);
+
+/**
+ * Troca os fatores usados por mic_rms_to_db() e mic_db_to_rms(). Núcleo 0, o mesmo que
+ * converte os níveis; limiares já calculados (trigger_set_level()) devem ser refeitos.
+ * @param gain Ganho (dB por dB de tensão)
+ * @param offset Nível em dB de 1 V RMS
+ */
+void mic_set_calibration(float gain, float offset);
+
+/**
+ * Fatores atuais de mic_rms_to_db().
+ * @param gain Recebe o ganho
+ * @param offset Recebe o offset (dB)
+ */
+void mic_get_calibration(float* gain, float* offset);
+
+/**
+ * Inicializa o módulo de microfone, configurando o ADC no modo e nas entradas do boot.
+ * Os canais DMA são tomados por mic_start_continuous().
+ */
+void mic_init(void);
+
+/**
+ * Inicia a captura contínua do ADC em modo ping-pong.
+ * Dois canais DMA encadeados alternam entre dois buffers de SAMPLES amostras, sem
+ * parar o ADC entre blocos. A cada bloco completo, a interrupção do DMA marca o
+ * buffer como pronto para processamento.
+ */
+void mic_start_continuous(void);
+
+/**
+ * Interrompe a captura contínua e libera os canais DMA.
+ */
+void mic_stop_continuous(void);
+
+/**
+ * Retorna o último buffer completo da captura contínua, sem bloquear.
+ * O buffer tem SAMPLES amostras de cada entrada, intercaladas (mic_channel_samples()), e
+ * permanece válido até o DMA voltar a ele, ou seja, por um bloco.
+ * @return Ponteiro para o buffer pronto, ou NULL se nenhum bloco novo chegou
+ */
+const uint16_t* mic_get_ready_buffer(void);
+
+/**
+ * Diz se um bloco completo está esperando, sem consumi-lo.
+ * @return true se mic_wait_ready_buffer() retornaria imediatamente
+ */
+bool mic_block_ready(void);
+
+/**
+ * Espera o próximo buffer completo da captura contínua. O núcleo fica em __wfi()
+ * até a interrupção do DMA (ou outra qualquer) acordá-lo.
+ * @return Ponteiro para o buffer pronto
+ */
+const uint16_t* mic_wait_ready_buffer(void);
+
+/**
+ * Número de blocos que ficaram prontos sem serem consumidos antes do próximo, inclusive
+ * os que passaram com as interrupções do núcleo 0 desligadas (flash_safe_execute()).
+ * @return Contador de blocos perdidos desde mic_start_continuous()
  */
-uint mic_init();
+uint32_t mic_get_overruns(void);
 
 /**
- * Realiza as leituras do ADC e armazena os valores no buffer.
- * @param adc_buffer Buffer para armazenar as amostras
- * @param dma_channel Canal DMA a ser utilizado
+ * Estatísticas de um bloco do ADC em contagens inteiras, já sem o ponto médio.
  */
-void mic_sample(uint16_t* adc_buffer, uint dma_channel);
+typedef struct {
+    uint64_t sum_squared; // Soma dos quadrados das amostras
+    int32_t sum;          // Soma das amostras
+    int32_t min;          // Menor amostra
+    int32_t max;          // Maior amostra
+    uint32_t count;       // Número de amostras
+} mic_block_stats_t;
+
+/**
+ * Calcula as estatísticas de um bloco usando apenas aritmética inteira.
+ * @param adc_buffer Primeira amostra da entrada (mic_channel_samples())
+ * @param count Número de amostras da entrada
+ * @param stride Distância entre duas amostras da entrada (mic_channel_count(), ou 1)
+ * @param stats Estrutura que recebe o resultado
+ */
+void mic_block_stats(const uint16_t* adc_buffer, uint count, uint stride, mic_block_stats_t* stats);
+
+/**
+ * Remove das estatísticas de um bloco do microfone o nível DC rastreado, no lugar do
+ * ponto médio fixo (ADC_MIDPOINT). O rastreador é atualizado com a média do bloco antes
+ * da correção e continua de um bloco para o outro; a correção é feita sobre as somas,
+ * sem custo por amostra. mic_decimate() usa o mesmo nível, então deve ser chamada antes dela.
+ * @param stats Estatísticas de MIC_CHANNEL (mic_block_stats()), corrigidas no lugar
+ */
+void mic_remove_dc(mic_block_stats_t* stats);
+
+/**
+ * Nível DC rastreado do microfone, relativo a ADC_MIDPOINT.
+ * @return Desvio do ponto médio (contagens do ADC)
+ */
+float mic_get_dc_offset(void);
+
+/**
+ * Escolhe as entradas do ADC capturadas em rodízio. Deve ser chamada antes de
+ * mic_start_continuous(). Cada entrada é amostrada na taxa do modo dividida pelo número
+ * de entradas, e a decimação do microfone cai na mesma proporção: a taxa decimada
+ * não muda.
+ * @param mask Bits das entradas (1 << canal); deve incluir MIC_CHANNEL e ter 1, 2 ou 4 bits
+ * @return false se a máscara não é aceita (decimação abaixo de MIC_DECIMATION_MIN no modo atual)
+ */
+bool mic_set_channels(uint mask);
+
+/**
+ * Máscara das entradas capturadas.
+ * @return Máscara escolhida por mic_set_channels()
+ */
+uint mic_get_channels(void);
+
+/**
+ * Número de entradas capturadas; é também a distância entre duas amostras de uma entrada no bloco.
+ * @return 1, 2 ou 4
+ */
+uint mic_channel_count(void);
+
+/**
+ * Amostras de uma entrada dentro de um bloco intercalado, sem cópia: a amostra k fica em
+ * [k * mic_channel_count()], de k = 0 a SAMPLES - 1.
+ * @param block Bloco de mic_wait_ready_buffer()
+ * @param channel Entrada do ADC (0 a 4)
+ * @return Ponteiro para a primeira amostra, ou NULL se a entrada não é capturada
+ */
+const uint16_t* mic_channel_samples(const uint16_t* block, uint channel);
+
+/**
+ * Converte uma leitura média do sensor de temperatura interno para graus Celsius.
+ * @param counts Leitura do ADC (0 a 4095)
+ * @return Temperatura (°C)
+ */
+float mic_temperature_c(float counts);
 
 /**
  * Calcula a potência média das leituras do ADC. (Valor RMS)
+ * O RMS é tomado em torno de ADC_MIDPOINT; o rastreador de DC de mic_remove_dc() não muda.
  * @param adc_buffer Buffer com as amostras do ADC
  * @return Valor RMS das amostras
  */
 float mic_power(const uint16_t* adc_buffer);
 
+/**
+ * Taxa de amostragem de cada entrada do ADC.
+ * @return Amostras por segundo
+ */
+float mic_get_sample_rate(void);
+
+/**
+ * Taxa das amostras entregues por mic_decimate().
+ * @return Amostras por segundo
+ */
+float mic_get_decimated_rate(void);
+
+/**
+ * Escolhe a taxa do ADC e a decimação. Pode ser chamada com a captura rodando, mas a taxa
+ * decimada muda: medidor, espectro e gravador precisam ser reiniciados com a nova taxa.
+ * @param mode Modo de aquisição
+ * @return false se o modo não existe
+ */
+bool mic_set_mode(mic_mode_t mode);
+
+/**
+ * Modo de aquisição atual.
+ * @return Modo escolhido por mic_set_mode()
+ */
+mic_mode_t mic_get_mode(void);
+
+/**
+ * Divide a taxa do ADC por factor sem parar a captura contínua. A decimação é reduzida
+ * na mesma proporção, então mic_get_decimated_rate() não muda e o medidor e o espectro
+ * continuam válidos; só os blocos chegam factor vezes mais devagar. Os primeiros
+ * MIC_CIC_ORDER valores depois da troca são transitórios.
+ * @param factor 1 (taxa normal) a MIC_RATE_DIVIDER_MAX, potência de 2; limitado para
+ *               que a decimação não fique abaixo de MIC_DECIMATION_MIN
+ */
+void mic_set_rate_divider(uint factor);
+
+/**
+ * Decima um bloco do ADC com o CIC e o compensador. O estado dos filtros passa de um
+ * bloco para o outro, então os blocos devem ser entregues em ordem e sem repetição.
+ * @param adc_buffer Bloco de mic_wait_ready_buffer(); só as amostras de MIC_CHANNEL são usadas
+ * @param out Recebe até MIC_DECIMATED_MAX_SAMPLES amostras decimadas
+ * @return Número de amostras escritas em out (SAMPLES / decimação atual, múltiplo de MIC_DECIMATED_SAMPLES)
+ */
+uint mic_decimate(const uint16_t* adc_buffer, int16_t* out);
+
 /**
  * Calcula a intensidade do volume registrado no microfone, de 0 a 4, usando a tensão.
  * @param v Tensão medida
@@ -0,0 +1,75 @@
+#include "pipeline.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+/**
+ * Fila sem trava de um produtor e um consumidor.
+ * head só é escrito pelo núcleo 0 e tail só pelo núcleo 1; os índices crescem
+ * sem parar e a posição no buffer é o índice módulo PIPELINE_QUEUE_SIZE.
+ */
+static measurement_t queue[PIPELINE_QUEUE_SIZE];
+static volatile uint32_t head;
+static volatile uint32_t tail;
+
+// Contadores escritos por um único núcleo cada.
+static volatile uint32_t pushed;
+static volatile uint32_t dropped;
+static volatile uint32_t skipped;
+static volatile uint32_t max_occupancy;
+
+_Static_assert((PIPELINE_QUEUE_SIZE & (PIPELINE_QUEUE_SIZE - 1)) == 0,
+               "PIPELINE_QUEUE_SIZE deve ser potência de 2");
+
+void pipeline_init(void) {
+    head = tail = 0;
+    pushed = dropped = skipped = max_occupancy = 0;
+}
+
+bool pipeline_push(const measurement_t* m) {
+    uint32_t h = head;
+    uint32_t occupancy = h - tail;
+
+    if (occupancy >= PIPELINE_QUEUE_SIZE) {
+        ++dropped;
+        return false;
+    }
+
+    queue[h % PIPELINE_QUEUE_SIZE] = *m;
+
+    // Garante que a medição esteja na memória antes de publicar o novo head.
+    __mem_fence_release();
+    head = h + 1;
+    ++pushed;
+
+    if (occupancy + 1 > max_occupancy)
+        max_occupancy = occupancy + 1;
+
+    __sev(); // Acorda o núcleo 1 se ele estiver em __wfe().
+    return true;
+}
+
+bool pipeline_pop_latest(measurement_t* m) {
+    uint32_t t = tail;
+    uint32_t h = head;
+
+    if (h == t)
+        return false;
+
+    __mem_fence_acquire();
+
+    // Só a medição mais recente interessa para o desenho.
+    skipped += h - t - 1;
+    *m = queue[(h - 1) % PIPELINE_QUEUE_SIZE];
+
+    __mem_fence_release();
+    tail = h;
+    return true;
+}
+
+void pipeline_get_stats(pipeline_stats_t* stats) {
+    stats->pushed = pushed;
+    stats->dropped = dropped;
+    stats->skipped = skipped;
+    stats->occupancy = head - tail;
+    stats->max_occupancy = max_occupancy;
+}
@@ -0,0 +1,63 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "spectrum.h"
+#include "spl.h"
+
+// Capacidade da fila entre os núcleos (potência de 2).
+#define PIPELINE_QUEUE_SIZE 8
+
+/**
+ * Medição de um quadro, produzida no núcleo 0 e desenhada no núcleo 1.
+ */
+typedef struct {
+    uint32_t timestamp_ms; // Instante da medição (ms desde o boot)
+    float rms;             // Tensão RMS do quadro (V)
+    float db;              // Nível sonoro exibido (LAF, dB)
+    spl_levels_t spl;      // Níveis ponderados do medidor (dB)
+    uint8_t sensitivity;   // Nível de sensibilidade no momento da medição
+    uint8_t view;          // Tela a ser desenhada (view_mode_t)
+    uint8_t power;         // Estado de energia (power_state_t)
+    float band_db[SPECTRUM_BANDS]; // Nível de cada banda de oitava do último espectro (dB)
+} measurement_t;
+
+/**
+ * Contadores da fila para saber se algum dos lados está atrasado.
+ */
+typedef struct {
+    uint32_t pushed;        // Medições enfileiradas pelo núcleo 0
+    uint32_t dropped;       // Medições descartadas porque a fila estava cheia (núcleo 1 atrasado)
+    uint32_t skipped;       // Medições antigas puladas pelo núcleo 1 para desenhar só a mais recente
+    uint32_t occupancy;     // Ocupação atual da fila
+    uint32_t max_occupancy; // Maior ocupação observada
+} pipeline_stats_t;
+
+/**
+ * Zera a fila e os contadores. Deve ser chamada antes de iniciar o núcleo 1.
+ */
+void pipeline_init(void);
+
+/**
+ * Enfileira uma medição. Só pode ser chamada pelo produtor (núcleo 0).
+ * @param m Medição a ser enviada
+ * @return false se a fila estava cheia e a medição foi descartada
+ */
+bool pipeline_push(const measurement_t* m);
+
+/**
+ * Retira a medição mais recente, descartando as anteriores.
+ * Só pode ser chamada pelo consumidor (núcleo 1).
+ * @param m Recebe a medição
+ * @return false se a fila estava vazia
+ */
+bool pipeline_pop_latest(measurement_t* m);
+
+/**
+ * Lê os contadores da fila.
+ * @param stats Estrutura que recebe os contadores
+ */
+void pipeline_get_stats(pipeline_stats_t* stats);
+
+#endif // PIPELINE_H
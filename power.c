@@ -0,0 +1,126 @@
+#include "power.h"
+#include <stdio.h>
+#include "hardware/clocks.h"
+#include "hardware/i2c.h"
+#include "hardware/sync.h"
+#include "init_GPIO.h"
+#include "matrizLED.h"
+
+// Estado e tempos: escritos só pelo núcleo 0. residency_seq é ímpar durante uma troca
+// de estado, para power_get_residency() no núcleo 1 não ler os tempos pela metade.
+static volatile power_state_t state = POWER_ACTIVE;
+static uint32_t last_loud_ms;
+static volatile uint32_t state_since_ms;
+static volatile uint32_t residency_ms[POWER_STATES];
+static volatile uint32_t residency_seq;
+static uint32_t active_sys_hz;
+
+// Troca do clk_sys: pedida pelo núcleo 0, aplicada pelo núcleo 1.
+static volatile bool clock_low_requested;
+static volatile bool clock_low_applied;
+
+void power_init(void) {
+    active_sys_hz = clock_get_hz(clk_sys);
+
+    // O clk_peri não tem mux sem glitch; é trocado uma única vez, antes de UART e I2C existirem.
+    clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB, 48 * MHZ, 48 * MHZ);
+}
+
+/**
+ * Troca o clk_sys entre o PLL do sistema e o PLL USB. O clk_sys tem mux sem glitch, mas
+ * o I2C e a PIO contam ciclos dele: com uma transferência em andamento, o SCL e os bits
+ * dos WS2812 mudariam de velocidade no meio. Por isso só o núcleo 1, entre transferências,
+ * faz a troca.
+ */
+static void power_set_sys_clock(bool low) {
+    if (low)
+        clock_configure(clk_sys, CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX,
+                        CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB, 48 * MHZ, POWER_IDLE_SYS_HZ);
+    else
+        clock_configure(clk_sys, CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX,
+                        CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS, active_sys_hz, active_sys_hz);
+
+    // Divisores calculados a partir do clk_sys novo.
+    i2c_set_baudrate(I2C_PORT, I2C_BAUDRATE);
+    npUpdateClock();
+}
+
+bool power_clock_pending(void) {
+    return clock_low_requested != clock_low_applied;
+}
+
+void power_apply_clock(void) {
+    bool low = clock_low_requested;
+    power_set_sys_clock(low);
+    clock_low_applied = low;
+}
+
+static void power_enter(power_state_t next, uint32_t now_ms) {
+    if (next == state)
+        return;
+
+    ++residency_seq;
+    __mem_fence_release();
+    residency_ms[state] += now_ms - state_since_ms;
+    state_since_ms = now_ms;
+
+    // O ADC é do núcleo 0 e muda já; o clock, o I2C e a PIO esperam o núcleo 1.
+    if (next == POWER_IDLE) {
+        mic_set_rate_divider(POWER_IDLE_ADC_DIVIDER);
+        clock_low_requested = true;
+        __sev();
+    } else if (state == POWER_IDLE) {
+        mic_set_rate_divider(1);
+        clock_low_requested = false;
+        __sev();
+    }
+
+    // Display e matriz pertencem ao núcleo 1, que reage ao estado publicado na medição.
+    state = next;
+    __mem_fence_release();
+    ++residency_seq;
+}
+
+power_state_t power_update(bool loud, uint32_t now_ms) {
+    if (loud)
+        last_loud_ms = now_ms;
+
+    uint32_t quiet_ms = now_ms - last_loud_ms;
+    power_state_t next = quiet_ms >= POWER_IDLE_AFTER_MS  ? POWER_IDLE
+                       : quiet_ms >= POWER_QUIET_AFTER_MS ? POWER_QUIET
+                       : POWER_ACTIVE;
+
+    power_enter(next, now_ms);
+    return state;
+}
+
+void power_wake(uint32_t now_ms) {
+    power_update(true, now_ms);
+}
+
+void power_get_residency(uint32_t ms[POWER_STATES]) {
+    uint32_t seq;
+    power_state_t current;
+    uint32_t since_ms;
+
+    do {
+        seq = residency_seq;
+        __mem_fence_acquire();
+        for (uint i = 0; i < POWER_STATES; ++i)
+            ms[i] = residency_ms[i];
+        current = state;
+        since_ms = state_since_ms;
+        __mem_fence_acquire();
+    } while ((seq & 1) || seq != residency_seq);
+
+    ms[current] += to_ms_since_boot(get_absolute_time()) - since_ms;
+}
+
+void power_print_residency(void) {
+    static const char* const names[POWER_STATES] = {"active", "quiet", "idle"};
+    uint32_t ms[POWER_STATES];
+
+    power_get_residency(ms);
+    printf("POWER,%lu,%lu,%lu,%s\n", (unsigned long)ms[POWER_ACTIVE], (unsigned long)ms[POWER_QUIET],
+           (unsigned long)ms[POWER_IDLE], names[state]);
+}
@@ -0,0 +1,78 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "mic.h"
+
+// Tempo em silêncio até reduzir o brilho (QUIET) e até baixar o clock (IDLE).
+#define POWER_QUIET_AFTER_MS 30000
+#define POWER_IDLE_AFTER_MS 120000
+
+// clk_sys em IDLE: 48 MHz do PLL USB, que já roda para o ADC e o USB.
+#define POWER_IDLE_SYS_HZ (48 * MHZ)
+
+// Divisor da taxa do ADC em IDLE (mic_set_rate_divider()).
+#define POWER_IDLE_ADC_DIVIDER MIC_RATE_DIVIDER_MAX
+
+// Contraste do display em QUIET e quantos prazos da matriz de LEDs são pulados por atualização.
+#define POWER_QUIET_CONTRAST 0x20
+#define POWER_QUIET_LED_DIVIDER 4
+
+/**
+ * Estados de energia, do mais ativo ao mais econômico.
+ */
+typedef enum {
+    POWER_ACTIVE, // Clock normal, display e matriz atualizados normalmente
+    POWER_QUIET,  // Display com brilho reduzido, matriz atualizada mais devagar
+    POWER_IDLE,   // clk_sys e ADC reduzidos, display e matriz desligados
+    POWER_STATES
+} power_state_t;
+
+/**
+ * Fixa o clk_peri no PLL USB (48 MHz) para que a UART não dependa do clk_sys.
+ * O I2C e a PIO contam ciclos do clk_sys e são reprogramados a cada troca
+ * (power_apply_clock()). Deve ser chamada antes de stdio_init_all() e de i2c_init().
+ */
+void power_init(void);
+
+/**
+ * Atualiza o estado de energia. Chamada a cada bloco pelo núcleo 0; ao entrar em IDLE
+ * ou sair dele o ADC muda na hora e a troca do clk_sys é pedida ao núcleo 1 (__sev()).
+ * @param loud Resultado de trigger_block_is_loud()
+ * @param now_ms Tempo atual
+ * @return Estado atual
+ */
+power_state_t power_update(bool loud, uint32_t now_ms);
+
+/**
+ * Volta a POWER_ACTIVE imediatamente (botão pressionado).
+ * @param now_ms Tempo atual
+ */
+void power_wake(uint32_t now_ms);
+
+/**
+ * Diz se o núcleo 0 pediu uma troca do clk_sys que ainda não foi aplicada.
+ */
+bool power_clock_pending(void);
+
+/**
+ * Aplica a troca do clk_sys pedida e reprograma o baud do I2C do display e o divisor
+ * da PIO da matriz. Chamada pelo núcleo 1, dono dos dois, só sem transferência em
+ * andamento (ssd1306_update_done() e npIdle()).
+ */
+void power_apply_clock(void);
+
+/**
+ * Tempo acumulado em cada estado desde o boot. Pode ser chamada de qualquer núcleo.
+ * @param ms Recebe os tempos (ms), indexados por power_state_t
+ */
+void power_get_residency(uint32_t ms[POWER_STATES]);
+
+/**
+ * Imprime o tempo em cada estado numa linha POWER,active_ms,quiet_ms,idle_ms,estado.
+ */
+void power_print_residency(void);
+
+#endif // POWER_H
@@ -0,0 +1,352 @@
+#include "recorder.h"
+#include <stddef.h>
+#include <string.h>
+#include "hardware/sync.h"
+#include "crc.h"
+#include "telemetry.h"
+#include "log.h"
+
+#define RECORDER_MAGIC 0x31545645 // "EVT1"
+#define RECORDER_DATA_BYTES (RECORDER_SNIPPET_SAMPLES * sizeof(int16_t))
+#define RECORDER_SLOT_SECTORS (RECORDER_SLOT_SIZE / FLASH_SECTOR_SIZE)
+
+_Static_assert((RECORDER_PRE_SAMPLES & (RECORDER_PRE_SAMPLES - 1)) == 0,
+               "RECORDER_PRE_SAMPLES deve ser potência de 2");
+_Static_assert(RECORDER_PRE_SAMPLES < RECORDER_SNIPPET_SAMPLES,
+               "A janela anterior deve caber no trecho");
+_Static_assert(FLASH_PAGE_SIZE + RECORDER_DATA_BYTES <= RECORDER_SLOT_SIZE,
+               "O trecho não cabe em uma posição");
+_Static_assert(RECORDER_DATA_BYTES % RECORDER_PROGRAM_BYTES == 0 && RECORDER_PROGRAM_BYTES % FLASH_PAGE_SIZE == 0,
+               "RECORDER_PROGRAM_BYTES deve ser múltiplo de página e dividir o trecho");
+_Static_assert(sizeof(recorder_audio_record_t) <= TELEMETRY_MAX_RECORD,
+               "Registro de áudio maior que TELEMETRY_MAX_RECORD");
+
+/**
+ * Cabeçalho na primeira página de cada posição. É gravado por último: uma posição
+ * sem cabeçalho válido (queda de energia no meio da gravação) é tratada como livre.
+ */
+typedef struct {
+    uint32_t magic;        // RECORDER_MAGIC
+    uint32_t seq;          // Número do evento, crescente; o maior é o mais recente
+    uint32_t timestamp_ms; // Instante do disparo (ms desde o boot)
+    float peak_db;         // Maior LAF durante a captura
+    uint32_t sample_rate;  // Taxa das amostras (Hz)
+    uint32_t samples;      // Amostras no trecho
+    uint32_t pre_samples;  // Amostras anteriores ao disparo
+    uint32_t data_crc;     // CRC-32 das amostras
+    uint32_t header_crc;   // CRC-32 dos campos anteriores
+} recorder_header_t;
+
+/**
+ * Estado do trecho, compartilhado entre os núcleos. O núcleo 0 passa de IDLE para
+ * CAPTURING e de CAPTURING para STAGED; o núcleo 1 devolve para IDLE depois de gravar.
+ */
+typedef enum {
+    RECORDER_IDLE,
+    RECORDER_CAPTURING,
+    RECORDER_STAGED
+} recorder_state_t;
+
+// Núcleo 0: janela circular anterior ao disparo (índice crescente, como em trigger.c).
+static int16_t pre_ring[RECORDER_PRE_SAMPLES];
+static uint32_t pre_head;
+static bool was_loud;
+
+// Trecho em montagem pelo núcleo 0 e, depois de STAGED, lido pelo núcleo 1.
+static int16_t staging[RECORDER_SNIPPET_SAMPLES];
+static uint staged_count;
+static recorder_header_t pending;
+static volatile recorder_state_t state = RECORDER_IDLE;
+static volatile bool quiet;
+
+// Núcleo 1: índice na RAM e progresso da gravação.
+static recorder_header_t slots[RECORDER_SLOTS];
+static bool slot_valid[RECORDER_SLOTS];
+static uint next_slot;
+static uint32_t next_seq = 1;
+static uint erased_sectors;   // Setores já apagados em next_slot (a partir do início)
+static uint32_t written_bytes; // Bytes do trecho já gravados em next_slot
+static uint32_t data_crc;
+static bool staged_seen;
+static uint32_t staged_since_ms;
+
+// Núcleo 1: envio de um evento pelo stdio.
+static int dump_slot = -1;
+static uint32_t dump_offset;
+
+static uint32_t sample_rate_hz;
+static volatile uint32_t dropped;
+static uint32_t stored;
+static uint32_t flash_errors;
+
+static uint32_t slot_offset(uint slot) {
+    return FLASH_RECORDER_OFFSET + slot * RECORDER_SLOT_SIZE;
+}
+
+static const int16_t* slot_samples(uint slot) {
+    return (const int16_t*)flash_store_ptr(slot_offset(slot) + FLASH_PAGE_SIZE);
+}
+
+static bool header_is_valid(const recorder_header_t* header) {
+    return header->magic == RECORDER_MAGIC &&
+           header->samples <= RECORDER_SNIPPET_SAMPLES &&
+           header->header_crc == crc32_update(0, (const uint8_t*)header, offsetof(recorder_header_t, header_crc));
+}
+
+static bool sector_is_erased(uint32_t offset) {
+    const uint32_t* words = (const uint32_t*)flash_store_ptr(offset);
+    for (uint i = 0; i < FLASH_SECTOR_SIZE / sizeof(uint32_t); ++i) {
+        if (words[i] != 0xFFFFFFFF)
+            return false;
+    }
+    return true;
+}
+
+void recorder_init(float sample_rate) {
+    sample_rate_hz = (uint32_t)(sample_rate + 0.5f);
+
+    // Uma leitura de cabeçalho por posição; a seguinte à mais recente é a próxima a ser usada.
+    bool found = false;
+    for (uint slot = 0; slot < RECORDER_SLOTS; ++slot) {
+        memcpy(&slots[slot], flash_store_ptr(slot_offset(slot)), sizeof(recorder_header_t));
+        slot_valid[slot] = header_is_valid(&slots[slot]);
+        if (slot_valid[slot] && (!found || slots[slot].seq >= next_seq)) {
+            next_seq = slots[slot].seq + 1;
+            next_slot = (slot + 1) % RECORDER_SLOTS;
+            found = true;
+        }
+    }
+
+    // Os setores são apagados em ordem; uma queda no meio do apagamento continua de onde parou.
+    erased_sectors = 0;
+    while (erased_sectors < RECORDER_SLOT_SECTORS &&
+           sector_is_erased(slot_offset(next_slot) + erased_sectors * FLASH_SECTOR_SIZE))
+        ++erased_sectors;
+
+    uint events = 0;
+    for (uint slot = 0; slot < RECORDER_SLOTS; ++slot)
+        events += slot_valid[slot];
+    LOG_INFO("Gravador: %u eventos, próxima posição %u\n", events, next_slot);
+}
+
+void recorder_feed(const int16_t* samples, uint count) {
+    for (uint i = 0; i < count; ++i)
+        pre_ring[(pre_head + i) % RECORDER_PRE_SAMPLES] = samples[i];
+    pre_head += count;
+
+    if (state != RECORDER_CAPTURING)
+        return;
+
+    uint n = RECORDER_SNIPPET_SAMPLES - staged_count;
+    if (n > count)
+        n = count;
+    memcpy(&staging[staged_count], samples, n * sizeof(int16_t));
+    staged_count += n;
+
+    if (staged_count == RECORDER_SNIPPET_SAMPLES) {
+        pending.samples = staged_count;
+
+        // O trecho e o cabeçalho vão para a memória antes de o núcleo 1 ver STAGED.
+        __mem_fence_release();
+        state = RECORDER_STAGED;
+    }
+}
+
+void recorder_update(float db, float limit_db, uint32_t now_ms) {
+    bool loud = db > limit_db;
+    bool rising = loud && !was_loud;
+    was_loud = loud;
+
+    recorder_state_t s = state;
+    if (s == RECORDER_CAPTURING && db > pending.peak_db)
+        pending.peak_db = db;
+
+    if (!rising || s == RECORDER_CAPTURING)
+        return;
+
+    if (s == RECORDER_STAGED) {
+        ++dropped;
+        return;
+    }
+
+    // Copia a janela anterior em ordem cronológica para o início do trecho.
+    for (uint i = 0; i < RECORDER_PRE_SAMPLES; ++i)
+        staging[i] = pre_ring[(pre_head + i) % RECORDER_PRE_SAMPLES];
+    staged_count = RECORDER_PRE_SAMPLES;
+
+    pending = (recorder_header_t){
+        .magic = RECORDER_MAGIC,
+        .timestamp_ms = now_ms,
+        .peak_db = db,
+        .sample_rate = sample_rate_hz,
+        .pre_samples = RECORDER_PRE_SAMPLES,
+    };
+    state = RECORDER_CAPTURING;
+}
+
+void recorder_set_quiet(bool value) {
+    quiet = value;
+}
+
+/**
+ * Apaga o próximo setor da posição seguinte. O primeiro setor contém o cabeçalho,
+ * então o evento antigo sai do índice antes de qualquer apagamento.
+ */
+static void erase_step(void) {
+    if (erased_sectors == 0)
+        slot_valid[next_slot] = false;
+
+    if (!flash_store_erase(slot_offset(next_slot) + erased_sectors * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE)) {
+        ++flash_errors;
+        return;
+    }
+    ++erased_sectors;
+}
+
+/**
+ * Grava a próxima parte do trecho; depois da última, o cabeçalho confirma o evento.
+ */
+static void program_step(void) {
+    uint32_t offset = slot_offset(next_slot) + FLASH_PAGE_SIZE;
+
+    if (written_bytes < RECORDER_DATA_BYTES) {
+        const uint8_t* data = (const uint8_t*)staging + written_bytes;
+        if (!flash_store_program(offset + written_bytes, data, RECORDER_PROGRAM_BYTES)) {
+            ++flash_errors;
+            return;
+        }
+        data_crc = crc32_update(data_crc, data, RECORDER_PROGRAM_BYTES);
+        written_bytes += RECORDER_PROGRAM_BYTES;
+        return;
+    }
+
+    recorder_header_t header = pending;
+    header.seq = next_seq;
+    header.data_crc = data_crc;
+    header.header_crc = crc32_update(0, (const uint8_t*)&header, offsetof(recorder_header_t, header_crc));
+
+    static uint8_t page[FLASH_PAGE_SIZE]; // Fora da pilha de 2 KB do núcleo 1
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page, &header, sizeof(header));
+    if (!flash_store_program(slot_offset(next_slot), page, sizeof(page))) {
+        ++flash_errors;
+        return;
+    }
+
+    slots[next_slot] = header;
+    slot_valid[next_slot] = true;
+    LOG_INFO("Evento %lu gravado na posição %u (%.1f dB)\n",
+             (unsigned long)header.seq, next_slot, header.peak_db);
+
+    ++stored;
+    ++next_seq;
+    next_slot = (next_slot + 1) % RECORDER_SLOTS;
+    erased_sectors = 0;
+    written_bytes = 0;
+    data_crc = 0;
+    staged_seen = false;
+
+    // O núcleo 0 só volta a escrever no trecho depois de ver IDLE.
+    __mem_fence_release();
+    state = RECORDER_IDLE;
+}
+
+static void stream_step(void) {
+    const recorder_header_t* header = &slots[dump_slot];
+    const int16_t* samples = slot_samples(dump_slot);
+
+    // Estático: mais de 200 bytes, que a pilha de 2 KB do núcleo 1 não precisa carregar.
+    static recorder_audio_record_t record;
+
+    for (uint frame = 0; frame < RECORDER_STREAM_FRAMES && dump_offset < header->samples; ++frame) {
+        record = (recorder_audio_record_t){
+            .type = TELEMETRY_RECORD_AUDIO,
+            .seq = header->seq,
+            .offset = dump_offset,
+        };
+        uint count = header->samples - dump_offset;
+        record.count = count < RECORDER_AUDIO_SAMPLES ? count : RECORDER_AUDIO_SAMPLES;
+        memcpy(record.samples, &samples[dump_offset], record.count * sizeof(int16_t));
+        telemetry_send(&record, sizeof(record));
+        dump_offset += record.count;
+    }
+
+    if (dump_offset >= header->samples)
+        dump_slot = -1;
+}
+
+bool recorder_task(uint32_t now_ms) {
+    bool busy = false;
+
+    if (dump_slot >= 0) {
+        stream_step();
+        busy = true;
+    }
+
+    // A posição sendo enviada não é apagada até o fim do envio.
+    bool slot_in_use = dump_slot == (int)next_slot;
+
+    if (state == RECORDER_STAGED) {
+        __mem_fence_acquire();
+        if (!staged_seen) {
+            staged_seen = true;
+            staged_since_ms = now_ms;
+        }
+
+        // Fora do silêncio o trecho espera; depois de RECORDER_FORCE_WRITE_MS é gravado mesmo assim.
+        if (!slot_in_use && (quiet || now_ms - staged_since_ms >= RECORDER_FORCE_WRITE_MS)) {
+            if (erased_sectors < RECORDER_SLOT_SECTORS)
+                erase_step();
+            else
+                program_step();
+            busy = true;
+        }
+    } else if (erased_sectors < RECORDER_SLOT_SECTORS && quiet && !slot_in_use) {
+        // Apaga a próxima posição com antecedência: o próximo evento só precisa ser gravado.
+        erase_step();
+        busy = true;
+    }
+
+    return busy;
+}
+
+static void print_event(uint slot, const char* suffix) {
+    const recorder_header_t* header = &slots[slot];
+    printf("EVENT,%lu,%lu,%.1f,%lu,%lu,%lu%s\n", (unsigned long)header->seq,
+           (unsigned long)header->timestamp_ms, header->peak_db, (unsigned long)header->sample_rate,
+           (unsigned long)header->samples, (unsigned long)header->pre_samples, suffix);
+}
+
+void recorder_print_index(void) {
+    // A partir da próxima posição, a ordem circular é do mais antigo ao mais recente.
+    for (uint i = 0; i < RECORDER_SLOTS; ++i) {
+        uint slot = (next_slot + i) % RECORDER_SLOTS;
+        if (slot_valid[slot])
+            print_event(slot, "");
+    }
+}
+
+bool recorder_dump(uint32_t seq) {
+    for (uint slot = 0; slot < RECORDER_SLOTS; ++slot) {
+        if (!slot_valid[slot] || slots[slot].seq != seq)
+            continue;
+
+        const uint8_t* data = (const uint8_t*)slot_samples(slot);
+        bool ok = crc32_update(0, data, slots[slot].samples * sizeof(int16_t)) == slots[slot].data_crc;
+        print_event(slot, ok ? ",ok" : ",crc");
+
+        dump_slot = slot;
+        dump_offset = 0;
+        return true;
+    }
+    return false;
+}
+
+void recorder_get_stats(recorder_stats_t* out) {
+    out->stored = stored;
+    out->dropped = dropped;
+    out->flash_errors = flash_errors;
+    out->events = 0;
+    for (uint slot = 0; slot < RECORDER_SLOTS; ++slot)
+        out->events += slot_valid[slot];
+}
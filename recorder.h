@@ -0,0 +1,110 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "flash_store.h"
+
+// Janela mantida na RAM antes do disparo e tamanho total de um trecho, em amostras
+// decimadas (~265 ms e ~530 ms na taxa decimada normal). RECORDER_PRE_SAMPLES é potência de 2.
+#define RECORDER_PRE_SAMPLES 8192
+#define RECORDER_SNIPPET_SAMPLES 16384
+
+// Cada evento ocupa uma posição de setores inteiros: página de cabeçalho seguida das amostras.
+#define RECORDER_SLOT_SIZE (9 * FLASH_SECTOR_SIZE)
+#define RECORDER_SLOTS (FLASH_RECORDER_SIZE / RECORDER_SLOT_SIZE)
+
+// Bytes gravados por passo de recorder_task() (o núcleo 0 fica parado durante a gravação).
+#define RECORDER_PROGRAM_BYTES 1024
+
+// Um trecho pronto espera o silêncio (gatilho armado) para ir para a flash, no máximo este tempo.
+#define RECORDER_FORCE_WRITE_MS 10000
+
+// Registros de áudio enviados por chamada de recorder_task() durante um envio.
+#define RECORDER_STREAM_FRAMES 4
+#define RECORDER_AUDIO_SAMPLES 100
+
+/**
+ * Registro de telemetria com parte de um trecho gravado (TELEMETRY_RECORD_AUDIO).
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t type;         // TELEMETRY_RECORD_AUDIO
+    uint8_t reserved;
+    uint16_t count;       // Amostras válidas em samples
+    uint32_t seq;         // Número do evento
+    uint32_t offset;      // Posição da primeira amostra no trecho
+    int16_t samples[RECORDER_AUDIO_SAMPLES]; // Amostras no formato de mic_decimate()
+} recorder_audio_record_t;
+
+/**
+ * Contadores do gravador.
+ */
+typedef struct {
+    uint32_t stored;       // Eventos gravados na flash desde o boot
+    uint32_t dropped;      // Eventos ignorados porque o trecho anterior ainda não tinha sido gravado
+    uint32_t flash_errors; // Operações na flash que não puderam ser feitas (repetidas depois)
+    uint32_t events;       // Eventos válidos na flash
+} recorder_stats_t;
+
+/**
+ * Monta o índice a partir dos cabeçalhos gravados (um por posição) e descobre a
+ * próxima posição livre. Deve ser chamada antes de iniciar o núcleo 1.
+ * @param sample_rate Taxa das amostras entregues a recorder_feed() (Hz)
+ */
+void recorder_init(float sample_rate);
+
+/**
+ * Acrescenta amostras decimadas à janela anterior ao disparo e, durante uma captura,
+ * ao trecho. Chamada pelo núcleo 0 a cada bloco; só copia amostras.
+ * @param samples Amostras no formato de mic_decimate()
+ * @param count Número de amostras
+ */
+void recorder_feed(const int16_t* samples, uint count);
+
+/**
+ * Verifica o nível do quadro. Ao passar de limit_db, começa a captura de um trecho com a
+ * janela anterior; enquanto a captura dura, guarda o maior nível. Chamada pelo núcleo 0.
+ * @param db Nível do quadro (LAF)
+ * @param limit_db Limite da faixa da sensibilidade atual
+ * @param now_ms Tempo atual
+ */
+void recorder_update(float db, float limit_db, uint32_t now_ms);
+
+/**
+ * Informa se a captura está em silêncio (gatilho armado), quando as operações na
+ * flash podem parar o núcleo 0 sem perder áudio processado.
+ * @param quiet true enquanto o gatilho está armado
+ */
+void recorder_set_quiet(bool quiet);
+
+/**
+ * Executa no máximo uma operação na flash (apagar um setor ou gravar
+ * RECORDER_PROGRAM_BYTES) e envia parte do trecho pedido por recorder_dump().
+ * Chamada pelo laço do núcleo 1.
+ * @param now_ms Tempo atual
+ * @return true se algo foi feito
+ */
+bool recorder_task(uint32_t now_ms);
+
+/**
+ * Escreve no stdio uma linha "EVENT,seq,timestamp_ms,peak_db,sample_rate,samples,pre_samples"
+ * por evento gravado, do mais antigo ao mais recente. Núcleo 1.
+ */
+void recorder_print_index(void);
+
+/**
+ * Começa a enviar um evento em registros TELEMETRY_RECORD_AUDIO, precedidos da linha
+ * EVENT do índice com o resultado da verificação do CRC dos dados. Núcleo 1.
+ * @param seq Número do evento
+ * @return false se o evento não existe
+ */
+bool recorder_dump(uint32_t seq);
+
+/**
+ * Lê os contadores do gravador.
+ * @param stats Estrutura que recebe os contadores
+ */
+void recorder_get_stats(recorder_stats_t* stats);
+
+#endif // RECORDER_H
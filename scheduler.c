@@ -0,0 +1,69 @@
+#include "scheduler.h"
+#include "hardware/sync.h"
+
+/**
+ * Estado de uma tarefa. ticks e tick_us só são escritos pelo callback do timer;
+ * seen e os contadores só pelo núcleo que consome a tarefa.
+ */
+typedef struct {
+    repeating_timer_t timer;
+    volatile uint32_t ticks;
+    volatile uint32_t tick_us;
+    uint32_t seen;
+    volatile uint32_t runs;
+    volatile uint32_t overruns;
+    volatile uint32_t max_latency_us;
+} scheduler_slot_t;
+
+static scheduler_slot_t slots[SCHEDULER_TASKS];
+
+static bool scheduler_tick(repeating_timer_t* timer) {
+    scheduler_slot_t* slot = timer->user_data;
+
+    slot->tick_us = time_us_32();
+    __mem_fence_release();
+    slot->ticks = slot->ticks + 1;
+
+    __sev(); // Acorda o núcleo 1 se ele estiver em __wfe(); o núcleo 0 já acorda pela interrupção.
+    return true;
+}
+
+void scheduler_init(void) {
+    static const uint32_t periods_ms[SCHEDULER_TASKS] = {
+        [SCHEDULER_FRAME] = SCHEDULER_FRAME_PERIOD_MS,
+        [SCHEDULER_LED] = SCHEDULER_LED_PERIOD_MS,
+    };
+
+    for (uint i = 0; i < SCHEDULER_TASKS; ++i) {
+        slots[i] = (scheduler_slot_t){0};
+        // Período negativo: o intervalo é contado entre os inícios, sem acumular o atraso dos callbacks.
+        add_repeating_timer_ms(-(int32_t)periods_ms[i], scheduler_tick, &slots[i], &slots[i].timer);
+    }
+}
+
+bool scheduler_due(scheduler_task_t task) {
+    scheduler_slot_t* slot = &slots[task];
+    uint32_t ticks = slot->ticks;
+
+    if (ticks == slot->seen)
+        return false;
+
+    __mem_fence_acquire();
+
+    uint32_t latency = time_us_32() - slot->tick_us;
+    if (latency > slot->max_latency_us)
+        slot->max_latency_us = latency;
+
+    slot->overruns += ticks - slot->seen - 1;
+    slot->seen = ticks;
+    ++slot->runs;
+    return true;
+}
+
+void scheduler_get_stats(scheduler_task_t task, scheduler_stats_t* stats) {
+    const scheduler_slot_t* slot = &slots[task];
+
+    stats->runs = slot->runs;
+    stats->overruns = slot->overruns;
+    stats->max_latency_us = slot->max_latency_us;
+}
@@ -0,0 +1,52 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+
+// Período de publicação das medições (núcleo 0) e de atualização da matriz de LEDs (núcleo 1).
+#define SCHEDULER_FRAME_PERIOD_MS 200
+#define SCHEDULER_LED_PERIOD_MS 50
+
+/**
+ * Tarefas com prazo. Cada uma é consumida por um único núcleo.
+ */
+typedef enum {
+    SCHEDULER_FRAME, // Núcleo 0: fecha o quadro de medição e publica
+    SCHEDULER_LED,   // Núcleo 1: redesenha a matriz de LEDs (efeito de piscar)
+    SCHEDULER_TASKS
+} scheduler_task_t;
+
+/**
+ * Contadores de uma tarefa.
+ */
+typedef struct {
+    uint32_t runs;           // Prazos atendidos
+    uint32_t overruns;       // Prazos perdidos porque a tarefa anterior ainda não tinha rodado
+    uint32_t max_latency_us; // Maior atraso entre o prazo e o início da tarefa
+} scheduler_stats_t;
+
+/**
+ * Inicia os timers repetitivos de hardware das tarefas. Os callbacks rodam no núcleo
+ * que chamar esta função e só incrementam um contador e acordam o núcleo 1 (__sev()).
+ */
+void scheduler_init(void);
+
+/**
+ * Consome o prazo vencido de uma tarefa, se houver. Deve ser chamada sempre pelo mesmo núcleo.
+ * Se mais de um prazo venceu desde a última chamada, a tarefa roda uma vez e os demais
+ * contam como overrun; o período seguinte continua alinhado ao timer.
+ * @param task Tarefa
+ * @return true se a tarefa deve rodar agora
+ */
+bool scheduler_due(scheduler_task_t task);
+
+/**
+ * Lê os contadores de uma tarefa.
+ * @param task Tarefa
+ * @param stats Estrutura que recebe os contadores
+ */
+void scheduler_get_stats(scheduler_task_t task, scheduler_stats_t* stats);
+
+#endif // SCHEDULER_H
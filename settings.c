@@ -0,0 +1,313 @@
+#include "settings.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "hardware/sync.h"
+#include "crc.h"
+#include "flash_store.h"
+#include "log.h"
+
+#define SETTINGS_MAGIC 0x31544553 // "SET1"
+#define SETTINGS_SLOT_SIZE 8
+#define SETTINGS_SLOTS (FLASH_SECTOR_SIZE / SETTINGS_SLOT_SIZE)
+#define SETTINGS_SLOTS_PER_PAGE (FLASH_PAGE_SIZE / SETTINGS_SLOT_SIZE)
+
+/**
+ * Cada setor é um log: a posição 0 tem o cabeçalho e as seguintes, registros de 8 bytes
+ * gravados em ordem. Uma posição só com 0xFF marca o fim do log. O último registro
+ * válido de cada chave vale; um registro com CRC errado (queda de energia no meio da
+ * gravação) é ignorado.
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t generation; // Maior (com volta) = setor ativo
+    uint16_t crc;        // CRC-16 dos campos anteriores
+} settings_header_t;
+
+typedef struct {
+    uint16_t key;
+    uint16_t crc;   // CRC-16 de key e value
+    uint32_t value;
+} settings_record_t;
+
+_Static_assert(sizeof(settings_header_t) == SETTINGS_SLOT_SIZE && sizeof(settings_record_t) == SETTINGS_SLOT_SIZE,
+               "Cabeçalho e registros ocupam uma posição cada");
+_Static_assert(SETTINGS_KEYS < SETTINGS_SLOTS_PER_PAGE,
+               "Na compactação, o cabeçalho e uma cópia de cada chave cabem na primeira página");
+
+static const struct {
+    const char* name;
+    bool is_float; // Gravada com settings_set_float(); só muda a forma de mostrar
+} SETTINGS_INFO[SETTINGS_KEYS] = {
+    [SETTINGS_SENSITIVITY] = {"sensitivity", false},
+    [SETTINGS_VIEW] = {"view", false},
+    [SETTINGS_SOURCE] = {"source", false},
+    [SETTINGS_CAL_GAIN] = {"cal_gain", true},
+    [SETTINGS_CAL_OFFSET] = {"cal_offset", true},
+};
+
+// Cache na RAM. Quem altera uma chave escreve o valor e o instante e depois incrementa a
+// versão; cada chave tem um só escritor, então nada é escrito pelos dois núcleos.
+static volatile uint32_t values[SETTINGS_KEYS];
+static volatile uint32_t versions[SETTINGS_KEYS];
+static volatile bool present[SETTINGS_KEYS];
+static volatile uint32_t changed_ms[SETTINGS_KEYS];
+static volatile bool quiet;
+
+// Núcleo 1: estado da flash.
+static uint32_t persisted[SETTINGS_KEYS]; // Versão de cada chave já gravada
+static uint active;                       // Setor com o log atual
+static bool formatted;                    // O setor ativo tem cabeçalho válido
+static uint16_t generation;
+static uint next_slot;                    // Próxima posição livre no setor ativo
+static bool pending_seen;
+static uint32_t pending_since_ms;
+
+// Compactação: apagar o outro setor, copiar as chaves, gravar o cabeçalho.
+static enum { COMPACT_NONE, COMPACT_ERASED, COMPACT_COPIED } compact;
+static uint32_t compact_versions[SETTINGS_KEYS];
+
+static uint32_t sector_offset(uint sector) {
+    return FLASH_SETTINGS_OFFSET + sector * FLASH_SECTOR_SIZE;
+}
+
+static uint16_t record_crc(uint16_t key, uint32_t value) {
+    uint8_t bytes[6] = {key & 0xFF, key >> 8, value & 0xFF, (value >> 8) & 0xFF, (value >> 16) & 0xFF, value >> 24};
+    return crc16_ccitt(bytes, sizeof(bytes));
+}
+
+static bool header_is_valid(const settings_header_t* header) {
+    return header->magic == SETTINGS_MAGIC &&
+           header->crc == crc16_ccitt((const uint8_t*)header, offsetof(settings_header_t, crc));
+}
+
+static bool slot_is_empty(const uint8_t* slot) {
+    for (uint i = 0; i < SETTINGS_SLOT_SIZE; ++i) {
+        if (slot[i] != 0xFF)
+            return false;
+    }
+    return true;
+}
+
+void settings_init(void) {
+    settings_header_t headers[2];
+    bool valid[2];
+    for (uint sector = 0; sector < 2; ++sector) {
+        memcpy(&headers[sector], flash_store_ptr(sector_offset(sector)), sizeof(settings_header_t));
+        valid[sector] = header_is_valid(&headers[sector]);
+    }
+
+    // Se os dois são válidos (queda antes de o antigo ser reaproveitado), vale a geração mais nova.
+    formatted = valid[0] || valid[1];
+    if (valid[0] && valid[1])
+        active = (int16_t)(headers[1].generation - headers[0].generation) > 0;
+    else
+        active = valid[1] ? 1 : 0;
+
+    if (!formatted) {
+        // Nada gravado: a primeira alteração formata o setor 0 (compactação para o outro lado).
+        active = 1;
+        LOG_INFO("Configurações: nenhuma gravada\n");
+        return;
+    }
+
+    generation = headers[active].generation;
+
+    // Uma passada pelos registros; os mais novos sobrescrevem os mais antigos.
+    const uint8_t* log = flash_store_ptr(sector_offset(active));
+    uint records = 0;
+    for (next_slot = 1; next_slot < SETTINGS_SLOTS; ++next_slot) {
+        const uint8_t* slot = log + next_slot * SETTINGS_SLOT_SIZE;
+        if (slot_is_empty(slot))
+            break;
+
+        settings_record_t record;
+        memcpy(&record, slot, sizeof(record));
+        if (record.key < SETTINGS_KEYS && record.crc == record_crc(record.key, record.value)) {
+            values[record.key] = record.value;
+            present[record.key] = true;
+            ++records;
+        }
+    }
+
+    LOG_INFO("Configurações: %u registros no setor %u\n", records, active);
+}
+
+uint32_t settings_get(settings_key_t key, uint32_t fallback) {
+    return key < SETTINGS_KEYS && present[key] ? values[key] : fallback;
+}
+
+float settings_get_float(settings_key_t key, float fallback) {
+    if (key >= SETTINGS_KEYS || !present[key])
+        return fallback;
+
+    uint32_t bits = values[key];
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void settings_set(settings_key_t key, uint32_t value) {
+    if (key >= SETTINGS_KEYS || (present[key] && values[key] == value))
+        return;
+
+    values[key] = value;
+    present[key] = true;
+    changed_ms[key] = to_ms_since_boot(get_absolute_time());
+
+    // O valor e o instante vão para a memória antes de o núcleo 1 ver a nova versão.
+    __mem_fence_release();
+    ++versions[key];
+}
+
+void settings_set_float(settings_key_t key, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    settings_set(key, bits);
+}
+
+void settings_set_quiet(bool value) {
+    quiet = value;
+}
+
+/**
+ * Primeira chave com versão mais nova que a gravada, ou SETTINGS_KEYS.
+ */
+static uint dirty_key(void) {
+    for (uint key = 0; key < SETTINGS_KEYS; ++key) {
+        if (versions[key] != persisted[key])
+            return key;
+    }
+    return SETTINGS_KEYS;
+}
+
+/**
+ * Tempo desde a alteração mais recente entre as chaves ainda não gravadas, ou
+ * UINT32_MAX se não há nenhuma.
+ */
+static uint32_t dirty_age_ms(uint32_t now_ms) {
+    uint32_t age = UINT32_MAX;
+    for (uint key = 0; key < SETTINGS_KEYS; ++key) {
+        if (versions[key] == persisted[key])
+            continue;
+
+        // Lido depois da versão: é o instante dela ou de uma alteração mais nova.
+        __mem_fence_acquire();
+        int32_t key_age = (int32_t)(now_ms - changed_ms[key]);
+        if (key_age < 0) // Alterada depois de now_ms ser lido
+            key_age = 0;
+        if ((uint32_t)key_age < age)
+            age = key_age;
+    }
+    return age;
+}
+
+static bool program_slot(uint sector, uint slot, const void* data) {
+    static uint8_t page[FLASH_PAGE_SIZE]; // Núcleo 1 só; fora da pilha de 2 KB
+    uint page_slot = slot % SETTINGS_SLOTS_PER_PAGE;
+
+    // O resto da página vai com 0xFF, que não altera o que já está gravado.
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page + page_slot * SETTINGS_SLOT_SIZE, data, SETTINGS_SLOT_SIZE);
+    return flash_store_program(sector_offset(sector) + (slot - page_slot) * SETTINGS_SLOT_SIZE, page, sizeof(page));
+}
+
+/**
+ * Um passo da compactação: o outro setor recebe uma cópia de cada chave e, por último,
+ * o cabeçalho com a geração seguinte. Até o cabeçalho ser gravado, o setor antigo continua valendo.
+ */
+static void compact_step(void) {
+    uint target = active ^ 1;
+
+    if (compact == COMPACT_NONE) {
+        if (flash_store_erase(sector_offset(target), FLASH_SECTOR_SIZE))
+            compact = COMPACT_ERASED;
+        return;
+    }
+
+    if (compact == COMPACT_ERASED) {
+        static uint8_t page[FLASH_PAGE_SIZE];
+        memset(page, 0xFF, sizeof(page));
+
+        uint slot = 1;
+        for (uint key = 0; key < SETTINGS_KEYS; ++key) {
+            compact_versions[key] = versions[key];
+            __mem_fence_acquire();
+            if (!present[key])
+                continue;
+
+            settings_record_t record = {key, 0, values[key]};
+            record.crc = record_crc(key, record.value);
+            memcpy(page + slot++ * SETTINGS_SLOT_SIZE, &record, sizeof(record));
+        }
+
+        if (flash_store_program(sector_offset(target), page, sizeof(page))) {
+            next_slot = slot;
+            compact = COMPACT_COPIED;
+        }
+        return;
+    }
+
+    settings_header_t header = {SETTINGS_MAGIC, (uint16_t)(generation + 1), 0};
+    header.crc = crc16_ccitt((const uint8_t*)&header, offsetof(settings_header_t, crc));
+    if (!program_slot(target, 0, &header))
+        return;
+
+    active = target;
+    generation = header.generation;
+    formatted = true;
+    compact = COMPACT_NONE;
+    for (uint key = 0; key < SETTINGS_KEYS; ++key)
+        persisted[key] = compact_versions[key];
+    LOG_INFO("Configurações compactadas no setor %u\n", active);
+}
+
+bool settings_task(uint32_t now_ms) {
+    uint key = dirty_key();
+    if (key == SETTINGS_KEYS && compact == COMPACT_NONE) {
+        pending_seen = false;
+        return false;
+    }
+
+    if (!pending_seen) {
+        pending_seen = true;
+        pending_since_ms = now_ms;
+    }
+
+    // Espera as alterações pararem e o silêncio (ou SETTINGS_FORCE_WRITE_MS).
+    if (dirty_age_ms(now_ms) < SETTINGS_WRITE_DELAY_MS)
+        return false;
+    if (!quiet && now_ms - pending_since_ms < SETTINGS_FORCE_WRITE_MS)
+        return false;
+
+    if (!formatted || compact != COMPACT_NONE || next_slot >= SETTINGS_SLOTS) {
+        compact_step();
+        return true;
+    }
+
+    uint32_t version = versions[key];
+    __mem_fence_acquire();
+    settings_record_t record = {key, 0, values[key]};
+    record.crc = record_crc(key, record.value);
+
+    // Se o núcleo 0 não parou, a flash não foi tocada: a mesma posição é tentada de novo,
+    // já que o boot para na primeira posição em branco.
+    if (program_slot(active, next_slot, &record)) {
+        persisted[key] = version;
+        ++next_slot;
+    }
+    return true;
+}
+
+void settings_print(void) {
+    for (uint key = 0; key < SETTINGS_KEYS; ++key) {
+        if (!present[key])
+            continue;
+
+        bool saved = versions[key] == persisted[key];
+        if (SETTINGS_INFO[key].is_float)
+            printf("SETTING,%s,%.4f,%d\n", SETTINGS_INFO[key].name, settings_get_float(key, 0.f), saved);
+        else
+            printf("SETTING,%s,%lu,%d\n", SETTINGS_INFO[key].name, (unsigned long)values[key], saved);
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+
+// Espera depois da última alteração antes de gravar (vários cliques viram uma gravação).
+#define SETTINGS_WRITE_DELAY_MS 5000
+
+// Uma alteração espera o silêncio (gatilho armado) para ir para a flash, no máximo este tempo.
+#define SETTINGS_FORCE_WRITE_MS 30000
+
+/**
+ * Chaves das configurações. Os números ficam gravados na flash: novas chaves entram
+ * no fim, e uma chave removida não deve ter o número reaproveitado.
+ */
+typedef enum {
+    SETTINGS_SENSITIVITY, // Nível de sensibilidade (1 a 5)
+    SETTINGS_VIEW,        // Tela exibida (view_mode_t)
+    SETTINGS_SOURCE,      // Fonte do nível exibido (channels_source_t)
+    SETTINGS_CAL_GAIN,    // Ganho da calibração da placa (float, mic_set_calibration())
+    SETTINGS_CAL_OFFSET,  // Offset da calibração da placa (float, dB)
+    SETTINGS_KEYS
+} settings_key_t;
+
+/**
+ * Carrega as configurações da flash para a RAM, lendo cada registro uma vez.
+ * Deve ser chamada antes de iniciar o núcleo 1.
+ */
+void settings_init(void);
+
+/**
+ * Lê uma configuração da RAM.
+ * @param key Chave
+ * @param fallback Valor devolvido se a chave nunca foi gravada
+ * @return Valor
+ */
+uint32_t settings_get(settings_key_t key, uint32_t fallback);
+
+/**
+ * Lê uma configuração de ponto flutuante.
+ * @param key Chave
+ * @param fallback Valor devolvido se a chave nunca foi gravada
+ * @return Valor
+ */
+float settings_get_float(settings_key_t key, float fallback);
+
+/**
+ * Altera uma configuração na RAM; a gravação na flash é feita depois por settings_task().
+ * Cada chave deve ser alterada sempre pelo mesmo núcleo.
+ * @param key Chave
+ * @param value Valor
+ */
+void settings_set(settings_key_t key, uint32_t value);
+
+/**
+ * Altera uma configuração de ponto flutuante (ver settings_set()).
+ * @param key Chave
+ * @param value Valor
+ */
+void settings_set_float(settings_key_t key, float value);
+
+/**
+ * Informa se a captura está em silêncio (gatilho armado), quando as gravações
+ * podem parar o núcleo 0 sem perder áudio processado.
+ * @param quiet true enquanto o gatilho está armado
+ */
+void settings_set_quiet(bool quiet);
+
+/**
+ * Executa no máximo uma operação na flash (gravar uma página ou apagar um setor).
+ * Chamada pelo laço do núcleo 1.
+ * @param now_ms Tempo atual
+ * @return true se algo foi feito
+ */
+bool settings_task(uint32_t now_ms);
+
+/**
+ * Escreve no stdio uma linha "SETTING,chave,valor,gravado" por chave conhecida. Núcleo 1.
+ */
+void settings_print(void);
+
+#endif // SETTINGS_H
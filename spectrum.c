@@ -0,0 +1,117 @@
+#include <math.h>
+#include "spectrum.h"
+#include "mic.h"
+
+// Tabelas em Q15 calculadas uma única vez em spectrum_init().
+static int16_t twiddle_cos[SPECTRUM_N / 2];
+static int16_t twiddle_sin[SPECTRUM_N / 2];
+static int16_t hann[SPECTRUM_N];
+
+// Primeiro e último bin (inclusive) de cada banda.
+static uint16_t band_first[SPECTRUM_BANDS];
+static uint16_t band_last[SPECTRUM_BANDS];
+
+// Janela sendo preenchida e vetores de trabalho da FFT.
+static int16_t window[SPECTRUM_N];
+static uint window_fill;
+static int16_t re[SPECTRUM_N];
+static int16_t im[SPECTRUM_N];
+
+// Ganho de potência médio da janela de Hann (média de w²).
+#define HANN_POWER_GAIN 0.375f
+
+void spectrum_init(float sample_rate) {
+    const float two_pi = 6.28318531f;
+
+    for (uint i = 0; i < SPECTRUM_N / 2; ++i) {
+        twiddle_cos[i] = (int16_t)lroundf(32767.f * cosf(two_pi * i / SPECTRUM_N));
+        twiddle_sin[i] = (int16_t)lroundf(32767.f * sinf(two_pi * i / SPECTRUM_N));
+    }
+
+    for (uint i = 0; i < SPECTRUM_N; ++i)
+        hann[i] = (int16_t)lroundf(32767.f * 0.5f * (1.f - cosf(two_pi * i / SPECTRUM_N)));
+
+    // Bandas de oitava: de fc/sqrt(2) a fc*sqrt(2).
+    const float centers[SPECTRUM_BANDS] = SPECTRUM_BAND_CENTERS;
+    const float bin_hz = sample_rate / SPECTRUM_N;
+    for (uint b = 0; b < SPECTRUM_BANDS; ++b) {
+        int first = (int)lroundf(centers[b] * 0.70710678f / bin_hz);
+        int last = (int)lroundf(centers[b] * 1.41421356f / bin_hz) - 1;
+
+        if (first < 1) first = 1; // O bin 0 é o nível DC.
+        if (last > SPECTRUM_N / 2 - 1) last = SPECTRUM_N / 2 - 1;
+        if (last < first) last = first;
+
+        band_first[b] = first;
+        band_last[b] = last;
+    }
+
+    window_fill = 0;
+}
+
+bool spectrum_feed(const int16_t* samples, uint count) {
+    while (count-- && window_fill < SPECTRUM_N)
+        window[window_fill++] = *samples++;
+
+    return window_fill == SPECTRUM_N;
+}
+
+/**
+ * FFT radix-2 em ponto fixo (Q15), no lugar, com divisão por 2 a cada estágio
+ * para não estourar. O resultado fica escalado por 1/SPECTRUM_N.
+ */
+static void fft_q15(void) {
+    // Permutação por inversão de bits.
+    for (uint i = 1, j = 0; i < SPECTRUM_N; ++i) {
+        uint bit = SPECTRUM_N >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j |= bit;
+
+        if (i < j) {
+            int16_t t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    for (uint half = 1, step = SPECTRUM_N / 2; half < SPECTRUM_N; half <<= 1, step >>= 1) {
+        for (uint j = 0; j < half; ++j) {
+            int32_t wr = twiddle_cos[j * step];
+            int32_t wi = -twiddle_sin[j * step];
+
+            for (uint i = j; i < SPECTRUM_N; i += 2 * half) {
+                uint k = i + half;
+                int32_t tr = (wr * re[k] - wi * im[k]) >> 15;
+                int32_t ti = (wr * im[k] + wi * re[k]) >> 15;
+
+                re[k] = (re[i] - tr) >> 1;
+                im[k] = (im[i] - ti) >> 1;
+                re[i] = (re[i] + tr) >> 1;
+                im[i] = (im[i] + ti) >> 1;
+            }
+        }
+    }
+}
+
+void spectrum_compute(float band_db[SPECTRUM_BANDS]) {
+    for (uint i = 0; i < SPECTRUM_N; ++i) {
+        re[i] = (int16_t)(((int32_t)window[i] * hann[i]) >> 15);
+        im[i] = 0;
+    }
+    window_fill = 0;
+
+    fft_q15();
+
+    for (uint b = 0; b < SPECTRUM_BANDS; ++b) {
+        uint64_t energy = 0;
+        for (uint k = band_first[b]; k <= band_last[b]; ++k)
+            energy += (uint32_t)((int32_t)re[k] * re[k] + (int32_t)im[k] * im[k]);
+
+        // Parseval: as frequências negativas dobram a energia, e a janela de Hann
+        // reduz a potência média por HANN_POWER_GAIN. A FFT já divide por N.
+        float mean_square = 2.f * (float)energy / HANN_POWER_GAIN;
+        float rms_voltage = sqrtf(mean_square) / (1 << MIC_DECIMATED_FRAC_BITS) * ADC_VOLTS_PER_COUNT;
+
+        band_db[b] = mic_rms_to_db(rms_voltage);
+    }
+}
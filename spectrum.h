@@ -0,0 +1,37 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+
+// Tamanho da janela da FFT (potência de 2) e número de bandas de oitava.
+#define SPECTRUM_LOG2_N 10
+#define SPECTRUM_N (1 << SPECTRUM_LOG2_N)
+#define SPECTRUM_BANDS 5
+
+// Frequências centrais das bandas de oitava (Hz), uma por coluna da matriz de LEDs.
+#define SPECTRUM_BAND_CENTERS {250.f, 500.f, 1000.f, 2000.f, 4000.f}
+
+/**
+ * Prepara as tabelas de twiddle e da janela de Hann e calcula os bins de cada banda.
+ * @param sample_rate Taxa das amostras entregues a spectrum_feed() (Hz)
+ */
+void spectrum_init(float sample_rate);
+
+/**
+ * Acrescenta amostras decimadas à janela da FFT.
+ * @param samples Amostras no formato de mic_decimate()
+ * @param count Número de amostras
+ * @return true quando a janela ficou completa e spectrum_compute() pode ser chamada
+ */
+bool spectrum_feed(const int16_t* samples, uint count);
+
+/**
+ * Calcula a FFT em ponto fixo da janela completa e a energia de cada banda.
+ * Depois do cálculo a janela volta a ser preenchida do início.
+ * @param band_db Recebe o nível de cada banda em dB (mesma escala de mic_rms_to_db())
+ */
+void spectrum_compute(float band_db[SPECTRUM_BANDS]);
+
+#endif // SPECTRUM_H
@@ -0,0 +1,204 @@
+#include <math.h>
+#include "spl.h"
+#include "mic.h"
+
+/**
+ * Ponderações A e C como cascata de seções de primeira ordem em ponto fixo
+ * (polos da IEC 61672: 20,6 Hz, 107,7 Hz, 737,9 Hz e 12194 Hz).
+ *   C = 2x passa-altas 20,6 Hz + 2x passa-baixas 12194 Hz
+ *   A = C + passa-altas 107,7 Hz + passa-altas 737,9 Hz
+ * Cada seção usa uma única multiplicação por amostra. O ganho em 1 kHz é
+ * normalizado na conversão para dB, fora do laço por amostra.
+ */
+typedef struct {
+    int32_t k;     // (1 - a) em ponto fixo, a = polo do filtro
+    uint8_t shift; // Bits fracionários de k
+    bool lowpass;
+    int32_t x1, y1;
+} spl_section_t;
+
+// Bits extras do estado interno em relação às amostras decimadas.
+#define SPL_STATE_BITS 4
+
+enum { SEC_C_HP1, SEC_C_HP2, SEC_C_LP1, SEC_C_LP2, SEC_A_HP1, SEC_A_HP2, SPL_SECTIONS };
+
+static const float SECTION_HZ[SPL_SECTIONS] = {20.6f, 20.6f, 12194.0f, 12194.0f, 107.7f, 737.9f};
+static const bool SECTION_LOWPASS[SPL_SECTIONS] = {false, false, true, true, false, false};
+
+static spl_section_t sections[SPL_SECTIONS];
+
+// Ganho de potência dos filtros em 1 kHz (para normalizar a 0 dB).
+static float gain_a, gain_c;
+
+// Médias exponenciais do quadrado (unidades: amostras decimadas ao quadrado).
+static int64_t alpha_fast_q24, alpha_slow_q24;
+static uint32_t ms_a_fast, ms_a_slow, ms_c_fast;
+
+// Acumuladores do Leq e extremos do LAF.
+static uint64_t leq_energy;
+static uint64_t leq_samples;
+static uint32_t ms_a_fast_max, ms_a_fast_min;
+
+// Blocos até a média Fast sair do zero inicial (5 constantes de tempo); antes disso
+// o LAF ainda está subindo e não vale como mínimo.
+#define SPL_SETTLE_TAUS 5
+static uint32_t settle_blocks;
+
+// Medição da carga.
+static float sample_period_us;
+static uint64_t busy_us;
+static uint64_t processed_samples;
+
+/**
+ * Com amostras de 16 bits e SPL_STATE_BITS, o estado chega a 2^19 e x - y1 a 2^20 num
+ * degrau de fundo de escala; com k até 2^11 o produto passa de 31 bits, então é feito em 64.
+ */
+static inline int32_t spl_section_step(spl_section_t* s, int32_t x) {
+    int32_t y;
+
+    if (s->lowpass)
+        y = s->y1 + (int32_t)(((int64_t)(x - s->y1) * s->k) >> s->shift);          // y = a*y1 + (1-a)*x
+    else
+        y = s->y1 + (x - s->x1) - (int32_t)(((int64_t)s->y1 * s->k) >> s->shift);  // y = a*y1 + x - x1
+
+    s->x1 = x;
+    s->y1 = y;
+    return y;
+}
+
+/**
+ * Ganho de potência de uma seção na frequência normalizada w (rad/amostra).
+ */
+static float spl_section_power_gain(const spl_section_t* s, float w) {
+    float a = 1.f - (float)s->k / (1u << s->shift);
+    float den = 1.f - 2.f * a * cosf(w) + a * a; // |1 - a e^-jw|²
+
+    if (s->lowpass)
+        return (1.f - a) * (1.f - a) / den;
+    return (2.f - 2.f * cosf(w)) / den;          // |1 - e^-jw|²
+}
+
+static uint32_t spl_ema(uint32_t average, uint32_t value, int64_t alpha_q24) {
+    return (uint32_t)((int64_t)average + ((((int64_t)value - average) * alpha_q24) >> 24));
+}
+
+// Média dos quadrados de um bloco, saturada no limite das médias de 32 bits.
+static uint32_t spl_mean_square(uint64_t sum, uint count) {
+    uint64_t mean = sum / count;
+    return mean > UINT32_MAX ? UINT32_MAX : (uint32_t)mean;
+}
+
+static float spl_ms_to_db(uint32_t mean_square, float power_gain) {
+    float rms_voltage = sqrtf(mean_square / power_gain) / (1 << MIC_DECIMATED_FRAC_BITS) * ADC_VOLTS_PER_COUNT;
+    return mic_rms_to_db(rms_voltage);
+}
+
+void spl_init(float sample_rate) {
+    const float two_pi = 6.28318531f;
+    const float w_1k = two_pi * 1000.f / sample_rate;
+
+    gain_a = gain_c = 1.f;
+    for (uint i = 0; i < SPL_SECTIONS; ++i) {
+        spl_section_t* s = &sections[i];
+        float one_minus_a = 1.f - expf(-two_pi * SECTION_HZ[i] / sample_rate);
+
+        // Maior número de bits fracionários que ainda deixa k < 2^11 (precisão do polo
+        // melhor que 0,1%); o produto pelo estado é feito em 64 bits em spl_section_step().
+        s->shift = 0;
+        while (s->shift < 24 && one_minus_a * (1u << (s->shift + 1)) < 2047.f)
+            ++s->shift;
+        s->k = (int32_t)lroundf(one_minus_a * (1u << s->shift));
+        s->lowpass = SECTION_LOWPASS[i];
+        s->x1 = s->y1 = 0;
+
+        float g = spl_section_power_gain(s, w_1k);
+        gain_a *= g;
+        if (i < SEC_A_HP1)
+            gain_c *= g;
+    }
+
+    float block_s = MIC_DECIMATED_SAMPLES / sample_rate;
+    alpha_fast_q24 = llroundf((1.f - expf(-block_s / SPL_FAST_TAU)) * (1 << 24));
+    alpha_slow_q24 = llroundf((1.f - expf(-block_s / SPL_SLOW_TAU)) * (1 << 24));
+    ms_a_fast = ms_a_slow = ms_c_fast = 0;
+    settle_blocks = (uint32_t)ceilf(SPL_SETTLE_TAUS * SPL_FAST_TAU / block_s);
+
+    sample_period_us = 1e6f / sample_rate;
+    busy_us = 0;
+    processed_samples = 0;
+
+    spl_reset();
+}
+
+void spl_reset(void) {
+    leq_energy = 0;
+    leq_samples = 0;
+    ms_a_fast_max = 0;
+    ms_a_fast_min = UINT32_MAX;
+}
+
+void spl_process(const int16_t* samples, uint count) {
+    uint32_t start_us = time_us_32();
+    uint64_t sum_a = 0, sum_c = 0;
+
+    for (uint i = 0; i < count; ++i) {
+        int32_t x = (int32_t)samples[i] << SPL_STATE_BITS;
+
+        int32_t y = spl_section_step(&sections[SEC_C_HP1], x);
+        y = spl_section_step(&sections[SEC_C_HP2], y);
+        y = spl_section_step(&sections[SEC_C_LP1], y);
+        y = spl_section_step(&sections[SEC_C_LP2], y);
+        int32_t c = y >> SPL_STATE_BITS;
+
+        y = spl_section_step(&sections[SEC_A_HP1], y);
+        y = spl_section_step(&sections[SEC_A_HP2], y);
+        int32_t a = y >> SPL_STATE_BITS;
+
+        // Os passa-altas dobram um degrau de fundo de escala: |a| passa de 2^16 e o quadrado
+        // não cabe em 32 bits.
+        sum_c += (uint64_t)((int64_t)c * c);
+        sum_a += (uint64_t)((int64_t)a * a);
+    }
+
+    if (count == 0)
+        return;
+
+    // Ponderação temporal exponencial, atualizada uma vez por bloco.
+    uint32_t ms_a = spl_mean_square(sum_a, count);
+    uint32_t ms_c = spl_mean_square(sum_c, count);
+    ms_a_fast = spl_ema(ms_a_fast, ms_a, alpha_fast_q24);
+    ms_a_slow = spl_ema(ms_a_slow, ms_a, alpha_slow_q24);
+    ms_c_fast = spl_ema(ms_c_fast, ms_c, alpha_fast_q24);
+
+    // Acumuladores incrementais.
+    leq_energy += sum_a;
+    leq_samples += count;
+    if (ms_a_fast > ms_a_fast_max) ms_a_fast_max = ms_a_fast;
+    if (settle_blocks)
+        --settle_blocks;
+    else if (ms_a_fast < ms_a_fast_min)
+        ms_a_fast_min = ms_a_fast;
+
+    busy_us += time_us_32() - start_us;
+    processed_samples += count;
+}
+
+void spl_skip(uint count) {
+    leq_energy += (uint64_t)ms_a_fast * count;
+    leq_samples += count;
+}
+
+void spl_get_levels(spl_levels_t* levels) {
+    levels->laf = spl_ms_to_db(ms_a_fast, gain_a);
+    levels->las = spl_ms_to_db(ms_a_slow, gain_a);
+    levels->lcf = spl_ms_to_db(ms_c_fast, gain_c);
+    levels->laeq = leq_samples ? spl_ms_to_db((uint32_t)(leq_energy / leq_samples), gain_a) : 0.0f;
+    levels->lafmax = spl_ms_to_db(ms_a_fast_max, gain_a);
+    levels->lafmin = ms_a_fast_min == UINT32_MAX ? 0.0f : spl_ms_to_db(ms_a_fast_min, gain_a);
+}
+
+float spl_get_load(void) {
+    if (processed_samples == 0)
+        return 0.0f;
+    return (float)busy_us / (processed_samples * sample_period_us);
+}
@@ -0,0 +1,62 @@
+#ifndef SPL_H
+#define SPL_H
+
+#include <stdint.h>
+#include "pico/stdlib.h"
+
+// Constantes de tempo da ponderação temporal (s).
+#define SPL_FAST_TAU 0.125f
+#define SPL_SLOW_TAU 1.0f
+
+/**
+ * Níveis calculados pelo medidor, em dB na escala de mic_rms_to_db().
+ */
+typedef struct {
+    float laf;    // Ponderação A, tempo Fast
+    float las;    // Ponderação A, tempo Slow
+    float lcf;    // Ponderação C, tempo Fast
+    float laeq;   // Nível equivalente A desde spl_reset()
+    float lafmax; // Maior LAF desde spl_reset()
+    float lafmin; // Menor LAF desde spl_reset(), sem a subida inicial da média Fast
+} spl_levels_t;
+
+/**
+ * Calcula os coeficientes dos filtros A e C e das constantes de tempo para a taxa de amostragem.
+ * @param sample_rate Taxa das amostras entregues a spl_process() (Hz)
+ */
+void spl_init(float sample_rate);
+
+/**
+ * Zera o Leq e os valores máximo e mínimo.
+ */
+void spl_reset(void);
+
+/**
+ * Filtra um bloco de amostras e atualiza as médias Fast/Slow e os acumuladores.
+ * O estado dos filtros é mantido entre blocos.
+ * @param samples Amostras no formato de mic_decimate()
+ * @param count Número de amostras do bloco
+ */
+void spl_process(const int16_t* samples, uint count);
+
+/**
+ * Conta amostras que não passaram pelos filtros (descartadas do histórico do gatilho,
+ * ver trigger_push()) como tendo o nível Fast atual, para que o LAeq continue cobrindo
+ * o tempo todo. As que ficam no histórico são contadas quando processadas.
+ * @param count Número de amostras decimadas puladas
+ */
+void spl_skip(uint count);
+
+/**
+ * Converte o estado atual do medidor em níveis (dB).
+ * @param levels Recebe os níveis
+ */
+void spl_get_levels(spl_levels_t* levels);
+
+/**
+ * Fração do tempo real gasta em spl_process() (1.0 = todo o tempo entre amostras).
+ * @return Carga média desde spl_init()
+ */
+float spl_get_load(void);
+
+#endif // SPL_H
@@ -3,6 +3,75 @@
 #include "ssd1306.h"
 #include "font.h"
 #include "hardware/i2c.h"
+#include "hardware/dma.h"
+
+
+// Mark columns x0..x1 (inclusive) of a page as changed since the last update.
+static inline void ssd1306_mark_dirty(ssd1306_t *display, uint8_t page, uint8_t x0, uint8_t x1) {
+    if (display->dirty_pages & (1u << page)) {
+        if (x0 < display->dirty_x0[page]) display->dirty_x0[page] = x0;
+        if (x1 > display->dirty_x1[page]) display->dirty_x1[page] = x1;
+    } else {
+        display->dirty_pages |= (1u << page);
+        display->dirty_x0[page] = x0;
+        display->dirty_x1[page] = x1;
+    }
+}
+
+
+// Set (on) or clear the bits in mask for columns x0..x1 (inclusive) of a page.
+// The coordinates must already be inside the display.
+static void ssd1306_fill_span(ssd1306_t *display, uint8_t page, uint8_t x0, uint8_t x1, uint8_t mask, bool on) {
+    uint8_t *row = &display->buffer[page * display->width];
+    int16_t changed_x0 = -1, changed_x1 = -1;
+
+    for (uint8_t x = x0; x <= x1; ++x) {
+        uint8_t new_byte = on ? (row[x] | mask) : (row[x] & ~mask);
+        if (new_byte != row[x]) {
+            row[x] = new_byte;
+            if (changed_x0 < 0) changed_x0 = x;
+            changed_x1 = x;
+        }
+    }
+
+    if (changed_x0 >= 0) {
+        ssd1306_mark_dirty(display, page, changed_x0, changed_x1);
+    }
+}
+
+
+// Replace the bits in mask of one buffer byte with the matching bits of value.
+static inline void ssd1306_write_bits(ssd1306_t *display, uint8_t page, uint8_t x, uint8_t mask, uint8_t value) {
+    uint8_t *byte = &display->buffer[page * display->width + x];
+    uint8_t new_byte = (*byte & ~mask) | (value & mask);
+
+    if (new_byte != *byte) {
+        *byte = new_byte;
+        ssd1306_mark_dirty(display, page, x, x);
+    }
+}
+
+
+// Set or clear the area [x0, x1) x [y0, y1), one page at a time.
+static void ssd1306_fill_area(ssd1306_t *display, int16_t x0, int16_t y0, int16_t x1, int16_t y1, bool on) {
+    // Clip to the display
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > display->width) x1 = display->width;
+    if (y1 > display->height) y1 = display->height;
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    for (int16_t page = y0 / 8; page <= (y1 - 1) / 8; ++page) {
+        int16_t top = page * 8;
+        uint8_t first_bit = y0 > top ? y0 - top : 0;
+        uint8_t last_bit = y1 < top + 8 ? y1 - top : 8; // exclusive
+        uint8_t mask = (uint8_t)((0xFF << first_bit) & (0xFF >> (8 - last_bit)));
+
+        ssd1306_fill_span(display, page, x0, x1 - 1, mask, on);
+    }
+}
 
 
 void ssd1306_init(ssd1306_t *display, i2c_inst_t *i2c, uint8_t height, uint8_t width, uint8_t addr, bool external_vcc){
@@ -11,13 +80,23 @@ void ssd1306_init(ssd1306_t *display, i2c_inst_t *i2c, uint8_t height, uint8_t w
     display->i2c = i2c;
     display->height = height;
     display->width = width;
+    display->external_vcc = external_vcc;
+    display->dirty_pages = 0;
+    display->bytes_sent = 0;
+    display->busy = false;
     
     display->buffer = (uint8_t *)malloc(height*width/8);
 
-    if(!display->buffer){
+    // Worst case stream: every page sent as its own window (7 command words, control word and a full row)
+    display->tx_capacity = (height / 8) * (8 + width);
+    display->tx_buffer = (uint16_t *)malloc(display->tx_capacity * sizeof(uint16_t));
+
+    if(!display->buffer || !display->tx_buffer){
         //Report error
     }
 
+    display->dma_channel = dma_claim_unused_channel(true);
+
 
     // inspired from https://github.com/makerportal/rpi-pico-ssd1306
     uint8_t cmds[]= {
@@ -53,10 +132,8 @@ void ssd1306_init(ssd1306_t *display, i2c_inst_t *i2c, uint8_t height, uint8_t w
         0x00,  // horizontal
     };
 
-    // Send all commands 
-    for(size_t i=0; i<sizeof(cmds); ++i){
-        ssd1306_send_command(display, cmds[i]);
-    }
+    // Send all commands in a single transaction
+    ssd1306_send_commands(display, cmds, sizeof(cmds));
 
     ssd1306_clear_display(display);
     ssd1306_update(display);
@@ -65,6 +142,14 @@ void ssd1306_init(ssd1306_t *display, i2c_inst_t *i2c, uint8_t height, uint8_t w
 
 
 void ssd1306_deinit(ssd1306_t *display) {
+    ssd1306_wait_update(display);
+    dma_channel_unclaim(display->dma_channel);
+
+    if (display->tx_buffer) {
+        free(display->tx_buffer);
+        display->tx_buffer = NULL;
+    }
+
     if (display->buffer) {
         free(display->buffer);  
         display->buffer = NULL;
@@ -72,38 +157,177 @@ void ssd1306_deinit(ssd1306_t *display) {
 }
 
 
+// Start streaming the first count words of tx_buffer to the I2C DATA_CMD register.
+// Each word is a data byte plus control bits, and every transaction in the stream ends
+// with a STOP word, so several transactions can be sent by a single DMA transfer.
+static void ssd1306_start_stream(ssd1306_t *display, uint16_t count) {
+    i2c_hw_t *hw = i2c_get_hw(display->i2c);
+
+    // The target address can only be changed with the controller disabled
+    hw->enable = 0;
+    hw->tar = display->addr;
+    hw->enable = 1;
+    (void)hw->clr_tx_abrt;
+
+    dma_channel_config cfg = dma_channel_get_default_config(display->dma_channel);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, i2c_get_dreq(display->i2c, true));
+
+    display->busy = true;
+    display->bytes_sent = count;
+
+    dma_channel_configure(display->dma_channel, &cfg,
+        &hw->data_cmd,       // Write to the I2C TX FIFO
+        display->tx_buffer,  // Read from the stream
+        count,
+        true                 // Start now
+    );
+}
+
+
+// Append one transaction (control byte followed by data) to the stream.
+static uint16_t *ssd1306_stream_transaction(uint16_t *out, uint8_t control, const uint8_t *data, uint16_t size) {
+    *out++ = control;
+    for (uint16_t i = 0; i < size; ++i) {
+        *out++ = data[i];
+    }
+    out[-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+    return out;
+}
+
+
+// Append the COL/PAGE window commands and the window data to the stream.
+static uint16_t *ssd1306_stream_window(ssd1306_t *display, uint16_t *out, uint8_t x0, uint8_t x1, uint8_t page0, uint8_t page1) {
+    const uint8_t window[] = {SET_COL_ADDR, x0, x1, SET_PAGE_ADDR, page0, page1};
+    out = ssd1306_stream_transaction(out, 0x00, window, sizeof(window));
+
+    // With horizontal addressing the data fills the window row by row inside each page
+    *out++ = 0x40; // Data mode
+    for (uint8_t page = page0; page <= page1; ++page) {
+        const uint8_t *row = &display->buffer[page * display->width];
+        for (uint8_t x = x0; x <= x1; ++x) {
+            *out++ = row[x];
+        }
+    }
+    out[-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+    return out;
+}
+
+
+void ssd1306_send_commands(ssd1306_t *display, const uint8_t *commands, size_t count) {
+    ssd1306_wait_update(display); // The bus may still be busy with a DMA transfer
+
+    // 0x00: Control byte (command stream), followed by all the commands
+    if (count == 0 || count + 1 > display->tx_capacity) {
+        return;
+    }
+
+    uint16_t *end = ssd1306_stream_transaction(display->tx_buffer, 0x00, commands, count);
+    ssd1306_start_stream(display, end - display->tx_buffer);
+    ssd1306_wait_update(display);
+}
+
+
 void ssd1306_send_command(ssd1306_t *display, uint8_t command) {
-    uint8_t msg[2] = {0x00, command};  // 0x00: Control byte (command mode)
-    i2c_write_blocking(display->i2c, display->addr, msg, 2, false);
+    ssd1306_send_commands(display, &command, 1);
 }
 
 
 void ssd1306_send_data(ssd1306_t *display, uint8_t *data, uint16_t size) {
+    ssd1306_wait_update(display);
+
     // The first byte of the data is the control byte (0x40 for data mode)
-    uint8_t buffer[size + 1];
-    buffer[0] = 0x40; // Data mode
+    if (size + 1 > display->tx_capacity) {
+        return;
+    }
+
+    uint16_t *end = ssd1306_stream_transaction(display->tx_buffer, 0x40, data, size);
+    ssd1306_start_stream(display, end - display->tx_buffer);
+    ssd1306_wait_update(display);
+}
+
+
+void ssd1306_update_async(ssd1306_t *display) {
+    // Only one transfer at a time; the stream buffer is reused
+    ssd1306_wait_update(display);
+
+    uint8_t pages = display->height / 8;
+    uint8_t all_pages = (uint8_t)((1u << pages) - 1);
+    uint16_t *out = display->tx_buffer;
+
+    if (display->dirty_pages == 0) {
+        display->bytes_sent = 0;
+        return;
+    }
+
+    bool full_frame = false;
+    if (display->dirty_pages == all_pages) {
+        // Every page changed: one window over the union of the column ranges is cheaper
+        // than one window per page.
+        uint8_t x0 = display->width - 1, x1 = 0;
+        for (uint8_t page = 0; page < pages; ++page) {
+            if (display->dirty_x0[page] < x0) x0 = display->dirty_x0[page];
+            if (display->dirty_x1[page] > x1) x1 = display->dirty_x1[page];
+        }
+        full_frame = (x0 == 0 && x1 == display->width - 1);
+    }
 
-    // Copy the data into the buffer
-    memcpy(&buffer[1], data, size);
+    if (full_frame) {
+        out = ssd1306_stream_window(display, out, 0, display->width - 1, 0, pages - 1);
+    } else {
+        // Send only the changed columns of each dirty page
+        for (uint8_t page = 0; page < pages; ++page) {
+            if (display->dirty_pages & (1u << page)) {
+                out = ssd1306_stream_window(display, out, display->dirty_x0[page], display->dirty_x1[page], page, page);
+            }
+        }
+    }
 
-    // Send the data over I2C
-    i2c_write_blocking(display->i2c, display->addr, buffer, size + 1, false);
+    // The framebuffer was copied into the stream, so drawing can continue during the transfer
+    display->dirty_pages = 0;
+    ssd1306_start_stream(display, out - display->tx_buffer);
 }
 
 
-void ssd1306_update(ssd1306_t *display) {
-    // Set the column address range (from 0 to width-1)
-    ssd1306_send_command(display, 0x21); // Set column address command
-    ssd1306_send_command(display, 0);    // Start column address
-    ssd1306_send_command(display, display->width - 1); // End column address
+bool ssd1306_update_done(ssd1306_t *display) {
+    if (!display->busy) {
+        return true;
+    }
 
-    // Set the page address range (from 0 to (height/8) - 1)
-    ssd1306_send_command(display, 0x22); // Set page address command
-    ssd1306_send_command(display, 0);    // Start page address
-    ssd1306_send_command(display, (display->height / 8) - 1); // End page address
+    i2c_hw_t *hw = i2c_get_hw(display->i2c);
 
-    // Send the buffer data to the display
-    ssd1306_send_data(display, display->buffer, display->width * display->height / 8);
+    // The display did not acknowledge: drop the rest of the frame
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+        dma_channel_abort(display->dma_channel);
+        (void)hw->clr_tx_abrt;
+        display->busy = false;
+        return true;
+    }
+
+    // The DMA finishing only means the last word reached the FIFO; wait for the bus to go idle
+    if (dma_channel_is_busy(display->dma_channel) ||
+        !(hw->status & I2C_IC_STATUS_TFE_BITS) ||
+        (hw->status & I2C_IC_STATUS_MST_ACTIVITY_BITS)) {
+        return false;
+    }
+
+    display->busy = false;
+    return true;
+}
+
+
+void ssd1306_wait_update(ssd1306_t *display) {
+    while (!ssd1306_update_done(display)) {
+        tight_loop_contents();
+    }
+}
+
+
+void ssd1306_update(ssd1306_t *display) {
+    ssd1306_update_async(display);
+    ssd1306_wait_update(display);
 }
 
 
@@ -121,26 +345,43 @@ void ssd1306_draw_pixel(ssd1306_t *display, uint8_t x, uint8_t y, bool on) {
     uint16_t byte_index = (y / 8) * display->width + x; // Calculate the byte index
     uint8_t bit_position = y % 8; // Calculate the bit position in that byte
 
+    uint8_t old_byte = display->buffer[byte_index];
+    uint8_t new_byte;
+
     if(on)
-        display->buffer[byte_index] |= (1 << bit_position); // Set bit to on
+        new_byte = old_byte | (1 << bit_position); // Set bit to on
     else 
-        display->buffer[byte_index] &= ~(1 << bit_position); // Set bit to off
+        new_byte = old_byte & ~(1 << bit_position); // Set bit to off
+
+    // Only bytes that really change need to be sent again
+    if (new_byte != old_byte) {
+        display->buffer[byte_index] = new_byte;
+        ssd1306_mark_dirty(display, y / 8, x, x);
+    }
 }
 
 
 void ssd1306_clear_display(ssd1306_t *display) {
     memset(display->buffer, 0, display->width*display->height/8);
+
+    for (uint8_t page = 0; page < display->height / 8; ++page) {
+        ssd1306_mark_dirty(display, page, 0, display->width - 1);
+    }
 }
 
 void ssd1306_clear_rectangle(ssd1306_t *display, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1){
-    for(int x=0; x < (x1-x0); x++){
-        for (int y=0; y < (y1-y0); y++){
-            ssd1306_draw_pixel(display, x, y, false);
-        }
-    }
+    ssd1306_fill_area(display, x0, y0, x1, y1, false);
 }
 
 void ssd1306_draw_line(ssd1306_t *display, int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    // Horizontal and vertical lines are written a byte at a time
+    if (y0 == y1 || x0 == x1) {
+        int16_t left = x0 < x1 ? x0 : x1, right = x0 < x1 ? x1 : x0;
+        int16_t top = y0 < y1 ? y0 : y1, bottom = y0 < y1 ? y1 : y0;
+        ssd1306_fill_area(display, left, top, right + 1, bottom + 1, true);
+        return;
+    }
+
     int16_t dx = abs(x1 - x0);  
     int16_t dy = abs(y1 - y0);  
     int16_t sx = (x0 < x1) ? 1 : -1;  
@@ -188,11 +429,7 @@ void ssd1306_draw_filled_rectangle(ssd1306_t *display, uint8_t x0, uint8_t y0, u
         y1 = temp;
     }
 
-    for(int x=x0; x < x1; x++){
-        for (int y=y0; y < y1; y++){
-            ssd1306_draw_pixel(display, x, y, true);
-        }
-    }
+    ssd1306_fill_area(display, x0, y0, x1, y1, true);
 }
 
 void ssd1306_draw_char(ssd1306_t *display, char c, uint8_t x, uint8_t y) {
@@ -202,6 +439,24 @@ void ssd1306_draw_char(ssd1306_t *display, char c, uint8_t x, uint8_t y) {
     uint8_t char_height = font_8x5[0]; // get font height
     uint16_t index = 5 + (c - 32) * char_width;  // Skip header (5 bytes)
 
+    // Fast path: each glyph column is one byte of the page-major buffer. A page-aligned
+    // glyph is one byte write per column; otherwise it is split across two pages.
+    if (char_height == 8 && x + char_width <= display->width && y + char_height <= display->height) {
+        uint8_t page = y / 8;
+        uint8_t shift = y % 8;
+
+        for (uint8_t col = 0; col < char_width; col++) {
+            uint8_t column_data = font_8x5[index + col];
+
+            ssd1306_write_bits(display, page, x + col, 0xFF << shift, column_data << shift);
+            if (shift) {
+                ssd1306_write_bits(display, page + 1, x + col, 0xFF >> (8 - shift), column_data >> (8 - shift));
+            }
+        }
+        return;
+    }
+
+    // Glyph partially outside the screen: draw it pixel by pixel
     for (uint8_t col = 0; col < char_width; col++) {
         uint8_t column_data = font_8x5[index + col];  
 
@@ -225,8 +480,8 @@ void ssd1306_draw_string(ssd1306_t *display, const char *text, uint8_t x, uint8_
 
 void ssd1306_set_contrast(ssd1306_t *display, uint8_t value){
     
-    ssd1306_send_command(display, SET_CONTRAST);
-    ssd1306_send_command(display, value);
+    const uint8_t cmds[] = {SET_CONTRAST, value};
+    ssd1306_send_commands(display, cmds, sizeof(cmds));
 
 }
 
@@ -239,9 +494,9 @@ void ssd1306_invert_display(ssd1306_t *display, bool invert){
 }
 
 void ssd1306_power_on(ssd1306_t *display){
-    ssd1306_send_command(display, SET_DISP);
+    ssd1306_send_command(display, SET_DISP | 0x01); // 0xAF: display on
 }
 
 void ssd1306_power_off(ssd1306_t *display){
-    ssd1306_send_command(display, SET_DISP | 0x01);
+    ssd1306_send_command(display, SET_DISP); // 0xAE: display off (sleep mode)
 }
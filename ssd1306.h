@@ -6,6 +6,7 @@
 
 #define DISPLAY_HEIGHT 64
 #define DISPLAY_WIDTH  128
+#define DISPLAY_PAGES  (DISPLAY_HEIGHT / 8)
 
 // ==============================
 // Define command values 
@@ -41,6 +42,14 @@ typedef struct
     i2c_inst_t *i2c; 
     uint8_t *buffer; 
     bool external_vcc;
+    uint8_t dirty_pages;             // Bit n set when page n has changes not yet sent
+    uint8_t dirty_x0[DISPLAY_PAGES]; // First changed column of each dirty page
+    uint8_t dirty_x1[DISPLAY_PAGES]; // Last changed column of each dirty page (inclusive)
+    uint32_t bytes_sent;             // I2C bytes sent by the last ssd1306_update()
+    uint16_t *tx_buffer;             // I2C DATA_CMD words streamed to the bus by DMA
+    uint16_t tx_capacity;            // Size of tx_buffer in words
+    uint dma_channel;                // DMA channel used to feed the I2C TX FIFO
+    volatile bool busy;              // True while a transfer started by ssd1306_update_async() is on the bus
 } ssd1306_t;
 
 /**
@@ -70,6 +79,15 @@ void ssd1306_deinit(ssd1306_t *display);
  */
 void ssd1306_send_command(ssd1306_t *display, uint8_t command);
 
+/**
+ * @brief Send a list of commands to display in a single I2C transaction.
+ * 
+ * @param display Pointer to the display structure.
+ * @param commands Pointer to the command codes (and their arguments).
+ * @param count Number of bytes in commands.
+ */
+void ssd1306_send_commands(ssd1306_t *display, const uint8_t *commands, size_t count);
+
 /**
  * @brief Send data to display.
  * 
@@ -82,10 +100,39 @@ void ssd1306_send_data(ssd1306_t *display, uint8_t *data, uint16_t size);
 /**
  * @brief Update the display screen.
  * 
+ * Only the dirty column range of each dirty page is sent. The number of bytes written to the bus
+ * is stored in display->bytes_sent.
+ * 
  * @param display Pointer to the display structure.
  */
 void ssd1306_update(ssd1306_t *display);
 
+/**
+ * @brief Start sending the changed regions of the screen by DMA and return immediately.
+ * 
+ * The framebuffer is copied into the transfer stream before returning, so drawing the next frame
+ * can start right away. Use ssd1306_update_done() or ssd1306_wait_update() to know when the
+ * transfer finished.
+ * 
+ * @param display Pointer to the display structure.
+ */
+void ssd1306_update_async(ssd1306_t *display);
+
+/**
+ * @brief Check if the last transfer started by ssd1306_update_async() finished.
+ * 
+ * @param display Pointer to the display structure.
+ * @return True when the bus is free.
+ */
+bool ssd1306_update_done(ssd1306_t *display);
+
+/**
+ * @brief Wait for the last transfer started by ssd1306_update_async() to finish.
+ * 
+ * @param display Pointer to the display structure.
+ */
+void ssd1306_wait_update(ssd1306_t *display);
+
 /**
  * @brief Draw pixel on the screen. 
  * 
@@ -104,7 +151,7 @@ void ssd1306_draw_pixel(ssd1306_t *display, uint8_t x, uint8_t y, bool on);
 void ssd1306_clear_display(ssd1306_t *display);
 
 /**
- * @brief Clear a rectangular area.
+ * @brief Clear a rectangular area. The final coordinates are exclusive.
  * 
  * @param display Pointer to the display structure.
  * @param x0 Rectangles' X initial coordinate.
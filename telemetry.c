@@ -0,0 +1,115 @@
+#include "telemetry.h"
+#include "crc.h"
+#include "hardware/sync.h"
+
+/**
+ * Fila sem trava de um produtor (núcleo 0) e um consumidor (núcleo 1),
+ * no mesmo esquema da fila de medições em pipeline.c.
+ */
+static telemetry_record_t queue[TELEMETRY_QUEUE_SIZE];
+static volatile uint32_t head;
+static volatile uint32_t tail;
+static volatile uint32_t dropped;
+
+// Registro + CRC codificados em COBS (1 byte extra a cada 254) entre dois delimitadores 0x00.
+#define TELEMETRY_PAYLOAD_SIZE (TELEMETRY_MAX_RECORD + 2)
+#define TELEMETRY_FRAME_SIZE (TELEMETRY_PAYLOAD_SIZE + TELEMETRY_PAYLOAD_SIZE / 254 + 3)
+
+_Static_assert((TELEMETRY_QUEUE_SIZE & (TELEMETRY_QUEUE_SIZE - 1)) == 0,
+               "TELEMETRY_QUEUE_SIZE deve ser potência de 2");
+_Static_assert(sizeof(telemetry_record_t) <= TELEMETRY_MAX_RECORD, "Registro maior que TELEMETRY_MAX_RECORD");
+_Static_assert(sizeof(telemetry_record_t) == 100 + 2 * BENCH_STAGES,
+               "Layout do registro mudou; atualize Script_logs/telemetry_decoder.py");
+
+void telemetry_init(void) {
+    head = tail = 0;
+    dropped = 0;
+}
+
+bool telemetry_push(telemetry_record_t* record) {
+    uint32_t h = head;
+
+    if (h - tail >= TELEMETRY_QUEUE_SIZE) {
+        ++dropped;
+        return false;
+    }
+
+    record->telemetry_dropped = dropped;
+    queue[h % TELEMETRY_QUEUE_SIZE] = *record;
+
+    // Garante que o registro esteja na memória antes de publicar o novo head.
+    __mem_fence_release();
+    head = h + 1;
+    return true;
+}
+
+/**
+ * Codifica em COBS: nenhum byte da saída é 0x00, que fica livre para delimitar os quadros.
+ * @return Quantidade de bytes escritos em out
+ */
+static uint cobs_encode(const uint8_t* in, uint len, uint8_t* out) {
+    uint code_index = 0;
+    uint o = 1;
+    uint8_t code = 1;
+
+    for (uint i = 0; i < len; ++i) {
+        if (in[i] != 0) {
+            out[o++] = in[i];
+            ++code;
+        }
+        if (in[i] == 0 || code == 0xFF) {
+            out[code_index] = code;
+            code_index = o++;
+            code = 1;
+        }
+    }
+    out[code_index] = code;
+    return o;
+}
+
+bool telemetry_send(const void* record, uint len) {
+    if (len > TELEMETRY_MAX_RECORD)
+        return false;
+
+    // Estáticos: só o núcleo 1 envia, e a pilha dele tem 2 KB.
+    static uint8_t payload[TELEMETRY_PAYLOAD_SIZE];
+    static uint8_t frame[TELEMETRY_FRAME_SIZE];
+    const uint8_t* bytes = record;
+    for (uint i = 0; i < len; ++i)
+        payload[i] = bytes[i];
+
+    uint16_t crc = crc16_ccitt(payload, len);
+    payload[len] = crc & 0xFF;
+    payload[len + 1] = crc >> 8;
+
+    frame[0] = 0x00;
+    uint size = 1 + cobs_encode(payload, len + 2, &frame[1]);
+    frame[size++] = 0x00;
+
+    // Uma única chamada sem tradução de CR/LF: o quadro não é intercalado com outros textos.
+    stdio_put_string((const char*)frame, size, false, false);
+    return true;
+}
+
+uint telemetry_drain(void) {
+    uint sent = 0;
+
+    while (sent < TELEMETRY_DRAIN_MAX) {
+        uint32_t t = tail;
+        if (head == t)
+            break;
+
+        __mem_fence_acquire();
+        static telemetry_record_t record; // Núcleo 1 só; fora da pilha de 2 KB
+        record = queue[t % TELEMETRY_QUEUE_SIZE];
+
+        // O registro já foi copiado, a posição pode ser reutilizada pelo núcleo 0.
+        __mem_fence_release();
+        tail = t + 1;
+
+        telemetry_send(&record, sizeof(record));
+        ++sent;
+    }
+
+    return sent;
+}
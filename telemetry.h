@@ -0,0 +1,81 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "bench.h"
+
+// Capacidade da fila de registros (potência de 2).
+#define TELEMETRY_QUEUE_SIZE 16
+
+// Máximo de registros enviados por chamada de telemetry_drain().
+#define TELEMETRY_DRAIN_MAX 2
+
+// Maior registro aceito por telemetry_send() (bytes, antes do CRC e do COBS).
+#define TELEMETRY_MAX_RECORD 240
+
+// Tipos de registro (primeiro byte de cada quadro).
+#define TELEMETRY_RECORD_FRAME 0x01
+#define TELEMETRY_RECORD_AUDIO 0x02 // Trecho de um evento gravado (recorder.h)
+
+/**
+ * Registro de um quadro de medição. Formato fixo, little-endian e sem preenchimento;
+ * Script_logs/telemetry_decoder.py usa o mesmo layout.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t type;               // TELEMETRY_RECORD_FRAME
+    uint8_t sensitivity;        // Nível de sensibilidade
+    uint8_t view;               // Tela exibida
+    uint8_t power;              // Estado de energia (power_state_t)
+    uint32_t timestamp_ms;      // Instante da medição (ms desde o boot)
+    float rms;                  // Tensão RMS do quadro (V)
+    float laf, las, lcf;        // Níveis instantâneos (dB)
+    float laeq, lafmax, lafmin; // Níveis integrados desde o último reset (dB)
+    int16_t adc_min, adc_max;   // Extremos do ADC no quadro, sem o ponto médio (contagens)
+    uint32_t mic_overruns;      // Blocos do ADC perdidos
+    uint32_t pipeline_dropped;  // Medições descartadas na fila entre os núcleos
+    uint32_t telemetry_dropped; // Registros descartados nesta fila
+    uint32_t frame_overruns;    // Prazos de quadro perdidos (scheduler.h)
+    uint32_t led_overruns;      // Prazos da matriz de LEDs perdidos
+    uint32_t trigger_fired;     // Disparos do gatilho (trigger.h)
+    uint32_t armed_blocks;      // Blocos tratados só pelo primeiro estágio do gatilho
+    uint16_t spl_load;          // Carga do medidor (por mil)
+    float input_db[4];          // Nível das entradas 0 a 3 do ADC (dB, 0 se não capturada; channels.h)
+    float temperature_c;        // Sensor de temperatura interno (°C, 0 se não capturado)
+    uint32_t channel_rate;      // Amostras por segundo de cada entrada
+    uint8_t channel_mask;       // Entradas capturadas (mic_set_channels())
+    uint8_t source;             // Fonte do nível exibido (channels_source_t)
+    float dc_offset;            // Nível DC do microfone relativo ao ponto médio (contagens; mic_remove_dc())
+    uint16_t stage_us[BENCH_STAGES]; // Última duração de cada estágio (µs, 0 sem BENCH)
+} telemetry_record_t;
+
+/**
+ * Zera a fila. Deve ser chamada antes de iniciar o núcleo 1.
+ */
+void telemetry_init(void);
+
+/**
+ * Enfileira um registro sem bloquear. Só pode ser chamada pelo núcleo 0.
+ * @param record Registro a ser enviado; o campo telemetry_dropped é preenchido aqui
+ * @return false se a fila estava cheia e o registro foi descartado
+ */
+bool telemetry_push(telemetry_record_t* record);
+
+/**
+ * Envia pela saída padrão (UART/USB) até TELEMETRY_DRAIN_MAX registros pendentes,
+ * cada um em um quadro COBS com CRC-16. Só pode ser chamada pelo núcleo 1.
+ * @return Quantidade de registros enviados
+ */
+uint telemetry_drain(void);
+
+/**
+ * Envia um registro qualquer no mesmo formato (COBS + CRC-16). O primeiro byte
+ * deve ser o tipo do registro. Só pode ser chamada pelo núcleo 1.
+ * @param record Registro
+ * @param len Tamanho em bytes (até TELEMETRY_MAX_RECORD)
+ * @return false se o registro é grande demais
+ */
+bool telemetry_send(const void* record, uint len);
+
+#endif // TELEMETRY_H
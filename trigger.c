@@ -0,0 +1,85 @@
+#include "trigger.h"
+
+/**
+ * Histórico circular de amostras decimadas. Escrita e leitura sempre em múltiplos de
+ * MIC_DECIMATED_SAMPLES, então um bloco retirado nunca atravessa o fim do buffer.
+ * Os índices crescem sem parar, como nas filas de pipeline.c.
+ */
+static int16_t history[TRIGGER_HISTORY_SAMPLES];
+static uint32_t head;
+static uint32_t tail;
+
+static trigger_state_t state = TRIGGER_RUNNING;
+static uint32_t last_loud_ms;
+static trigger_stats_t stats;
+
+// Limiares em contagens do ADC: média dos quadrados e pico.
+static uint32_t level_mean_square;
+static int32_t level_peak;
+
+_Static_assert((TRIGGER_HISTORY_SAMPLES & (TRIGGER_HISTORY_SAMPLES - 1)) == 0,
+               "TRIGGER_HISTORY_SAMPLES deve ser potência de 2");
+_Static_assert(TRIGGER_HISTORY_SAMPLES % MIC_DECIMATED_MAX_SAMPLES == 0,
+               "TRIGGER_HISTORY_SAMPLES deve ser múltiplo de MIC_DECIMATED_MAX_SAMPLES");
+
+void trigger_set_level(float db) {
+    float counts = mic_db_to_rms(db) / ADC_VOLTS_PER_COUNT;
+    level_mean_square = (uint32_t)(counts * counts);
+    level_peak = (int32_t)(counts * TRIGGER_CREST_FACTOR);
+}
+
+bool trigger_block_is_loud(const mic_block_stats_t* block) {
+    return block->sum_squared > (uint64_t)level_mean_square * block->count ||
+           block->max > level_peak || -block->min > level_peak;
+}
+
+trigger_state_t trigger_update(bool loud, uint32_t now_ms) {
+    if (loud) {
+        last_loud_ms = now_ms;
+        if (state == TRIGGER_ARMED) {
+            ++stats.fired;
+            return state = TRIGGER_FIRED;
+        }
+        return state = TRIGGER_RUNNING;
+    }
+
+    if (state == TRIGGER_FIRED)
+        state = TRIGGER_RUNNING;
+
+    if (state == TRIGGER_RUNNING && now_ms - last_loud_ms >= TRIGGER_HOLD_MS && head == tail)
+        state = TRIGGER_ARMED;
+
+    if (state == TRIGGER_ARMED)
+        ++stats.armed_blocks;
+    return state;
+}
+
+uint trigger_push(const int16_t* samples, uint count) {
+    uint32_t excess = 0;
+    if (head - tail + count > TRIGGER_HISTORY_SAMPLES) {
+        // Armado (ou no bloco do disparo), o histórico guarda só os mais recentes;
+        // rodando, descartar é perda de dados.
+        excess = head - tail + count - TRIGGER_HISTORY_SAMPLES;
+        if (state == TRIGGER_RUNNING)
+            stats.overflows += excess;
+        tail += excess;
+    }
+
+    for (uint i = 0; i < count; ++i)
+        history[(head + i) % TRIGGER_HISTORY_SAMPLES] = samples[i];
+    head += count;
+    return excess;
+}
+
+const int16_t* trigger_pop(void) {
+    if (head == tail)
+        return NULL;
+
+    const int16_t* chunk = &history[tail % TRIGGER_HISTORY_SAMPLES];
+    tail += MIC_DECIMATED_SAMPLES;
+    return chunk;
+}
+
+void trigger_get_stats(trigger_stats_t* out) {
+    *out = stats;
+}
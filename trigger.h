@@ -0,0 +1,81 @@
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "mic.h"
+
+// Tempo que o pipeline completo continua rodando depois do último bloco com som.
+#define TRIGGER_HOLD_MS 2000
+
+// O pico dispara se passar o limiar de RMS vezes este fator (transientes curtos).
+#define TRIGGER_CREST_FACTOR 4
+
+// Histórico de amostras decimadas guardado enquanto armado (potência de 2, múltiplo de
+// MIC_DECIMATED_MAX_SAMPLES): ~65 ms na taxa decimada normal.
+#define TRIGGER_HISTORY_SAMPLES 2048
+
+/**
+ * Estado do gatilho.
+ */
+typedef enum {
+    TRIGGER_ARMED,   // Silêncio: só o primeiro estágio (pico/energia) roda
+    TRIGGER_FIRED,   // Bloco que cruzou o limiar; o histórico começa a ser processado
+    TRIGGER_RUNNING  // Pipeline completo rodando
+} trigger_state_t;
+
+/**
+ * Contadores do gatilho.
+ */
+typedef struct {
+    uint32_t fired;        // Vezes que o gatilho disparou
+    uint32_t armed_blocks; // Blocos do ADC tratados só pelo primeiro estágio
+    uint32_t overflows;    // Amostras do histórico descartadas antes de serem processadas
+} trigger_stats_t;
+
+/**
+ * Define o limiar do gatilho.
+ * @param db Nível na escala de mic_rms_to_db() (início da faixa da sensibilidade)
+ */
+void trigger_set_level(float db);
+
+/**
+ * Primeiro estágio: compara energia e pico do bloco com o limiar, só com inteiros.
+ * @param block Estatísticas do bloco (mic_block_stats())
+ * @return true se o bloco passou do limiar
+ */
+bool trigger_block_is_loud(const mic_block_stats_t* block);
+
+/**
+ * Atualiza o estado. Volta a TRIGGER_ARMED depois de TRIGGER_HOLD_MS sem som e
+ * com o histórico já processado.
+ * @param loud Resultado de trigger_block_is_loud()
+ * @param now_ms Tempo atual
+ * @return Estado atual
+ */
+trigger_state_t trigger_update(bool loud, uint32_t now_ms);
+
+/**
+ * Acrescenta amostras decimadas ao histórico. Enquanto armado, as mais antigas são
+ * sobrescritas; fora disso, só se o histórico encher (contado em overflows).
+ * @param samples Amostras no formato de mic_decimate()
+ * @param count Número de amostras (múltiplo de MIC_DECIMATED_SAMPLES)
+ * @return Amostras descartadas sem passar por trigger_pop() (para spl_skip())
+ */
+uint trigger_push(const int16_t* samples, uint count);
+
+/**
+ * Retira do histórico o bloco mais antigo de MIC_DECIMATED_SAMPLES amostras.
+ * O ponteiro vale até a próxima chamada de trigger_push().
+ * @return Ponteiro para as amostras, ou NULL se o histórico está vazio
+ */
+const int16_t* trigger_pop(void);
+
+/**
+ * Lê os contadores do gatilho.
+ * @param stats Estrutura que recebe os contadores
+ */
+void trigger_get_stats(trigger_stats_t* stats);
+
+#endif // TRIGGER_H